@@ -79,9 +79,206 @@ def gemm_golden(
     return np.clip(rounded, -128, 127).astype(np.int8)
 
 
+def gemm_residual_golden(
+    A: np.ndarray,         # [M, K] INT8
+    B: np.ndarray,         # [K, N] INT8
+    residual: np.ndarray,  # [M, N] INT8
+    scale: int = 1,
+    shift: int = 0,
+) -> np.ndarray:
+    """
+    GEMM with the residual epilogue (GEMM_RESIDUAL before the GEMM): the
+    requantized INT8 output plus the residual, saturated to INT8. Same
+    result as gemm_golden followed by vec_add_golden, in one pass.
+    """
+    assert residual.dtype == np.int8, f"residual must be INT8, got {residual.dtype}"
+    C = gemm_golden(A, B, scale=scale, shift=shift)
+    return np.clip(C.astype(np.int16) + residual.astype(np.int16), -128, 127).astype(np.int8)
+
+
+def gemm_scatter_golden(C: np.ndarray, block_log2: int) -> np.ndarray:
+    """
+    SRAM image of GEMM output C [M, N] written with the scatter epilogue
+    (GEMM flags[7:4] = block_log2): every 2^block_log2-column block becomes
+    its own row-major [M, 2^block_log2] buffer, blocks back to back.
+
+    For a fused QKV projection (N = 3*hidden, 2^block_log2 = head_dim) the
+    result is Q, K and V head-major: [3, heads, M, head_dim] flattened.
+    block_log2 = 0 is the plain row-major image.
+    """
+    if block_log2 == 0:
+        return C.reshape(-1)
+    m, n = C.shape
+    width = 1 << block_log2
+    assert n % width == 0, f"N={n} is not a multiple of the block width {width}"
+    return C.reshape(m, n // width, width).transpose(1, 0, 2).reshape(-1)
+
+
+def gemm_strided_batched_golden(
+    mem: np.ndarray,  # flat SRAM image, INT8; C is written in place
+    m: int, k: int, n: int,
+    src_a: int, src_b: int, dst: int,
+    batch: int, stride_a: int, stride_b: int, stride_c: int,
+    ldc: int = 0,
+    transpose_b: bool = False,
+    scale: int = 1,
+    shift: int = 0,
+) -> np.ndarray:
+    """
+    Strided-batched GEMM (GEMM_BATCH + GEMM with flags[3]) on an SRAM image.
+
+    Batch i multiplies A [m, k] at src_a + i*stride_a by B [k, n] at
+    src_b + i*stride_b ([n, k] with transpose_b) and writes C [m, n] at
+    dst + i*stride_c with row stride ldc (0 = n). Like strided-batched
+    BLAS, ldc lets each batch fill a column slice of a wider matrix, e.g.
+    the per-head context into the [seq_len, hidden] attention output.
+    """
+    ldc = ldc or n
+    for i in range(batch):
+        a0, b0, c0 = src_a + i * stride_a, src_b + i * stride_b, dst + i * stride_c
+        A = mem[a0:a0 + m * k].reshape(m, k)
+        B = mem[b0:b0 + k * n].reshape((n, k) if transpose_b else (k, n))
+        C = gemm_golden(A, B.T if transpose_b else B, scale=scale, shift=shift)
+        for r in range(m):
+            mem[c0 + r * ldc:c0 + r * ldc + n] = C[r]
+    return mem
+
+
+def pack_int4_weights(W: np.ndarray) -> np.ndarray:
+    """
+    Pack INT4 weights W [K, N] (values -8..7, INT8 storage) into the GEMM_W4
+    layout [K, ceil(N/2)]: column 2j in the low nibble, 2j+1 in the high
+    nibble. An odd N leaves the last high nibble zero.
+    """
+    assert W.dtype == np.int8, f"W must be INT8, got {W.dtype}"
+    assert W.min(initial=0) >= -8 and W.max(initial=0) <= 7, "W is not INT4"
+    k, n = W.shape
+    nibbles = np.zeros((k, n + n % 2), dtype=np.uint8)
+    nibbles[:, :n] = W.astype(np.uint8) & 0xF
+    return (nibbles[:, 0::2] | (nibbles[:, 1::2] << 4)).astype(np.int8)
+
+
+def unpack_int4_weights(B_packed: np.ndarray, n: int) -> np.ndarray:
+    """Inverse of pack_int4_weights: [K, ceil(N/2)] bytes -> INT4 values [K, N] as INT8."""
+    b = B_packed.astype(np.uint8)
+    # Shift each nibble to the top of the byte, then arithmetic-shift back
+    lo = (b << 4).astype(np.int8) >> 4
+    hi = b.astype(np.int8) >> 4
+    W = np.empty((b.shape[0], 2 * b.shape[1]), dtype=np.int8)
+    W[:, 0::2], W[:, 1::2] = lo, hi
+    return W[:, :n]
+
+
+def gemm_int4_golden(
+    A: np.ndarray,         # [M, K] INT8
+    B_packed: np.ndarray,  # [K, ceil(N/2)] packed INT4 (pack_int4_weights)
+    n: int,
+    scale: int = 1,
+    shift: int = 0,
+    accumulate: bool = False,
+    C_prev: Optional[np.ndarray] = None
+) -> np.ndarray:
+    """
+    Golden INT8 x INT4 GEMM (GEMM_W4). Each PE's two 8x4 products
+    accumulate into separate INT32 columns, so the result is exactly
+    gemm_golden on the unpacked weights; requantization is unchanged.
+    """
+    return gemm_golden(A, unpack_int4_weights(B_packed, n), scale=scale, shift=shift,
+                       accumulate=accumulate, C_prev=C_prev)
+
+
+def dynamic_quant_golden(X: np.ndarray, group: int = 16) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Per-token dynamic quantization (C side; study, no opcode). For each row and
+    each `group`-column group, the shift is the smallest s with every
+    value's magnitude (x, or ~x for negatives) >> s <= 127. Values round
+    half-up like requantization and saturate.
+
+    Returns:
+        q: [M, N] INT8, X ~= q << shift
+        shifts: [M, ceil(N/group)] UINT8, the shift table
+    """
+    X = X.astype(np.int64)
+    m, n = X.shape
+    groups = -(-n // group)
+    mag = np.where(X < 0, ~X, X)
+    shifts = np.zeros((m, groups), dtype=np.uint8)
+    q = np.zeros((m, n), dtype=np.int8)
+    for g in range(groups):
+        cols = slice(g * group, min(n, (g + 1) * group))
+        peak = mag[:, cols].max(axis=1)
+        s = sum((peak >> t) > 127 for t in range(64)).astype(np.int64)
+        half = np.where(s > 0, np.left_shift(1, np.maximum(s - 1, 0)), 0)
+        rounded = (X[:, cols] + half[:, None]) >> s[:, None]
+        q[:, cols] = np.clip(rounded, -128, 127)
+        shifts[:, g] = s
+    return q, shifts
+
+
+def gemm_dynq_golden(
+    A: np.ndarray,                          # [M, K] INT8
+    B: np.ndarray,                          # [K, N] INT8
+    a_shifts: Optional[np.ndarray] = None,  # [M, ceil(K/group)] A's shift table
+    scale: int = 1,
+    shift: int = 0,
+    quant_c: bool = False,
+    group: int = 16,
+):
+    """
+    GEMM with dynamic per-token quantization (study, no opcode). With a_shifts,
+    A is per-token quantized: each K group's partial sums are shifted left
+    by the row's shift before they accumulate. With quant_c the
+    requantized result goes through dynamic_quant_golden instead of INT8
+    saturation and (C, shifts) is returned; otherwise C as gemm_golden.
+    """
+    assert A.dtype == np.int8, f"A must be INT8, got {A.dtype}"
+    assert B.dtype == np.int8, f"B must be INT8, got {B.dtype}"
+    m, k = A.shape
+    acc = np.zeros((m, B.shape[1]), dtype=np.int64)
+    for g in range(-(-k // group)):
+        rows = slice(g * group, min(k, (g + 1) * group))
+        partial = A[:, rows].astype(np.int64) @ B[rows].astype(np.int64)
+        if a_shifts is not None:
+            partial <<= a_shifts[:, g].astype(np.int64)[:, None]
+        acc += partial
+    if shift > 0:
+        acc = (acc * scale + (1 << (shift - 1))) >> shift
+    else:
+        acc = acc * scale
+    if quant_c:
+        return dynamic_quant_golden(acc, group)
+    return np.clip(acc, -128, 127).astype(np.int8)
+
+
+def attention_mask(
+    m: int,
+    n: int,
+    causal: bool = False,
+    window: int = 0,
+    row_offset: int = 0
+) -> np.ndarray:
+    """
+    [m, n] bool mask of the scores a softmax row keeps.
+
+    Row r is query position r + row_offset (row_offset > 0 for a band tile
+    of a longer sequence). causal keeps columns up to that position, and
+    window = W keeps only the last W of them; 0 means no window.
+    """
+    pos = np.arange(m)[:, None] + row_offset
+    col = np.arange(n)[None, :]
+    on = np.ones((m, n), dtype=bool)
+    if causal:
+        on &= col <= pos
+    if window:
+        on &= col + window > pos
+    return on
+
+
 def softmax_golden(
     x: np.ndarray,  # [M, N] INT8
-    causal: bool = False
+    causal: bool = False,
+    window: int = 0,
+    row_offset: int = 0
 ) -> np.ndarray:
     """
     Golden fixed-point softmax with optional causal mask.
@@ -92,6 +289,7 @@ def softmax_golden(
     Args:
         x: Input tensor [M, N] INT8
         causal: If True, apply causal (lower-triangular) mask
+        window, row_offset: Sliding-window mask (see attention_mask)
     
     Returns:
         probs: Softmax probabilities [M, N] INT8 (sum to ~1 per row)
@@ -101,11 +299,9 @@ def softmax_golden(
     # Convert to FP32 for stable computation
     x_f = x.astype(np.float32)
     
-    # Apply causal mask if requested
-    if causal:
-        M, N = x.shape
-        mask = np.triu(np.ones((M, N)), k=1) * -1e9
-        x_f = x_f + mask
+    # Apply the causal / window mask if requested
+    if causal or window:
+        x_f = np.where(attention_mask(*x.shape, causal, window, row_offset), x_f, x_f - 1e9)
     
     # Numerically stable softmax
     x_max = np.max(x_f, axis=-1, keepdims=True)
@@ -117,6 +313,50 @@ def softmax_golden(
     return np.clip(np.round(probs_f * 127), 0, 127).astype(np.int8)
 
 
+
+def softmax_lanes_golden(
+    x: np.ndarray,  # [M, N] INT8
+    causal: bool = False,
+    frac_bits: int = 4,
+    window: int = 0,
+    row_offset: int = 0
+) -> np.ndarray:
+    """
+    Bit-exact golden for the multi-lane softmax datapath (LANES > 1).
+    
+    exp(x - max) = 2^(-t) with t = (max - x) * round(log2(e) * 256) in Q8:
+    the integer part of t is a right shift and its top frac_bits fraction
+    bits index a 2^-f table in Q4.12. Each row is normalized by one
+    reciprocal, (127 << 24) // sum, and a rounded multiply.
+    
+    Args:
+        x: Input tensor [M, N] INT8
+        causal: If True, apply causal (lower-triangular) mask
+        frac_bits: Fraction bits of the exp table (engine FRAC_BITS)
+        window, row_offset: Sliding-window mask (see attention_mask)
+    
+    Returns:
+        probs: Softmax probabilities [M, N] INT8 in [0, 127]
+    """
+    assert x.dtype == np.int8, f"x must be INT8, got {x.dtype}"
+    M, N = x.shape
+    frac_lut = np.floor(np.power(2.0, -np.arange(1 << frac_bits) / (1 << frac_bits)) * 4096 + 0.5)
+    frac_lut = frac_lut.astype(np.int64)
+    
+    on = attention_mask(M, N, causal, window, row_offset)
+    
+    xi = x.astype(np.int64)
+    row_max = np.where(on, xi, -128).max(axis=-1, keepdims=True)
+    t = (row_max - xi) * 369
+    shift = t >> 8
+    frac = (t >> (8 - frac_bits)) & ((1 << frac_bits) - 1)
+    exp = np.where(shift >= 16, 0, frac_lut[frac] >> np.minimum(shift, 63))
+    exp = np.where(on, exp, 0)
+    
+    recip = (127 << 24) // exp.sum(axis=-1, keepdims=True)
+    probs = (exp * recip + (1 << 23)) >> 24
+    return np.where(on, probs, 0).astype(np.int8)
+
 def layernorm_golden(
     x: np.ndarray,  # [M, N] INT8
     gamma: np.ndarray,  # [N] INT8 (scale)
@@ -158,6 +398,41 @@ def layernorm_golden(
     return np.clip(np.round(y_f), -128, 127).astype(np.int8)
 
 
+
+def layernorm_fixed_golden(
+    x: np.ndarray,      # [M, N] INT8
+    gamma: np.ndarray,  # [N] INT8, Q1.7 (127 ~ 1.0)
+    beta: np.ndarray    # [N] INT8
+) -> np.ndarray:
+    """
+    Bit-exact golden for the streaming LayerNorm engine (STREAM = 1).
+    
+    Integer statistics (C-style truncating division), a 1024-entry
+    1/sqrt(v + 1) table in Q16.16, then
+    y = sat8(((((x - mean) * rsqrt) >> 16) * gamma >> 7) + beta)
+    with arithmetic shifts.
+    
+    Args:
+        x: Input tensor [M, N] INT8
+        gamma: Scale parameter [N] INT8
+        beta: Shift parameter [N] INT8
+    
+    Returns:
+        y: Normalized output [M, N] INT8
+    """
+    assert x.dtype == np.int8, f"x must be INT8, got {x.dtype}"
+    n = x.shape[-1]
+    xi = x.astype(np.int64)
+    s = xi.sum(axis=-1, keepdims=True)
+    sq = (xi * xi).sum(axis=-1, keepdims=True)
+    mean = np.trunc(s / n).astype(np.int64)
+    var = sq // n - mean * mean  # sq >= 0, so floor == trunc
+    rsqrt_lut = np.floor(65536.0 / np.sqrt(np.arange(1024) + 1.0) + 0.5).astype(np.int64)
+    inv = rsqrt_lut[np.clip(var, 0, 1023)]
+    x_norm = ((xi - mean) * inv) >> 16
+    y = ((x_norm * gamma.astype(np.int64)) >> 7) + beta.astype(np.int64)
+    return np.clip(y, -128, 127).astype(np.int8)
+
 def gelu_golden(x: np.ndarray) -> np.ndarray:
     """
     Golden GELU activation.
@@ -183,6 +458,68 @@ def gelu_golden(x: np.ndarray) -> np.ndarray:
     return np.clip(np.round(y_f), -128, 127).astype(np.int8)
 
 
+ACTIVATIONS = {
+    "gelu": lambda x: 0.5 * x * (1.0 + np.tanh(np.sqrt(2.0 / np.pi) * (x + 0.044715 * x**3))),
+    "silu": lambda x: x / (1.0 + np.exp(-x)),
+    "relu": lambda x: np.maximum(x, 0.0),
+    "tanh": np.tanh,
+}
+
+
+def activation_lut(kind: str, in_scale: float = 1.0, out_scale: float = 1.0) -> np.ndarray:
+    """
+    256-entry INT8 activation table for LUT_LOAD (GELU engine table).
+    
+    Entry i holds sat8(round(f(x * in_scale) / out_scale)) where x is i
+    reinterpreted as INT8, i.e. the table is indexed by the input's bit
+    pattern exactly as the engine indexes gelu_lut.
+    
+    Args:
+        kind: One of "gelu", "silu", "relu", "tanh"
+        in_scale: Real value of one input LSB
+        out_scale: Real value of one output LSB
+    
+    Returns:
+        lut: [256] INT8 table (write lut.tobytes() to SRAM0)
+    """
+    x = np.arange(256, dtype=np.uint8).view(np.int8).astype(np.float64)
+    y = ACTIVATIONS[kind](x * in_scale) / out_scale
+    return np.clip(np.floor(y + 0.5), -128, 127).astype(np.int8)
+
+
+def softmax_exp_lut(base: float = np.e) -> np.ndarray:
+    """
+    256-entry softmax exp table for LUT_LOAD: base^(x - max) in Q4.12.
+    
+    Indexed by the INT8 difference (x - max) <= 0; truncated and floored at
+    1. Positive indices never occur and saturate. base=e reproduces the
+    engine's reset table.
+    
+    Returns:
+        lut: [256] uint16 table (little-endian lut.astype('<u2').tobytes())
+    """
+    d = np.arange(256, dtype=np.uint8).view(np.int8).astype(np.float64)
+    vals = np.maximum(1.0, np.trunc(np.power(base, np.minimum(d, 0.0)) * 4096.0))
+    vals[d > 0] = 0xFFFF
+    return vals.astype(np.uint16)
+
+
+def lut_activation_golden(x: np.ndarray, lut: np.ndarray) -> np.ndarray:
+    """
+    Golden for the GELU engine running an arbitrary loaded table.
+    
+    Args:
+        x: Input tensor INT8
+        lut: [256] INT8 table (e.g. from activation_lut)
+    
+    Returns:
+        y: lut[x] as INT8
+    """
+    assert x.dtype == np.int8, f"x must be INT8, got {x.dtype}"
+    assert lut.shape == (256,), f"lut must have 256 entries, got {lut.shape}"
+    return lut.astype(np.int8)[x.view(np.uint8)]
+
+
 def vec_add_golden(
     a: np.ndarray,  # [M, N] INT8
     b: np.ndarray   # [M, N] INT8
@@ -244,6 +581,84 @@ def attention_head_golden(
     return context
 
 
+def gqa_attention_golden(
+    q: np.ndarray,  # [heads, seq_len, head_dim] INT8
+    k: np.ndarray,  # [kv_heads, seq_len, head_dim] INT8
+    v: np.ndarray,  # [kv_heads, seq_len, head_dim] INT8
+    causal: bool = True
+) -> np.ndarray:
+    """
+    Grouped-query attention as the block program runs it.
+
+    Query head h uses K/V head h // (heads // kv_heads). The r query heads
+    of a group are stacked along M for one QK^T against their shared K,
+    and P x V reuses the group's V for each head (a B-stride-0 batch).
+
+    Returns:
+        context: [seq_len, heads * head_dim] INT8, head h in columns h*D..
+    """
+    heads, seq_len, head_dim = q.shape
+    kv_heads = k.shape[0]
+    assert heads % kv_heads == 0 and k.shape == v.shape == (kv_heads, seq_len, head_dim)
+    r = heads // kv_heads
+    context = []
+    for j in range(kv_heads):
+        stacked = q[j * r:(j + 1) * r].reshape(r * seq_len, head_dim)
+        scores = gemm_golden(stacked, k[j].T, scale=1, shift=4).reshape(r, seq_len, seq_len)
+        for s in scores:
+            context.append(gemm_golden(softmax_golden(s, causal=causal), v[j], scale=1, shift=7))
+    return np.concatenate(context, axis=1)
+
+
+def sliding_window_attention_golden(
+    q: np.ndarray,  # [seq_len, head_dim] INT8
+    k: np.ndarray,  # [seq_len, head_dim] INT8
+    v: np.ndarray,  # [seq_len, head_dim] INT8
+    window: int,
+    tile: int = 16
+) -> np.ndarray:
+    """
+    One head of causal sliding-window attention, tiled as the block program
+    runs it: each `tile`-row query block only scores the band of keys its
+    rows can see (from its first row's window start, rounded down to a
+    tile), and the band tile's softmax masks with row_offset = i0 - k0.
+
+    Returns:
+        context: [seq_len, head_dim] INT8
+    """
+    seq_len = q.shape[0]
+    context = np.zeros_like(q)
+    for i0 in range(0, seq_len, tile):
+        i1 = min(seq_len, i0 + tile)
+        k0 = max(0, i0 + 1 - window) // tile * tile
+        scores = gemm_golden(q[i0:i1], k[k0:i1].T, scale=1, shift=4)
+        probs = softmax_golden(scores, causal=True, window=window, row_offset=i0 - k0)
+        context[i0:i1] = gemm_golden(probs, v[k0:i1], scale=1, shift=7)
+    return context
+
+
+def kv_ring_decode_golden(
+    q: np.ndarray,       # [1, head_dim] INT8 - the new token's query
+    k_ring: np.ndarray,  # [slots, head_dim] INT8
+    v_ring: np.ndarray,  # [slots, head_dim] INT8
+    valid: int,
+    softmax=softmax_golden
+) -> np.ndarray:
+    """
+    One decode step of one head against a KV ring buffer. Position t lives
+    in slot t % slots, so once the ring is full it holds exactly the last
+    `slots` positions in rotated order. Attention needs no mask and does
+    not care about the order; only the first `valid` slots are read
+    before the ring fills. The cost is fixed by the ring size, however
+    long generation runs.
+
+    Returns:
+        context: [1, head_dim] INT8
+    """
+    scores = gemm_golden(q, k_ring[:valid].T, scale=1, shift=4)
+    return gemm_golden(softmax(scores), v_ring[:valid], scale=1, shift=7)
+
+
 # =============================================================================
 # Test utilities
 # =============================================================================
@@ -297,14 +712,129 @@ if __name__ == "__main__":
     C = gemm_golden(A, B, scale=1, shift=7)
     print(f"GEMM: {A.shape} @ {B.shape} = {C.shape}")
     
+    # Test the fused QKV scatter: one N=3H GEMM lands each head's Q/K/V slice
+    X = np.random.randint(-10, 10, (6, 16), dtype=np.int8)
+    Wqkv = np.random.randint(-10, 10, (16, 48), dtype=np.int8)
+    image = gemm_scatter_golden(gemm_golden(X, Wqkv, scale=1, shift=7), block_log2=2)
+    for p in range(3):
+        for h in range(4):
+            part = gemm_golden(X, Wqkv[:, 16 * p + 4 * h:16 * p + 4 * h + 4], scale=1, shift=7)
+            base = (p * 4 + h) * 6 * 4
+            assert np.array_equal(image[base:base + 24], part.reshape(-1))
+    print(f"GEMM scatter: fused QKV {X.shape} @ {Wqkv.shape} -> head-major image of {image.size} bytes")
+
+    # Test strided-batched GEMM on that image: QK^T for all heads, then P x V
+    # into column slices of the [seq, hidden] context
+    seq, heads, d = 6, 4, 4
+    q, kk, v = 0, heads * seq * d, 2 * heads * seq * d
+    scores, ctx = image.size, image.size + heads * seq * seq
+    mem = np.concatenate([image, np.zeros(heads * seq * seq + seq * heads * d, dtype=np.int8)])
+    gemm_strided_batched_golden(mem, seq, d, seq, q, kk, scores, heads, seq * d, seq * d, seq * seq,
+                                transpose_b=True, shift=4)
+    gemm_strided_batched_golden(mem, seq, seq, d, scores, v, ctx, heads, seq * seq, seq * d, d,
+                                ldc=heads * d, shift=4)
+    Q, K, V = (image[p * heads * seq * d:(p + 1) * heads * seq * d].reshape(heads, seq, d) for p in range(3))
+    want = np.concatenate([gemm_golden(gemm_golden(Q[h], K[h].T, shift=4), V[h], shift=4)
+                           for h in range(heads)], axis=1)
+    assert np.array_equal(mem[ctx:].reshape(seq, heads * d), want)
+    print(f"GEMM strided batch: {heads} heads of QK^T and PV -> context {want.shape}")
+
+    # Test INT4 weights: pack/unpack round-trips over every nibble and odd N,
+    # and GEMM_W4 matches the INT8 GEMM on INT4-valued weights
+    W4 = np.random.randint(-8, 8, (16, 37), dtype=np.int8)
+    W4[0, :16] = np.arange(-8, 8)
+    packed = pack_int4_weights(W4)
+    assert packed.shape == (16, 19)
+    assert np.array_equal(unpack_int4_weights(packed, 37), W4)
+    A = np.random.randint(-128, 128, (5, 16), dtype=np.int8)
+    assert np.array_equal(gemm_int4_golden(A, packed, 37, shift=6), gemm_golden(A, W4, shift=6))
+    print(f"GEMM INT4: {A.shape} @ {W4.shape} from {packed.nbytes} packed weight bytes")
+
+    # Test the residual epilogue: matches GEMM + VEC_ADD, and saturates
+    A = np.random.randint(-128, 128, (16, 64), dtype=np.int8)
+    W = np.random.randint(-128, 128, (64, 64), dtype=np.int8)
+    R = np.random.randint(-128, 128, (16, 64), dtype=np.int8)
+    Y = gemm_residual_golden(A, W, R, shift=10)
+    assert np.array_equal(Y, vec_add_golden(gemm_golden(A, W, shift=10), R))
+    assert gemm_residual_golden(np.full((1, 1), 127, np.int8), np.full((1, 1), 127, np.int8),
+                                np.full((1, 1), 127, np.int8))[0, 0] == 127
+    print(f"GEMM + residual: {A.shape} @ {W.shape} + {R.shape} -> {Y.shape}")
+
+    # Test dynamic per-token quantization: the shift fits each group, -128
+    # needs none, zero shifts are a plain GEMM, and on tokens whose
+    # magnitudes differ by 64x a per-token producer/consumer pair is more
+    # accurate than one static shift sized for the largest token
+    q, sh = dynamic_quant_golden(np.array([[127, -128, 0], [128, -129, 5], [70000, 3, -9]]), group=2)
+    assert sh.tolist() == [[0, 0], [1, 0], [10, 0]] and q[1].tolist() == [64, -64, 5]
+    A = np.random.randint(-128, 128, (16, 64), dtype=np.int8)
+    W = np.random.randint(-128, 128, (64, 32), dtype=np.int8)
+    assert np.array_equal(gemm_dynq_golden(A, W, np.zeros((16, 4), np.uint8), shift=10),
+                          gemm_golden(A, W, shift=10))
+    W1 = np.random.randint(-128, 128, (64, 64), dtype=np.int8)
+    amp = 2.0 ** (np.arange(16) % 7)
+    A = np.clip(np.round(np.random.randn(16, 64) * amp[:, None]), -128, 127).astype(np.int8)
+    H = A.astype(np.int64) @ W1.astype(np.int64)
+    ref = H @ W.astype(np.int64)
+    C_q, C_sh = gemm_dynq_golden(A, W1, quant_c=True)
+    dyn = gemm_dynq_golden(C_q, W, C_sh, quant_c=True)
+    dyn = dyn[0].astype(np.int64) << np.repeat(dyn[1], 16, axis=1)[:, :32].astype(np.int64)
+    s_static = int(sum((np.abs(H).max() >> t) > 127 for t in range(64)))
+    static = gemm_golden(A, W1, shift=s_static).astype(np.int64) @ W.astype(np.int64) << s_static
+    err = lambda Y: float(np.mean(np.abs(Y - ref).mean(axis=1) / np.abs(ref).mean(axis=1)))
+    assert err(dyn) < err(static)
+    print(f"GEMM dynamic quant: per-token error {err(dyn):.4f} vs static shift {s_static} {err(static):.4f}")
+    
+    # Test grouped-query attention: each query head matches single-head
+    # attention with its group's K/V weights, for GQA and MQA
+    X = np.random.randint(-64, 64, (8, 32), dtype=np.int8)
+    heads, d = 4, 8
+    Wq = np.random.randint(-64, 64, (heads, 32, d), dtype=np.int8)
+    for kv in (2, 1):
+        Wk, Wv = (np.random.randint(-64, 64, (kv, 32, d), dtype=np.int8) for _ in range(2))
+        proj = lambda W: np.stack([gemm_golden(X, w, scale=1, shift=7) for w in W])
+        ctx = gqa_attention_golden(proj(Wq), proj(Wk), proj(Wv))
+        want = np.concatenate([attention_head_golden(X, Wq[h], Wk[h // (heads // kv)], Wv[h // (heads // kv)],
+                                                     8, d) for h in range(heads)], axis=1)
+        assert np.array_equal(ctx, want)
+    print(f"GQA: {heads} query heads over 2 and 1 K/V heads -> context {ctx.shape}")
+    
+    # Test sliding-window attention: the band tiles match full attention
+    # with a window mask, and decoding token by token through a ring of
+    # `window` slots gives the same rows (bit-exact with the integer
+    # lanes softmax, which does not depend on the ring's slot order)
+    seq, d, win = 40, 8, 12
+    Q, K, V = (np.random.randint(-64, 64, (seq, d), dtype=np.int8) for _ in range(3))
+    full = gemm_golden(softmax_golden(gemm_golden(Q, K.T, shift=4), causal=True, window=win), V, shift=7)
+    assert np.array_equal(sliding_window_attention_golden(Q, K, V, win), full)
+    lanes = lambda x: softmax_lanes_golden(x, causal=True, window=win)
+    want = gemm_golden(lanes(gemm_golden(Q, K.T, shift=4)), V, shift=7)
+    k_ring, v_ring = np.zeros((win, d), np.int8), np.zeros((win, d), np.int8)
+    for t in range(seq):
+        k_ring[t % win], v_ring[t % win] = K[t], V[t]
+        row = kv_ring_decode_golden(Q[t:t + 1], k_ring, v_ring, min(t + 1, win), softmax_lanes_golden)
+        assert np.array_equal(row[0], want[t])
+    print(f"Sliding window: seq {seq}, window {win}; band tiles and {win}-slot KV ring decode match")
+    
     # Test softmax
     S = np.random.randint(-20, 20, (4, 4), dtype=np.int8)
     P = softmax_golden(S, causal=True)
     print(f"Softmax: {S.shape} -> {P.shape}, row sums ~{np.sum(P, axis=1)}")
+    P2 = softmax_lanes_golden(S, causal=True)
+    print(f"Softmax (lanes, base-2 exp): max |diff| vs FP32 = {np.max(np.abs(P2.astype(int) - P))}")
+    
+    # Test LayerNorm (fixed-point engine model)
+    X = np.random.randint(-20, 20, (2, 768), dtype=np.int8)
+    Y = layernorm_fixed_golden(X, np.full(768, 127, np.int8), np.zeros(768, np.int8))
+    print(f"LayerNorm (fixed): {X.shape} -> {Y.shape}")
     
     # Test GELU
     x = np.array([-10, -5, 0, 5, 10], dtype=np.int8)
     y = gelu_golden(x)
     print(f"GELU: {x} -> {y}")
     
+    # Test a loaded activation table matches its closed form
+    silu = activation_lut("silu")
+    assert np.array_equal(lut_activation_golden(x, activation_lut("gelu")), gelu_golden(x))
+    print(f"SiLU LUT: {x} -> {lut_activation_golden(x, silu)}")
+    
     print("\nAll golden functions loaded successfully!")
@@ -0,0 +1,135 @@
+import sys
+import unittest
+from dataclasses import replace
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1] / "tools"))
+
+import perf_model as pm  # noqa: E402
+
+
+def synthetic_workloads(truth: pm.PerfModel) -> list[pm.Workload]:
+    """Calibration data generated by a known model, shaped like bench_perf_calibration's."""
+    bodies = {}
+    for m, n, k in [(16, 16, 16), (40, 56, 24), (16, 56, 80), (40, 16, 80), (16, 16, 24)]:
+        bodies[f"iso_gemm_{m}x{n}x{k}"] = [pm.Instr(pm.OP_GEMM, m=m, n=n, k=k)]
+    for n in (64, 1024, 8192):
+        bodies[f"iso_vec_{n}"] = [pm.Instr(pm.OP_VEC_ADD, m=1, n=n)]
+    for nbytes in (64, 1000, 4096, 16384):
+        bodies[f"iso_dma_{nbytes}"] = [pm.Instr(pm.OP_DMA_LOAD, m=nbytes)]
+    bodies["b2b_gemm"] = [pm.Instr(pm.OP_GEMM, m=32, n=32, k=32)] * 4
+    bodies["mix_barriers"] = [pm.Instr(pm.OP_GEMM, m=16, n=16, k=16), pm.Instr(pm.OP_BARRIER),
+                              pm.Instr(pm.OP_VEC_ADD, m=1, n=256), pm.Instr(pm.OP_BARRIER)]
+    bodies["mix_dma_vec"] = [pm.Instr(pm.OP_DMA_LOAD, m=4096), pm.Instr(pm.OP_VEC_ADD, m=1, n=4096)]
+
+    workloads = []
+    for name, body in bodies.items():
+        program = body + [pm.Instr(pm.OP_BARRIER), pm.Instr(pm.OP_END)]
+        ops = [(i, round(truth.latency(i))) for i in body if i.engine is not None]
+        workloads.append(pm.Workload(name, "fit", program, round(truth.predict(program)), ops))
+    return workloads
+
+
+class PerfModelTest(unittest.TestCase):
+    def test_encode_decode_round_trip(self):
+        program = [pm.Instr(pm.OP_GEMM, 0x01, 0x100, 0x200, 0x300, 16, 32, 64, 7), pm.Instr(pm.OP_END)]
+        data = pm.encode_program(program)
+        self.assertEqual(len(data), 32)
+        self.assertEqual(data[0], pm.OP_GEMM)
+        self.assertEqual(pm.decode_program(data), program)
+
+    def test_decode_tracks_gemm_batch(self):
+        gemm = pm.Instr(pm.OP_GEMM, m=16, n=16, k=16)
+        program = [gemm, pm.Instr(pm.OP_GEMM_BATCH, m=4), pm.Instr(pm.OP_GEMM, pm.GEMM_BATCHED, m=16, n=16, k=16),
+                   gemm, pm.Instr(pm.OP_END)]
+        decoded = pm.decode_program(pm.encode_program(program))
+        self.assertEqual([i.batch for i in decoded], [1, 1, 4, 1, 1])
+        # GEMM_BATCH costs a dispatch but no engine time
+        model = pm.PerfModel(dispatch=3, barrier=1, costs={"GEMM": [2, 10, 0, 0]})
+        self.assertEqual(model.predict(decoded[1:3] + [pm.Instr(pm.OP_BARRIER), pm.Instr(pm.OP_END)]),
+                         3 + 3 + 2 + 4 * 10 + 1 + 3)
+
+    def test_decode_tracks_gemm_residual(self):
+        gemm = pm.Instr(pm.OP_GEMM, m=40, n=40, k=16)
+        program = [pm.Instr(pm.OP_GEMM_RESIDUAL, src0=0x400), pm.Instr(pm.OP_VEC_ADD, n=16), gemm, gemm,
+                   pm.Instr(pm.OP_END)]
+        decoded = pm.decode_program(pm.encode_program(program))
+        # Applies to the next GEMM only, across other engines' instructions
+        self.assertEqual([i.residual for i in decoded], [False, False, True, False, False])
+        names, x = pm.features(decoded[2])
+        self.assertEqual(x[names.index("residual_tiles")], 9)
+        names, x = pm.features(decoded[3])
+        self.assertEqual(x[names.index("residual_tiles")], 0)
+
+    def test_dispatch_stalls_and_barriers(self):
+        model = pm.PerfModel(dispatch=3, barrier=1, costs={"GEMM": [100, 0, 0, 0], "VEC_ADD": [10, 0]})
+        gemm = pm.Instr(pm.OP_GEMM, m=16, n=16, k=16)
+        vec = pm.Instr(pm.OP_VEC_ADD, n=16)
+        barrier, end = pm.Instr(pm.OP_BARRIER), pm.Instr(pm.OP_END)
+        # Different engines overlap; the same engine waits for the scoreboard
+        self.assertEqual(model.predict([gemm, vec, barrier, end]), 3 + 100 + 1 + 3)
+        self.assertEqual(model.predict([gemm, gemm, barrier, end]), 3 + 100 + 100 + 1 + 3)
+
+    def test_call_replays_subroutine(self):
+        model = pm.PerfModel(dispatch=3, barrier=1, costs={"GEMM": [100, 0, 0, 0]})
+        gemm = pm.Instr(pm.OP_GEMM, m=16, n=16, k=16)
+        call, ret = pm.Instr(pm.OP_CALL, imm=4), pm.Instr(pm.OP_RET)
+        barrier, end = pm.Instr(pm.OP_BARRIER), pm.Instr(pm.OP_END)
+        # The body runs once per CALL; only the first CALL's dispatch is
+        # not hidden behind a running GEMM
+        program = [call, call, barrier, end, gemm, ret]
+        self.assertEqual(model.predict(program), 3 + 3 + 100 + 100 + 1 + 3)
+        self.assertEqual(model.schedule(program)["engine_busy"]["gemm"], 200)
+        # A RET with an empty return stack ends the program like END
+        self.assertEqual(model.predict([gemm, barrier, ret, gemm, end]), 3 + 100 + 1 + 3)
+
+    def test_compact_round_trip(self):
+        ln = pm.Instr(pm.OP_LAYERNORM, dst=0x1230, src0=0x40, src1=0xFFF0, m=16, n=64)
+        gemm = pm.Instr(pm.OP_GEMM, m=16, n=16, k=16)
+        barrier, ret, end = pm.Instr(pm.OP_BARRIER), pm.Instr(pm.OP_RET), pm.Instr(pm.OP_END)
+        # The CALL target starts a slot, so the BARRIER before it stays full
+        program = [pm.Instr(pm.OP_CALL, imm=4), ln, barrier, end, barrier, gemm, ret]
+        data = pm.encode_program(program, compact=True)
+        self.assertEqual(len(data), 6 * 16)
+        self.assertEqual(data[0], pm.OP_CALL)
+        self.assertEqual(data[16 + 8] & 0xC0, pm.COMPACT_MARK)
+        decoded = pm.decode_program(data)
+        self.assertEqual([replace(i, paired=False) for i in decoded], program)
+        self.assertEqual([i.paired for i in decoded], [False, False, True, False, False, False, False])
+        self.assertEqual(pm.decode_program(pm.encode_program(program)), program)
+
+    def test_paired_instr_skips_fetch(self):
+        model = pm.PerfModel(dispatch=3, fetch=1, barrier=1, costs={"LAYERNORM": [50, 0, 0]})
+        softmax, ln = pm.Instr(pm.OP_SOFTMAX, m=1, n=64), pm.Instr(pm.OP_LAYERNORM, m=1, n=64)
+        program = [softmax, ln, pm.Instr(pm.OP_BARRIER), pm.Instr(pm.OP_END)]
+        full = model.predict(pm.decode_program(pm.encode_program(program)))
+        compact = model.predict(pm.decode_program(pm.encode_program(program, compact=True)))
+        # LAYERNORM and END are upper halves and dispatch one cycle sooner
+        self.assertEqual(full, 3 + 3 + 50 + 1 + 3)
+        self.assertEqual(compact, 3 + 2 + 50 + 1 + 2)
+
+    def test_fit_recovers_known_model(self):
+        truth = pm.PerfModel(dispatch=3, barrier=2, overhead=4, contention=0.5, costs={
+            "GEMM": [3.0, 8.0, 1.0, 1.0],
+            "VEC_ADD": [2.0, 1.0],
+            "DMA_LOAD": [5.0, 1.0, 18.0],
+        })
+        workloads = synthetic_workloads(truth)
+        model = pm.fit(workloads)
+
+        for name, coeffs in truth.costs.items():
+            for got, want in zip(model.costs[name], coeffs):
+                self.assertAlmostEqual(got, want, places=3)
+        self.assertEqual((model.dispatch, model.barrier, model.contention), (3, 2, 0.5))
+        for w in workloads:
+            self.assertAlmostEqual(model.predict(w.program), w.cycles, delta=1.0)
+
+    def test_json_round_trip(self):
+        model = pm.PerfModel(dispatch=4, costs={"GEMM": [1.0, 2.0, 3.0, 4.0], "DMA_STORE": [5.0, 6.0, 7.0]})
+        again = pm.PerfModel.from_json(model.to_json())
+        self.assertEqual(again.costs, model.costs)
+        self.assertEqual(again.dispatch, 4)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,565 @@
+"""Design-space exploration over GEMM array size, SRAM capacity/banking,
+engine lanes and DMA burst length.
+
+Every configuration runs the same GPT-2 block workload (the one
+sim/verilator/testbenches/common/block_program.h generates). Cycles come
+from an analytical model; throughput is set against an area estimate, and
+the Pareto front (max tokens/s, min area) is reported.
+
+The analytical model:
+  - GEMM: exact count of gemm_engine's tile FSM for ARRAY_SIZE, including
+    the tile fetches its activation/weight buffers skip in the loop order
+    block_program.h picks
+  - DMA: burst setup + DDR latency + beats + byte-serial SRAM side.
+    Non-resident weights stream from DDR (DMA_STREAM / GEMM_STREAM)
+    instead of being staged when seq_len fits the GEMM accumulators:
+    the GEMM walks n, k, m, pops one 8-byte beat per cycle for each weight
+    tile, and only the part of the weight DMA it cannot hide is charged.
+    The O-projection and FFN-down GEMMs add their residual in the epilogue
+    (GEMM_RESIDUAL), one extra tile read per output tile. Under
+    grouped-query attention (--kv-heads) a group's QK^T is one M-stacked
+    GEMM and its PV batch shares B, so V's tiles load once per group.
+    With a sliding window (--window) shorter than seq_len, attention runs
+    per 16-row query block over just the keys in its band
+  - controller: fetch/decode/dispatch per instruction, barrier drain
+  - layernorm: exact count of the streaming engine, 5 cycles per SRAM
+    word of `lanes` elements plus 3 per row, 4 per word once gamma/beta
+    are cached (every row after the first, from a cold cache)
+  - softmax/gelu/vec: one element per lane per cycle plus per-row
+    overhead. npu_top still ties these engines off, so the RTL cannot
+    check this part yet.
+
+With --rtl, the configurations on the front are also built as Verilator
+variants (cmake -DNPU_TOP_PARAMS=-G...) and bench_block_scaling runs on
+each. The measured cycles are compared against the model's RTL-visible part
+(GEMM + DMA + controller + LayerNorm). ARRAY_SIZE, DMA_BURST_LEN, the
+LayerNorm lanes (LN_LANES) and the SRAM0 size (SRAM0_SIZE, whole 64KB
+banks) are RTL parameters; SRAM banking for parallel access and the other
+engines' lanes are model-only. Past 64KB, the activations and microcode
+stay in the first bank and weights that do not fit beside them are
+resident in the banks above it (block_program.h).
+
+Area is a relative estimate in kGE (thousand NAND2 equivalents) from
+per-component coefficients, not a synthesis result. Override the
+coefficients with --area-coeffs FILE.json.
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import itertools
+import json
+import os
+import subprocess
+import tempfile
+from dataclasses import asdict, dataclass
+from pathlib import Path
+
+
+REPO_ROOT = Path(__file__).resolve().parents[2]
+SIM_DIR = REPO_ROOT / "sim" / "verilator"
+
+UCODE_REGION_BYTES = 2560
+BANK_KB = 64  # SRAM0 bank size; addresses past it need SRAM_BASE
+DDR_LATENCY = 8  # matches the default DdrConfig in common/axi_ddr_model.h
+LN_PARAM_DIM = 256  # npu_top's LN_PARAM_DIM: longest row the gamma/beta cache holds
+STAGING_BYTES = 16384  # BlockConfig::staging_bytes
+GEMM_TILE = 16  # block_program.h GEMM_TILE: rows per sliding-window query block
+
+AREA_KGE = {
+    "mac": 0.55,                # INT8 x INT8 multiplier + 32-bit accumulator per PE
+    "array_edge": 0.8,          # skew/drain registers per array row
+    "sram_per_kb": 5.0,
+    "sram_bank": 2.0,           # decoder/sense periphery per bank
+    "engine_base": 4.0,         # per vector engine (softmax, layernorm, gelu, vec)
+    "lane_softmax": 2.0,
+    "lane_layernorm": 2.6,
+    "lane_gelu": 0.6,
+    "lane_vec": 0.4,
+    "dma_base": 3.0,
+    "dma_per_beat": 0.07,       # burst tracking/buffering per beat
+    "controller": 6.0,
+}
+
+
+@dataclass(frozen=True)
+class Config:
+    array_size: int
+    sram0_kb: int
+    sram_banks: int
+    lanes: int
+    dma_burst_len: int
+
+    @property
+    def tag(self) -> str:
+        return (f"a{self.array_size}_s{self.sram0_kb}k_b{self.sram_banks}"
+                f"_l{self.lanes}_d{self.dma_burst_len}")
+
+    def rtl_params(self) -> dict[str, int]:
+        return {"ARRAY_SIZE": self.array_size, "DMA_BURST_LEN": self.dma_burst_len,
+                "LN_LANES": self.lanes, "SRAM0_SIZE": max(self.sram0_kb, BANK_KB) * 1024}
+
+
+@dataclass(frozen=True)
+class Workload:
+    seq_len: int = 16
+    hidden: int = 64
+    heads: int = 4
+    ffn_mult: int = 4
+    kv_heads: int = 0  # 0 = heads (MHA), 1 = MQA
+    window: int = 0    # sliding-window attention, 0 = full causal
+
+    @property
+    def kv(self) -> int:
+        return self.kv_heads or self.heads
+
+    @property
+    def group(self) -> int:
+        """Query heads per K/V head."""
+        return self.heads // self.kv
+
+    @property
+    def ffn(self) -> int:
+        return self.hidden * self.ffn_mult
+
+    @property
+    def head_dim(self) -> int:
+        return self.hidden // self.heads
+
+    @property
+    def kv_dim(self) -> int:
+        """Columns of K (and of V)."""
+        return self.kv * self.head_dim
+
+    @property
+    def banded(self) -> bool:
+        """Sliding-window prefill in query blocks (block_program.h banded())."""
+        return 0 < self.window < self.seq_len and self.head_dim & (self.head_dim - 1) == 0
+
+    def query_blocks(self) -> list[tuple[int, int]]:
+        """(rows, band keys) per query block: one block of every row unless
+        banded, else GEMM_TILE-row blocks scoring from their first row's
+        window start, rounded down to a tile."""
+        s, w = self.seq_len, self.window
+        if not self.banded:
+            return [(s, s)]
+        return [(min(GEMM_TILE, s - i0), min(s, i0 + GEMM_TILE) - max(0, i0 + 1 - w) // GEMM_TILE * GEMM_TILE)
+                for i0 in range(0, s, GEMM_TILE)]
+
+    def score_slice(self) -> int:
+        """SCORES/PROBS bytes per batched head."""
+        blocks = self.query_blocks()
+        return max(rows for rows, _ in blocks) * max(band for _, band in blocks)
+
+    def weight_bytes(self) -> int:
+        return 2 * self.hidden * self.hidden + 2 * self.hidden * self.kv_dim + 2 * self.hidden * self.ffn
+
+    def activation_bytes(self, heads_per_batch: int = 1) -> int:
+        s, h = self.seq_len, self.hidden
+        # Mirrors block_program.h: LN1/LN2 share one output, plus gamma/beta;
+        # K/V are kv_dim wide; scores/probs hold one [s, s] slice per batched
+        # head. The residual adds are GEMM epilogues, so there are no
+        # separate pre-add outputs
+        return 6 * s * h + 2 * s * self.kv_dim + 2 * heads_per_batch * self.score_slice() + s * self.ffn + 4 * h
+
+    def gemms(self, heads_per_batch: int = 1) -> list[tuple[int, int, int, bool, int, bool]]:
+        """(m, k, n, has_weights, batch, shared_b) in program order. Q/K/V is
+        one fused N = hidden + 2*kv_dim GEMM when head_dim is a power of two,
+        and QK^T / PV then run strided-batched over heads_per_batch heads
+        (block_program.h). Under GQA a group's QK^T stacks its query heads
+        along M, and PV batches them over one V (shared_b). Banded
+        attention batches a head group's query block over its heads (MHA)
+        or each K/V head's query heads (shared_b)."""
+        s, h, d, f, g, r = self.seq_len, self.hidden, self.head_dim, self.ffn, heads_per_batch, self.group
+        kvd = self.kv_dim
+        if d & (d - 1) == 0:
+            out = [(s, h, h + 2 * kvd, True, 1, False)]
+        else:
+            out = [(s, h, h, True, 1, False), (s, h, kvd, True, 1, False), (s, h, kvd, True, 1, False)]
+        for _ in range(self.heads // g):
+            if self.banded:
+                b = g if r == 1 else min(r, g)
+                for rows, band in self.query_blocks():
+                    out += [(rows, d, band, False, b, r > 1)] * (g // b)
+                    out += [(rows, band, d, False, b, r > 1)] * (g // b)
+            elif g == 1 or r == 1:
+                out += [(s, d, s, False, g, False), (s, s, d, False, g, False)]
+            else:
+                out += [(r * s, d, s, False, g // r, False)] + [(s, s, d, False, r, True)] * (g // r)
+        out += [(s, h, h, True, 1, False), (s, h, f, True, 1, False), (s, f, h, True, 1, False)]
+        return out
+
+
+def _tiles(dim: int, a: int) -> int:
+    return (dim + a - 1) // a
+
+
+LOOP_MNK, LOOP_NMK, LOOP_KMN = 0, 1, 2  # GEMM_ORDER, outermost loop first
+LOOP_NKM = 3  # GEMM_STREAM's fixed weight-stationary walk
+GEMM_BUF_TILES = 16  # gemm_engine ACT_BUF_TILES / WGT_BUF_TILES / ACC_BUF_TILES
+
+
+def tile_fetches(m: int, k: int, n: int, a: int, order: int = LOOP_MNK) -> tuple[int, int, int]:
+    """(weight tiles, activation tiles, operand bytes) gemm_engine fetches
+    in a loop order; tiles still in their direct-mapped buffer slot are not
+    fetched again (gemm_operand_reads in block_program.h). Streamed weight
+    tiles count their bytes padded to whole 8-byte beats."""
+    tm, tk, tn = _tiles(m, a), _tiles(k, a), _tiles(n, a)
+    if order == LOOP_KMN and tm * tn > GEMM_BUF_TILES:
+        order = LOOP_MNK
+    if order == LOOP_MNK:
+        walk = ((i, j, l) for i in range(tm) for j in range(tn) for l in range(tk))
+    elif order == LOOP_NMK:
+        walk = ((i, j, l) for j in range(tn) for i in range(tm) for l in range(tk))
+    elif order == LOOP_NKM:
+        walk = ((i, j, l) for j in range(tn) for l in range(tk) for i in range(tm))
+    else:
+        walk = ((i, j, l) for l in range(tk) for i in range(tm) for j in range(tn))
+    act, wgt = [-1] * GEMM_BUF_TILES, [-1] * GEMM_BUF_TILES
+    w_loads = a_loads = nbytes = 0
+    for i, j, l in walk:
+        rows, cols, depth = min(a, m - i * a), min(a, n - j * a), min(a, k - l * a)
+        a_id = i * tk + l
+        w_id = l * tn + j if order == LOOP_KMN else j * tk + l
+        if act[a_id % GEMM_BUF_TILES] != a_id:
+            act[a_id % GEMM_BUF_TILES] = a_id
+            a_loads += 1
+            nbytes += rows * depth
+        if wgt[w_id % GEMM_BUF_TILES] != w_id:
+            wgt[w_id % GEMM_BUF_TILES] = w_id
+            w_loads += 1
+            nbytes += -(-depth * cols // 8) * 8 if order == LOOP_NKM else depth * cols
+    return w_loads, a_loads, nbytes
+
+
+def best_loop_order(m: int, k: int, n: int, a: int, current: int = LOOP_MNK) -> int:
+    """Order block_program.h switches to: fewest operand bytes, ties keep
+    the current one."""
+    best = current
+    for order in (LOOP_MNK, LOOP_NMK, LOOP_KMN):
+        if tile_fetches(m, k, n, a, order)[2] < tile_fetches(m, k, n, a, best)[2]:
+            best = order
+    return best
+
+
+def stream_beats(k: int, n: int, a: int) -> int:
+    """8-byte beats of a pre-tiled streamed [k, n] weight, each tile row
+    padded to whole beats (weight_stream_bytes in block_program.h)."""
+    return sum(min(a, k - l) * -(-min(a, n - j) // 8) for j in range(0, n, a) for l in range(0, k, a))
+
+
+def gemm_cycles(m: int, k: int, n: int, a: int, batch: int = 1, order: int = LOOP_MNK,
+                shared_b: bool = False) -> int:
+    """gemm_engine busy cycles: per tile COMPUTE (tm+tk+tn+5) + NEXT_TILE,
+    one LOAD_WEIGHT / LOAD_ACT per fetched tile, one STORE per output tile,
+    one DONE. A batch boundary skips NEXT_TILE and LOAD_WEIGHT (the fill
+    overlaps the drain). With a shared B (batch stride 0) the weight tiles
+    stay buffered, so later batches fetch none when they all fit. A
+    streamed weight tile (LOOP_NKM) takes one LOAD_WEIGHT cycle per beat,
+    assuming the FIFO never runs dry."""
+    tm, tk, tn = _tiles(m, a), _tiles(k, a), _tiles(n, a)
+    tiles = tm * tk * tn
+    w_loads, a_loads, _ = tile_fetches(m, k, n, a, order)
+    if order == LOOP_NKM:
+        w_loads = stream_beats(k, n, a)
+    single = tn * tk * m + tm * tk * n + tm * tn * k + 6 * tiles + w_loads + a_loads + tm * tn
+    reused = (batch - 1) * (w_loads - 1) if shared_b and tn * tk <= GEMM_BUF_TILES else 0
+    return batch * single - 2 * (batch - 1) - reused + 1
+
+
+def dma_cycles(nbytes: int, burst_len: int, latency: int = DDR_LATENCY) -> int:
+    bursts = -(-nbytes // (8 * burst_len))
+    return nbytes + bursts * (2 + latency + burst_len)
+
+
+def bank0_free(cfg: Config, wl: Workload) -> int:
+    """Bytes left in the first 64KB bank (all 16-bit addresses reach with
+    zero bases) after the microcode and activations."""
+    bank0 = min(cfg.sram0_kb, BANK_KB) * 1024
+    return bank0 - UCODE_REGION_BYTES - wl.activation_bytes()
+
+
+def weights_banked(cfg: Config, wl: Workload) -> bool:
+    """Weights too big for bank 0 live in the banks above it, with their
+    gamma/beta (BlockProgram::weights_banked)."""
+    upper = max(cfg.sram0_kb - BANK_KB, 0) * 1024
+    return wl.weight_bytes() > bank0_free(cfg, wl) and wl.weight_bytes() + 4 * wl.hidden + 16 <= upper
+
+
+def base_loads(cfg: Config, wl: Workload) -> int:
+    """SRAM_BASE instructions of a banked layout: src1's bank follows
+    gamma/beta and the weights (one GEMM per weight matrix), drops to bank 0
+    for attention, and every base is cleared before END."""
+    if not weights_banked(cfg, wl):
+        return 0
+    h, kvd, bank = wl.hidden, wl.kv_dim, BANK_KB * 1024
+    # Upper-bank layout: gamma/beta | W_QKV | W_O | W_UP | W_DOWN
+    qkv = [bank + 4 * h]
+    if wl.head_dim & (wl.head_dim - 1):
+        qkv += [qkv[0] + h * h, qkv[0] + h * (h + kvd)]
+    w_o = qkv[0] + h * (h + 2 * kvd)
+    w_up = w_o + h * h
+    w_down = w_up + h * wl.ffn
+    banks = [1] + [a // bank for a in qkv] + [0, w_o // bank, 1, w_up // bank, w_down // bank, 0]
+    return sum(1 for prev, b in zip([0] + banks, banks) if b != prev)
+
+
+def weights_resident(cfg: Config, wl: Workload) -> bool:
+    return wl.weight_bytes() <= bank0_free(cfg, wl) or weights_banked(cfg, wl)
+
+
+def weights_streamed(cfg: Config, wl: Workload) -> bool:
+    """Non-resident weights stream through the weight FIFO when every row
+    of a GEMM fits the engine's accumulators (BlockConfig::stream_weights)."""
+    return not weights_resident(cfg, wl) and wl.seq_len <= cfg.array_size * GEMM_BUF_TILES
+
+
+def heads_per_batch(cfg: Config, wl: Workload) -> int:
+    """Heads per batched QK^T / PV: as many as block_program.h fits without
+    losing weight residency or shrinking the weight staging buffer."""
+    if wl.head_dim & (wl.head_dim - 1):
+        return 1
+    free = bank0_free(cfg, wl)
+    if weights_banked(cfg, wl):
+        keep = 0
+    elif weights_resident(cfg, wl):
+        keep = wl.weight_bytes()
+    elif weights_streamed(cfg, wl):
+        keep = 0
+    else:
+        keep = max(min(STAGING_BYTES, free), 16 * wl.ffn)
+    # Under GQA a batch is whole groups of query heads, or a single head
+    g, r = wl.heads, wl.group
+    while g > 1 and free - 2 * (g - 1) * wl.score_slice() < keep:
+        g = g // 2 if g % (2 * r) == 0 else r if g > r else 1
+    return g
+
+
+def model_cycles(cfg: Config, wl: Workload) -> dict[str, int]:
+    s, h, f, lanes = wl.seq_len, wl.hidden, wl.ffn, cfg.lanes
+    resident, streamed = weights_resident(cfg, wl), weights_streamed(cfg, wl)
+    g = heads_per_batch(cfg, wl)
+    gemms = wl.gemms(g)
+
+    # Weight GEMMs pick their loop order; attention GEMMs inherit it.
+    # Streamed weight GEMMs walk NKM without touching GEMM_ORDER.
+    orders, selected, order = [], [], LOOP_MNK
+    for m, k, n, w, _, _ in gemms:
+        if w and streamed:
+            orders.append(LOOP_NKM)
+            continue
+        if w:
+            order = best_loop_order(m, k, n, cfg.array_size, order)
+        orders.append(order)
+        selected.append(order)
+    gemm = sum(gemm_cycles(m, k, n, cfg.array_size, b, o, sb) for (m, k, n, _, b, sb), o in zip(gemms, orders))
+    # O-projection and FFN down: one LOAD_RESID_TILE per output tile
+    gemm += 2 * _tiles(s, cfg.array_size) * _tiles(h, cfg.array_size)
+
+    dma_bytes = 2 * s * h + (0 if resident or streamed else wl.weight_bytes())
+    dma = dma_cycles(dma_bytes, cfg.dma_burst_len)
+    if streamed:
+        # DMA_STREAM skips the byte-serial SRAM side and runs under the
+        # GEMM that pops its beats; charge only the DDR time it cannot hide
+        for m, k, n, w, _, _ in gemms:
+            if w:
+                beats = stream_beats(k, n, cfg.array_size)
+                fill = -(-beats // cfg.dma_burst_len) * (2 + DDR_LATENCY) + beats
+                dma += max(0, fill - gemm_cycles(m, k, n, cfg.array_size, 1, LOOP_NKM))
+    elif not resident and cfg.sram_banks >= 2:
+        # A second bank lets weight staging overlap the consuming GEMM
+        weight_dma = dma_cycles(wl.weight_bytes(), cfg.dma_burst_len)
+        dma -= min(weight_dma, sum(gemm_cycles(m, k, n, cfg.array_size, b, o)
+                                   for (m, k, n, w, b, _), o in zip(gemms, orders) if w))
+
+    blocks = wl.query_blocks()
+    softmax = wl.heads * sum(rows * (3 * -(-band // lanes) + 4) for rows, band in blocks)
+    words = -(-h // lanes)
+    cached_rows = s - 1 if h <= LN_PARAM_DIM else 0
+    layernorm = 2 * (s * (5 * words + 3) - cached_rows * words + 2)
+    gelu = -(-(s * f) // lanes) + 2
+    vec = 0  # both residual adds run in the GEMM epilogue
+
+    # One instruction per op plus a barrier after each dependent step. A
+    # batched head group is 2 GEMM_BATCH + 2 GEMM + g SOFTMAX + 3 barriers;
+    # under GQA its QK^T is one GEMM (batched over g/r K heads if several)
+    # and its PV one GEMM_BATCH + GEMM pair per K/V head. Banded attention
+    # repeats that per query block, with a GEMM_BATCH before each batched
+    # QK^T and every PV.
+    # Streamed weight GEMMs add one DMA_STREAM, and the two residual GEMMs
+    # one GEMM_RESIDUAL, without a barrier.
+    n_ops = len(gemms) + wl.heads * len(blocks) + 2 + 1 + 2
+    weight_gemms = sum(1 for _, _, _, w, _, _ in gemms if w)
+    if not resident and not streamed:
+        n_ops += 2 * weight_gemms
+    n_instrs = 2 * n_ops + (weight_gemms if streamed else 0) + 2
+    if wl.banded:
+        b = g if wl.group == 1 else min(wl.group, g)
+        n_instrs += (wl.heads // g) * len(blocks) * (3 - g - (g // b if b == 1 else 0))
+    elif g > 1:
+        n_instrs += (wl.heads // g) * (2 - g + (g // wl.group > 1))
+    # GEMM_ORDER switches, plus the reset to MNK before END
+    switches = sum(1 for prev, o in zip([LOOP_MNK] + selected, selected) if o != prev)
+    n_instrs += switches + (selected[-1] != LOOP_MNK if selected else 0)
+    n_instrs += base_loads(cfg, wl)
+    ctrl = 3 * n_instrs
+
+    return {
+        "gemm": gemm, "dma": dma, "ctrl": ctrl,
+        "softmax": softmax, "layernorm": layernorm, "gelu": gelu, "vec": vec,
+        "rtl_visible": gemm + dma + ctrl + layernorm,
+        "total": gemm + dma + ctrl + softmax + layernorm + gelu + vec,
+    }
+
+
+def area_kge(cfg: Config, coeffs: dict[str, float]) -> float:
+    a = cfg.array_size
+    array = a * a * coeffs["mac"] + a * coeffs["array_edge"]
+    sram = cfg.sram0_kb * coeffs["sram_per_kb"] + cfg.sram_banks * coeffs["sram_bank"]
+    lanes = cfg.lanes * (coeffs["lane_softmax"] + coeffs["lane_layernorm"]
+                         + coeffs["lane_gelu"] + coeffs["lane_vec"])
+    engines = 4 * coeffs["engine_base"] + lanes
+    dma = coeffs["dma_base"] + cfg.dma_burst_len * coeffs["dma_per_beat"]
+    return array + sram + engines + dma + coeffs["controller"]
+
+
+def pareto_front(rows: list[dict]) -> list[dict]:
+    """Rows not dominated in (area lower, tokens/s higher)."""
+    front, best = [], -1.0
+    for row in sorted(rows, key=lambda r: (r["area_kge"], -r["tokens_per_s"])):
+        if row["tokens_per_s"] > best:
+            front.append(row)
+            best = row["tokens_per_s"]
+    return front
+
+
+def run_rtl(cfg: Config, wl: Workload, build_root: Path, jobs: int) -> int | None:
+    params = " ".join(f"-G{k}={v}" for k, v in cfg.rtl_params().items())
+    build_dir = build_root / f"a{cfg.array_size}_d{cfg.dma_burst_len}_l{cfg.lanes}_s{cfg.sram0_kb}k"
+    steps = [
+        ["cmake", "-S", str(SIM_DIR), "-B", str(build_dir), f"-DNPU_TOP_PARAMS={params}"],
+        ["cmake", "--build", str(build_dir), "--target", "bench_block_scaling", "sram_init", f"-j{jobs}"],
+    ]
+    for cmd in steps:
+        if subprocess.run(cmd, capture_output=True, text=True).returncode != 0:
+            print(f"  [{cfg.tag}] build failed: {' '.join(cmd)}")
+            return None
+
+    with tempfile.TemporaryDirectory() as tmp:
+        perf = Path(tmp) / "perf.csv"
+        env = dict(os.environ, NPU_PERF_OUT=str(perf))
+        cmd = ["./bench_block_scaling", "--hidden", str(wl.hidden), "--max-seq", str(wl.seq_len),
+               "--csv", str(Path(tmp) / "scaling.csv"), "--sram-kb", str(cfg.sram0_kb)]
+        if wl.kv_heads:
+            cmd += ["--kv-heads", str(wl.kv_heads)]
+        if wl.window:
+            cmd += ["--window", str(wl.window)]
+        proc = subprocess.run(cmd, cwd=build_dir, env=env, capture_output=True, text=True)
+        if proc.returncode != 0 or not perf.exists():
+            print(f"  [{cfg.tag}] bench_block_scaling failed")
+            return None
+        key = f"h{wl.hidden}_s{wl.seq_len}_cycles"
+        for line in perf.read_text().splitlines():
+            metric, _, value = line.partition(",")
+            if metric == key:
+                return int(value)
+    return None
+
+
+def parse_list(text: str) -> list[int]:
+    return [int(v) for v in text.split(",") if v]
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--array-sizes", default="4,8,16,32")
+    parser.add_argument("--sram-kb", default="64,128,256")
+    parser.add_argument("--sram-banks", default="1,2,4")
+    parser.add_argument("--lanes", default="1,4,16")
+    parser.add_argument("--dma-burst", default="4,8,16,32")
+    parser.add_argument("--seq-len", type=int, default=16)
+    parser.add_argument("--hidden", type=int, default=64)
+    parser.add_argument("--kv-heads", type=int, default=0, help="K/V heads for grouped-query attention")
+    parser.add_argument("--window", type=int, default=0, help="sliding-window attention width")
+    parser.add_argument("--clock-mhz", type=float, default=200.0)
+    parser.add_argument("--area-coeffs", help="JSON file overriding area coefficients (kGE)")
+    parser.add_argument("--rtl", action="store_true",
+                        help="build and run Verilator variants for configurations on the front")
+    parser.add_argument("--build-root", default=str(SIM_DIR / "build_dse"))
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--out", default="dse_results.csv")
+    args = parser.parse_args()
+
+    coeffs = dict(AREA_KGE)
+    if args.area_coeffs:
+        coeffs.update(json.loads(Path(args.area_coeffs).read_text()))
+
+    wl = Workload(seq_len=args.seq_len, hidden=args.hidden, kv_heads=args.kv_heads, window=args.window)
+    space = itertools.product(parse_list(args.array_sizes), parse_list(args.sram_kb),
+                              parse_list(args.sram_banks), parse_list(args.lanes),
+                              parse_list(args.dma_burst))
+
+    rows = []
+    for values in space:
+        cfg = Config(*values)
+        cycles = model_cycles(cfg, wl)
+        rows.append({
+            **asdict(cfg),
+            "tag": cfg.tag,
+            "weights_resident": weights_resident(cfg, wl),
+            "weights_streamed": weights_streamed(cfg, wl),
+            "model_cycles": cycles["total"],
+            "model_rtl_visible": cycles["rtl_visible"],
+            **{f"{k}_cycles": v for k, v in cycles.items() if k not in ("total", "rtl_visible")},
+            "tokens_per_s": wl.seq_len * args.clock_mhz * 1e6 / cycles["total"],
+            "area_kge": round(area_kge(cfg, coeffs), 2),
+            "rtl_cycles": "",
+            "rtl_error_pct": "",
+            "pareto": False,
+        })
+
+    front = pareto_front(rows)
+    for row in front:
+        row["pareto"] = True
+
+    if args.rtl:
+        build_root = Path(args.build_root)
+        measured: dict[tuple[int, int, int, int], int | None] = {}
+        for row in front:
+            cfg = Config(row["array_size"], row["sram0_kb"], row["sram_banks"], row["lanes"],
+                         row["dma_burst_len"])
+            key = (cfg.array_size, cfg.dma_burst_len, cfg.lanes, cfg.sram0_kb)
+            # Parallel SRAM banking is model-only, so compare against one bank
+            rtl_cfg = Config(cfg.array_size, cfg.sram0_kb, 1, cfg.lanes, cfg.dma_burst_len)
+            if key not in measured:
+                print(f"Building RTL variant ARRAY_SIZE={key[0]} DMA_BURST_LEN={key[1]} LN_LANES={key[2]} "
+                      f"SRAM0_SIZE={key[3]}KB ...")
+                measured[key] = run_rtl(rtl_cfg, wl, build_root, args.jobs)
+                if measured[key] is not None:
+                    expect = model_cycles(rtl_cfg, wl)["rtl_visible"]
+                    err = 100.0 * (expect - measured[key]) / measured[key]
+                    print(f"  rtl={measured[key]} model={expect} ({err:+.1f}%)")
+            rtl = measured[key]
+            if rtl is not None:
+                expect = model_cycles(rtl_cfg, wl)["rtl_visible"]
+                row["rtl_cycles"] = rtl
+                row["rtl_error_pct"] = round(100.0 * (expect - rtl) / rtl, 2)
+
+    with open(args.out, "w", newline="") as fh:
+        writer = csv.DictWriter(fh, fieldnames=list(rows[0].keys()))
+        writer.writeheader()
+        writer.writerows(rows)
+
+    print(f"Workload: GPT-2 block seq_len={wl.seq_len} hidden={wl.hidden} "
+          f"({len(rows)} configurations, clock {args.clock_mhz:g} MHz)")
+    print("Pareto front (area vs tokens/s):")
+    print("  config                    area_kGE   cycles   tokens/s  resident  rtl_cycles")
+    for row in front:
+        print(f"  {row['tag']:<24} {row['area_kge']:>9.1f} {row['model_cycles']:>8} "
+              f"{row['tokens_per_s']:>10.0f}  {str(row['weights_resident']):>8}  {row['rtl_cycles']:>10}")
+    print(f"Wrote {args.out}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,448 @@
+"""Analytical cycle model for tiny-npu microcode, calibrated against RTL.
+
+Predicts total cycles for an instruction stream. It replays the
+microcode_controller's in-order dispatch:
+  - fixed fetch/decode/dispatch cost per instruction, less the FETCH
+    the upper half of a compact 64-bit pair skips
+  - dispatch stalls while the target engine's scoreboard bit is set
+  - BARRIER drains every engine
+  - CALL/RET jump through the return stack, so a called body is
+    replayed once per call
+  - a non-DMA op that overlaps a DMA transfer is slowed down, because
+    DMA has priority on SRAM0 port A (DMA_STREAM bypasses SRAM0)
+  - each engine op costs an affine function of its dimensions
+    (cycles = c0 + sum(ci * feature_i))
+
+Costs are not hand-tuned. `fit` reads a directory written by
+bench_perf_calibration (calibration.csv, ops.csv, <workload>.bin) and fits
+them in two steps. Per-opcode costs come from least squares on the
+measured per-instruction latencies. The controller overheads then come
+from a small grid search on whole-program cycles. The fit reports the
+error per workload, including the holdout workloads that were not fitted.
+
+Usage:
+  python3 python/tools/perf_model.py fit CALIB_DIR [--out perf_model.json]
+  python3 python/tools/perf_model.py eval MODEL.json CALIB_DIR
+  python3 python/tools/perf_model.py predict MODEL.json PROGRAM.bin [...]
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import itertools
+import json
+import struct
+from dataclasses import dataclass, field, replace
+from pathlib import Path
+
+import numpy as np
+
+
+SCHEMA = "tiny-npu-perf-model/1"
+
+# Opcodes and engine IDs (match sim/verilator/testbenches/common/npu_utils.h)
+OP_NOP, OP_DMA_LOAD, OP_DMA_STORE, OP_GEMM, OP_VEC = 0x00, 0x01, 0x02, 0x03, 0x04
+OP_SOFTMAX, OP_LAYERNORM, OP_GELU = 0x05, 0x06, 0x07
+OP_VEC_ADD, OP_VEC_MUL, OP_VEC_COPY = 0x08, 0x09, 0x0A
+OP_LUT_LOAD, OP_GEMM_BATCH, OP_GEMM_W4, OP_GEMM_ORDER = 0x0B, 0x0C, 0x0D, 0x0E
+OP_DMA_STREAM, OP_GEMM_STREAM, OP_GEMM_RESIDUAL = 0x0F, 0x10, 0x11
+OP_SRAM_BASE, OP_CALL, OP_RET = 0x13, 0x14, 0x15
+OP_BARRIER, OP_END = 0xFE, 0xFF
+
+OPCODE_NAMES = {
+    OP_NOP: "NOP", OP_DMA_LOAD: "DMA_LOAD", OP_DMA_STORE: "DMA_STORE", OP_GEMM: "GEMM",
+    OP_VEC: "VEC", OP_SOFTMAX: "SOFTMAX", OP_LAYERNORM: "LAYERNORM", OP_GELU: "GELU",
+    OP_VEC_ADD: "VEC_ADD", OP_VEC_MUL: "VEC_MUL", OP_VEC_COPY: "VEC_COPY", OP_LUT_LOAD: "LUT_LOAD",
+    OP_GEMM_BATCH: "GEMM_BATCH", OP_GEMM_W4: "GEMM_W4", OP_GEMM_ORDER: "GEMM_ORDER",
+    OP_DMA_STREAM: "DMA_STREAM", OP_GEMM_STREAM: "GEMM_STREAM", OP_GEMM_RESIDUAL: "GEMM_RESIDUAL",
+    OP_SRAM_BASE: "SRAM_BASE", OP_CALL: "CALL", OP_RET: "RET",
+    OP_BARRIER: "BARRIER", OP_END: "END",
+}
+
+ENGINE_GEMM, ENGINE_SOFTMAX, ENGINE_LAYERNORM, ENGINE_GELU, ENGINE_VEC, ENGINE_DMA = range(6)
+NUM_ENGINES = 6
+ENGINE_NAMES = ["gemm", "softmax", "layernorm", "gelu", "vec", "dma"]
+ENGINE_OF = {
+    OP_GEMM: ENGINE_GEMM, OP_GEMM_W4: ENGINE_GEMM, OP_SOFTMAX: ENGINE_SOFTMAX, OP_LAYERNORM: ENGINE_LAYERNORM,
+    OP_GELU: ENGINE_GELU, OP_VEC: ENGINE_VEC, OP_VEC_ADD: ENGINE_VEC, OP_VEC_MUL: ENGINE_VEC,
+    OP_VEC_COPY: ENGINE_VEC, OP_DMA_LOAD: ENGINE_DMA, OP_DMA_STORE: ENGINE_DMA,
+    OP_DMA_STREAM: ENGINE_DMA, OP_GEMM_STREAM: ENGINE_GEMM,
+}
+
+INSTR_FORMAT = struct.Struct("<BBHHHHHHH")  # opcode flags dst src0 src1 m n k imm
+CALL_DEPTH = 4  # microcode_controller return stack entries
+# Compact 64-bit encoding (match npu_utils.h): two per 16-byte slot, the
+# low byte of each starts 2'b10, addresses are 16-byte granules
+COMPACT_MARK = 0x80
+COMPACT_OPCODES = [OP_NOP, OP_DMA_LOAD, OP_DMA_STORE, OP_VEC, OP_SOFTMAX, OP_LAYERNORM, OP_GELU, OP_VEC_ADD,
+                   OP_VEC_MUL, OP_VEC_COPY, OP_GEMM_RESIDUAL, OP_GEMM_BATCH, OP_SRAM_BASE, OP_RET, OP_BARRIER,
+                   OP_END]
+GEMM_BATCHED = 0x08  # GEMM flags[3]: use the count/strides of the last GEMM_BATCH
+
+
+@dataclass(frozen=True)
+class Instr:
+    opcode: int
+    flags: int = 0
+    dst: int = 0
+    src0: int = 0
+    src1: int = 0
+    m: int = 0
+    n: int = 0
+    k: int = 0
+    imm: int = 0
+    batch: int = 1  # GEMMs run by a batched GEMM; set by decode_program, not encoded
+    residual: bool = False  # GEMM preceded by GEMM_RESIDUAL; set by decode_program
+    paired: bool = False  # upper half of a compact slot; set by decode_program
+
+    @property
+    def engine(self) -> int | None:
+        if self.opcode == OP_LUT_LOAD:
+            return ENGINE_SOFTMAX if self.imm & 1 else ENGINE_GELU
+        return ENGINE_OF.get(self.opcode)
+
+    @property
+    def name(self) -> str:
+        return OPCODE_NAMES.get(self.opcode, f"0x{self.opcode:02X}")
+
+
+def compact_fits(instr: Instr) -> bool:
+    return (instr.opcode in COMPACT_OPCODES and instr.flags < 4 and instr.k == 0 and instr.imm == 0
+            and (instr.dst | instr.src0 | instr.src1) & 15 == 0 and instr.m < 256 and instr.n < 4096)
+
+
+def _pack_compact(instr: Instr) -> bytes:
+    word = (COMPACT_OPCODES.index(instr.opcode) | instr.flags << 4 | COMPACT_MARK | (instr.dst >> 4) << 8
+            | (instr.src0 >> 4) << 20 | (instr.src1 >> 4) << 32 | instr.m << 44 | instr.n << 52)
+    return word.to_bytes(8, "little")
+
+
+def _unpack_compact(half: bytes) -> Instr:
+    word = int.from_bytes(half, "little")
+    return Instr(COMPACT_OPCODES[word & 0xF], (word >> 4) & 3, ((word >> 8) & 0xFFF) << 4,
+                 ((word >> 20) & 0xFFF) << 4, ((word >> 32) & 0xFFF) << 4, (word >> 44) & 0xFF, word >> 52)
+
+
+def decode_program(data: bytes) -> list[Instr]:
+    """Split a microcode image (16-byte slots, each one full instruction or
+    a compact pair) into Instrs, with CALL targets as instruction indices.
+    GEMM_BATCH counts apply to later BATCHED GEMMs; GEMM_RESIDUAL applies to
+    the next GEMM only."""
+    if len(data) % INSTR_FORMAT.size:
+        raise ValueError(f"microcode size {len(data)} is not a multiple of {INSTR_FORMAT.size}")
+    instrs, first = [], []
+    for off in range(0, len(data), INSTR_FORMAT.size):
+        first.append(len(instrs))
+        if data[off] & 0xC0 == COMPACT_MARK:
+            instrs.append(_unpack_compact(data[off:off + 8]))
+            instrs.append(replace(_unpack_compact(data[off + 8:off + 16]), paired=True))
+        else:
+            instrs.append(Instr(*INSTR_FORMAT.unpack_from(data, off)))
+    program, batch, residual = [], 1, False
+    for instr in instrs:
+        if instr.opcode == OP_CALL and instr.imm < len(first):
+            instr = replace(instr, imm=first[instr.imm])
+        if instr.opcode == OP_GEMM_BATCH:
+            batch = max(instr.m, 1)
+        elif instr.opcode == OP_GEMM_RESIDUAL:
+            residual = True
+        elif instr.engine == ENGINE_GEMM:
+            if instr.opcode != OP_GEMM_STREAM and instr.flags & GEMM_BATCHED:
+                instr = replace(instr, batch=batch)
+            instr = replace(instr, residual=residual)
+            residual = False
+        program.append(instr)
+    return program
+
+
+def encode_program(program: list[Instr], compact: bool = False) -> bytes:
+    """Inverse of decode_program. With compact, pairs adjacent instructions
+    that fit the 64-bit form like encode_microcode in npu_utils.h: never
+    into a CALL target, whose CALL is rewritten to the target's slot."""
+    targets = {i.imm for i in program if i.opcode == OP_CALL}
+    slots, slot_of, i = [], [], 0
+    while i < len(program):
+        slot_of.append(len(slots))
+        if (compact and i + 1 < len(program) and i + 1 not in targets and compact_fits(program[i])
+                and compact_fits(program[i + 1])):
+            slot_of.append(len(slots))
+            slots.append([program[i], program[i + 1]])
+            i += 2
+        else:
+            slots.append([program[i]])
+            i += 1
+    data = bytearray()
+    for slot in slots:
+        if len(slot) == 2:
+            data += _pack_compact(slot[0]) + _pack_compact(slot[1])
+            continue
+        instr = slot[0]
+        if instr.opcode == OP_CALL and instr.imm < len(program):
+            instr = replace(instr, imm=slot_of[instr.imm])
+        data += INSTR_FORMAT.pack(instr.opcode, instr.flags, instr.dst, instr.src0, instr.src1, instr.m,
+                                  instr.n, instr.k, instr.imm)
+    return bytes(data)
+
+
+def _ceil_div(a: int, b: int) -> int:
+    return -(-a // b)
+
+
+def stream_beats(k: int, n: int, a: int = 16) -> int:
+    """8-byte beats of W[k, n] pre-tiled for GEMM_STREAM: every row of an
+    a x a tile is padded to whole beats (weight_stream_bytes in block_program.h)."""
+    return sum(min(a, k - d) * _ceil_div(min(a, n - c), 8) for c in range(0, n, a) for d in range(0, k, a))
+
+
+def features(instr: Instr, array_size: int = 16, dma_burst_len: int = 16) -> tuple[list[str], list[float]]:
+    """Cost-model features of one engine instruction (intercept excluded)."""
+    op = instr.opcode
+    if op == OP_GEMM_STREAM:
+        # Weight-stationary walk, one B tile per FIFO beat run
+        a = array_size
+        tm, tk, tn = _ceil_div(instr.m, a), _ceil_div(instr.k, a), _ceil_div(instr.n, a)
+        edge = tn * tk * instr.m + tm * tk * instr.n + tm * tn * instr.k
+        return (["tiles", "output_tiles", "tile_edges", "beats", "residual_tiles"],
+                [tm * tn * tk, tm * tn, edge, stream_beats(instr.k, instr.n, a), instr.residual * tm * tn])
+    if op == OP_DMA_STREAM:
+        nbytes = instr.m | instr.n << 16
+        return ["bytes", "bursts"], [nbytes, _ceil_div(nbytes, 8 * dma_burst_len)]
+    if op in (OP_GEMM, OP_GEMM_W4):
+        a = array_size
+        # INT4 weights: two output columns per PE, so N tiles are 2a wide
+        tm, tk = _ceil_div(instr.m, a), _ceil_div(instr.k, a)
+        tn = _ceil_div(instr.n, 2 * a if op == OP_GEMM_W4 else a)
+        # Sum over tiles of (tile_m + tile_k + tile_n), the COMPUTE window;
+        # a strided batch repeats every tile once per batch. A residual
+        # epilogue reads one R tile per output tile.
+        edge = tn * tk * instr.m + tm * tk * instr.n + tm * tn * instr.k
+        b = instr.batch
+        return (["tiles", "output_tiles", "tile_edges", "residual_tiles"],
+                [b * tm * tn * tk, b * tm * tn, b * edge, instr.residual * b * tm * tn])
+    if op in (OP_SOFTMAX, OP_LAYERNORM):
+        return ["rows", "elements"], [instr.m, instr.m * instr.n]
+    if op in (OP_GELU, OP_VEC, OP_VEC_ADD, OP_VEC_MUL, OP_VEC_COPY):
+        return ["elements"], [instr.n]
+    if op in (OP_DMA_LOAD, OP_DMA_STORE):
+        return ["bytes", "bursts"], [instr.m, _ceil_div(instr.m, 8 * dma_burst_len)]
+    if op == OP_LUT_LOAD:
+        return ["table_bytes"], [512 if instr.imm & 1 else 256]
+    return [], []
+
+
+@dataclass
+class PerfModel:
+    array_size: int = 16
+    dma_burst_len: int = 16
+    dispatch: float = 3.0       # cycles per instruction (FETCH, DECODE, DISPATCH)
+    fetch: float = 1.0          # the FETCH an upper compact half skips
+    barrier: float = 1.0        # extra cycles to leave WAIT_BARRIER
+    overhead: float = 0.0       # start/END constant
+    contention: float = 0.0     # extra cycles per cycle of overlap with DMA
+    costs: dict[str, list[float]] = field(default_factory=dict)  # opcode name -> [c0, c1, ...]
+
+    def latency(self, instr: Instr) -> float:
+        coeffs = self.costs.get(instr.name)
+        if coeffs is None:
+            return 0.0
+        _, x = features(instr, self.array_size, self.dma_burst_len)
+        return max(0.0, coeffs[0] + sum(c * v for c, v in zip(coeffs[1:], x)))
+
+    def schedule(self, program: list[Instr]) -> dict:
+        """Replay in-order dispatch; returns total cycles and per-engine busy."""
+        t = 0.0
+        busy_until = [0.0] * NUM_ENGINES
+        busy = [0.0] * NUM_ENGINES
+        dma_windows: list[tuple[float, float]] = []
+        # CALL/RET follow the controller's wrapping return stack; a RET
+        # with no address left ends the program
+        ret_stack = [0] * CALL_DEPTH
+        sp, depth, pc = 0, 0, 0
+        while pc < len(program):
+            instr = program[pc]
+            pc += 1
+            t += self.dispatch - (self.fetch if instr.paired else 0.0)
+            if instr.opcode == OP_END:
+                break
+            if instr.opcode == OP_CALL:
+                ret_stack[sp], sp, pc = pc, (sp + 1) % CALL_DEPTH, instr.imm
+                depth = min(depth + 1, CALL_DEPTH)
+                continue
+            if instr.opcode == OP_RET:
+                if depth == 0:
+                    break
+                sp, depth = (sp - 1) % CALL_DEPTH, depth - 1
+                pc = ret_stack[sp]
+                continue
+            if instr.opcode == OP_BARRIER:
+                t = max(t, max(busy_until)) + self.barrier
+                continue
+            engine = instr.engine
+            if engine is None:
+                continue
+            t = max(t, busy_until[engine])
+            lat = self.latency(instr)
+            if engine == ENGINE_DMA:
+                # DMA_STREAM beats go to the weight FIFO, not SRAM0 port A
+                if instr.opcode != OP_DMA_STREAM:
+                    dma_windows.append((t, t + lat))
+            elif self.contention:
+                overlap = sum(max(0.0, min(t + lat, e) - max(t, s)) for s, e in dma_windows)
+                lat += self.contention * overlap
+            busy_until[engine] = t + lat
+            busy[engine] += lat
+        return {
+            "cycles": t + self.overhead,
+            "engine_busy": dict(zip(ENGINE_NAMES, busy)),
+        }
+
+    def predict(self, program: list[Instr]) -> float:
+        return self.schedule(program)["cycles"]
+
+    def to_json(self) -> dict:
+        costs = {}
+        for name, coeffs in self.costs.items():
+            opcode = next(op for op, n in OPCODE_NAMES.items() if n == name)
+            names, _ = features(Instr(opcode), self.array_size, self.dma_burst_len)
+            costs[name] = {"intercept": coeffs[0], "coefficients": dict(zip(names, coeffs[1:]))}
+        return {
+            "schema": SCHEMA,
+            "array_size": self.array_size,
+            "dma_burst_len": self.dma_burst_len,
+            "controller": {"dispatch": self.dispatch, "fetch": self.fetch, "barrier": self.barrier,
+                           "overhead": self.overhead, "dma_contention": self.contention},
+            "costs": costs,
+        }
+
+    @classmethod
+    def from_json(cls, doc: dict) -> "PerfModel":
+        if doc.get("schema") != SCHEMA:
+            raise ValueError(f"unsupported model schema {doc.get('schema')!r}")
+        ctrl = doc["controller"]
+        costs = {name: [c["intercept"], *c["coefficients"].values()] for name, c in doc["costs"].items()}
+        return cls(array_size=doc["array_size"], dma_burst_len=doc["dma_burst_len"],
+                   dispatch=ctrl["dispatch"], fetch=ctrl.get("fetch", 1.0), barrier=ctrl["barrier"], overhead=ctrl["overhead"],
+                   contention=ctrl["dma_contention"], costs=costs)
+
+
+@dataclass
+class Workload:
+    name: str
+    role: str
+    program: list[Instr]
+    cycles: int
+    op_latency: list[tuple[Instr, int]]  # (instr, measured issue->complete)
+
+
+def load_calibration(calib_dir: Path) -> list[Workload]:
+    workloads: dict[str, Workload] = {}
+    with open(calib_dir / "calibration.csv", newline="") as fh:
+        for row in csv.DictReader(fh):
+            program = decode_program((calib_dir / row["program"]).read_bytes())
+            workloads[row["workload"]] = Workload(row["workload"], row["role"], program, int(row["cycles"]), [])
+    with open(calib_dir / "ops.csv", newline="") as fh:
+        for row in csv.DictReader(fh):
+            w = workloads[row["workload"]]
+            if int(row["complete"]) == 0:
+                continue  # still busy at END
+            w.op_latency.append((w.program[int(row["index"])], int(row["complete"]) - int(row["issue"])))
+    return list(workloads.values())
+
+
+def fit_costs(workloads: list[Workload], array_size: int, dma_burst_len: int) -> dict[str, list[float]]:
+    """Least-squares affine cost per opcode from measured per-op latencies."""
+    samples: dict[str, tuple[list[list[float]], list[float]]] = {}
+    for w in workloads:
+        if w.role != "fit":
+            continue
+        for instr, lat in w.op_latency:
+            _, x = features(instr, array_size, dma_burst_len)
+            rows, ys = samples.setdefault(instr.name, ([], []))
+            rows.append([1.0, *x])
+            ys.append(float(lat))
+    costs = {}
+    for name, (rows, ys) in samples.items():
+        coeffs, *_ = np.linalg.lstsq(np.array(rows), np.array(ys), rcond=None)
+        costs[name] = [float(c) for c in coeffs]
+    return costs
+
+
+def fit(workloads: list[Workload], array_size: int = 16, dma_burst_len: int = 16) -> PerfModel:
+    model = PerfModel(array_size=array_size, dma_burst_len=dma_burst_len,
+                      costs=fit_costs(workloads, array_size, dma_burst_len))
+    fit_set = [w for w in workloads if w.role == "fit"]
+
+    best = None
+    for dispatch, barrier, contention in itertools.product(
+            (2.0, 3.0, 4.0, 5.0), (0.0, 1.0, 2.0, 3.0, 4.0), (0.0, 0.25, 0.5, 1.0)):
+        model.dispatch, model.barrier, model.contention, model.overhead = dispatch, barrier, contention, 0.0
+        residual = [w.cycles - model.predict(w.program) for w in fit_set]
+        # The start/END constant is the mean residual; score by relative error
+        overhead = float(np.mean(residual))
+        err = sum(((r - overhead) / max(w.cycles, 1)) ** 2 for r, w in zip(residual, fit_set))
+        if best is None or err < best[0]:
+            best = (err, dispatch, barrier, contention, overhead)
+
+    _, model.dispatch, model.barrier, model.contention, model.overhead = best
+    return model
+
+
+def report(model: PerfModel, workloads: list[Workload]) -> dict[str, float]:
+    print(f"  {'workload':<28} {'role':<8} {'measured':>10} {'predicted':>10} {'err%':>7}")
+    errors: dict[str, list[float]] = {}
+    for w in workloads:
+        pred = model.predict(w.program)
+        err = 100.0 * (pred - w.cycles) / max(w.cycles, 1)
+        errors.setdefault(w.role, []).append(abs(err))
+        print(f"  {w.name:<28} {w.role:<8} {w.cycles:>10} {pred:>10.0f} {err:>+7.2f}")
+    summary = {}
+    for role, errs in errors.items():
+        summary[f"{role}_mean_abs_err_pct"] = float(np.mean(errs))
+        summary[f"{role}_max_abs_err_pct"] = float(np.max(errs))
+        print(f"  {role}: mean |err| {np.mean(errs):.2f}%, max |err| {np.max(errs):.2f}% ({len(errs)} workloads)")
+    return summary
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Calibrated analytical cycle model for tiny-npu microcode")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p_fit = sub.add_parser("fit", help="fit a model from bench_perf_calibration output")
+    p_fit.add_argument("calib_dir")
+    p_fit.add_argument("--out", default="perf_model.json")
+    p_fit.add_argument("--array-size", type=int, default=16)
+    p_fit.add_argument("--dma-burst-len", type=int, default=16)
+
+    p_eval = sub.add_parser("eval", help="report a model's error on a calibration directory")
+    p_eval.add_argument("model")
+    p_eval.add_argument("calib_dir")
+
+    p_pred = sub.add_parser("predict", help="predict cycles for microcode images")
+    p_pred.add_argument("model")
+    p_pred.add_argument("programs", nargs="+")
+
+    args = parser.parse_args()
+
+    if args.cmd == "fit":
+        workloads = load_calibration(Path(args.calib_dir))
+        model = fit(workloads, args.array_size, args.dma_burst_len)
+        print(f"Fitted on {sum(w.role == 'fit' for w in workloads)} workloads: dispatch={model.dispatch:g} "
+              f"barrier={model.barrier:g} contention={model.contention:g} overhead={model.overhead:.1f}")
+        doc = model.to_json()
+        doc["error"] = report(model, workloads)
+        Path(args.out).write_text(json.dumps(doc, indent=2) + "\n")
+        print(f"Wrote {args.out}")
+    elif args.cmd == "eval":
+        model = PerfModel.from_json(json.loads(Path(args.model).read_text()))
+        report(model, load_calibration(Path(args.calib_dir)))
+    else:
+        model = PerfModel.from_json(json.loads(Path(args.model).read_text()))
+        for path in args.programs:
+            result = model.schedule(decode_program(Path(path).read_bytes()))
+            busy = " ".join(f"{k}={v:.0f}" for k, v in result["engine_busy"].items() if v)
+            print(f"{path}: {result['cycles']:.0f} cycles ({busy})")
+
+
+if __name__ == "__main__":
+    main()
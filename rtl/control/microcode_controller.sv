@@ -1,5 +1,6 @@
 // Microcode Controller
-// Fetches 128-bit instructions from SRAM and dispatches to engines
+// Fetches 128-bit instruction slots from SRAM and dispatches to engines. A
+// slot holds one full instruction or two compact 64-bit ones.
 // Uses scoreboard for out-of-order execution within dataflow constraints
 
 `timescale 1ns/1ps
@@ -8,6 +9,8 @@ module microcode_controller #(
     parameter DATA_WIDTH = 8,
     parameter ACC_WIDTH = 32,
     parameter ADDR_WIDTH = 16,
+    parameter SRAM_ADDR_WIDTH = 16,  // engine operand addresses (SRAM0 size)
+    parameter CALL_DEPTH = 4,        // CALL return stack entries (power of two)
     parameter MAX_SEQ_LEN = 16
 )(
     input  logic                      clk,
@@ -33,9 +36,23 @@ module microcode_controller #(
     output logic [15:0]               gemm_dim_k,
     output logic [15:0]               gemm_dim_n,
     output logic                      gemm_transpose_b,
+    output logic                      gemm_int4,        // GEMM_W4: packed INT4 weights
     output logic                      gemm_accumulate,
     output logic                      gemm_requant,
     output logic [15:0]               gemm_imm,
+    output logic [SRAM_ADDR_WIDTH-1:0] gemm_src_a,
+    output logic [SRAM_ADDR_WIDTH-1:0] gemm_src_b,
+    output logic [SRAM_ADDR_WIDTH-1:0] gemm_dst,
+    output logic [3:0]                gemm_out_block,   // log2 scatter block width, 0 = row-major
+    output logic [15:0]               gemm_batch_count, // 1 unless flags[3] (BATCHED)
+    output logic [15:0]               gemm_stride_a,
+    output logic [15:0]               gemm_stride_b,
+    output logic [15:0]               gemm_stride_c,
+    output logic [15:0]               gemm_ldc,         // C row stride, 0 = N
+    output logic [1:0]                gemm_loop_order,  // set by GEMM_ORDER
+    output logic                      gemm_wgt_stream,  // GEMM_STREAM: B from the weight FIFO
+    output logic                      gemm_residual_en, // set by GEMM_RESIDUAL for one GEMM
+    output logic [SRAM_ADDR_WIDTH-1:0] gemm_residual, // residual tensor added to C
     
     // Softmax
     output logic                      softmax_start,
@@ -43,11 +60,18 @@ module microcode_controller #(
     output logic [15:0]               softmax_m,
     output logic [15:0]               softmax_n,
     output logic                      softmax_causal,
+    output logic [15:0]               softmax_window,     // k: sliding window, 0 = none
+    output logic [15:0]               softmax_row_offset, // imm: band tile's query/key offset
     
     // LayerNorm
     output logic                      layernorm_start,
     input  logic                      layernorm_busy,
     output logic [15:0]               layernorm_dim,
+    output logic [15:0]               layernorm_rows,
+    output logic [SRAM_ADDR_WIDTH-1:0] layernorm_src,
+    output logic [SRAM_ADDR_WIDTH-1:0] layernorm_dst,
+    output logic [SRAM_ADDR_WIDTH-1:0] layernorm_param, // gamma; beta follows
+    output logic                      layernorm_reload, // Refetch cached gamma/beta
     
     // GELU
     output logic                      gelu_start,
@@ -66,6 +90,14 @@ module microcode_controller #(
     input  logic                      dma_busy,
     output logic                      dma_direction,
     output logic [31:0]               dma_byte_count,
+    output logic [31:0]               dma_ddr_offset,  // relative to DDR_BASE
+    output logic                      dma_stream,      // DMA_STREAM: DDR -> weight FIFO
+    output logic [SRAM_ADDR_WIDTH-1:0] dma_sram_addr,
+    
+    // Activation LUT load (scoreboarded on the engine that owns the table)
+    output logic                      lut_load_start,
+    output logic                      lut_load_table,  // 0 = GELU, 1 = softmax exp
+    output logic [SRAM_ADDR_WIDTH-1:0] lut_load_addr,
     
     // Barrier sync
     output logic                      barrier_wait,
@@ -104,9 +136,72 @@ module microcode_controller #(
     localparam OPCODE_VEC_ADD   = 8'h08;
     localparam OPCODE_VEC_MUL   = 8'h09;
     localparam OPCODE_VEC_COPY  = 8'h0A;
+    localparam OPCODE_LUT_LOAD  = 8'h0B; // src0 = SRAM0 table, imm[0] = table
+    localparam OPCODE_GEMM_BATCH = 8'h0C; // m = count, src0/src1/dst = A/B/C strides, n = ldc
+    localparam OPCODE_GEMM_W4   = 8'h0D; // GEMM with packed INT4 weights (src1 = [K, N/2] bytes)
+    localparam OPCODE_GEMM_ORDER = 8'h0E; // imm[1:0] = tile loop order (0 mnk, 1 nmk, 2 kmn)
+    localparam OPCODE_DMA_STREAM = 8'h0F; // DDR {src1,src0} -> weight FIFO, {n,m} bytes
+    localparam OPCODE_GEMM_STREAM = 8'h10; // GEMM with B streamed from the weight FIFO
+    localparam OPCODE_GEMM_RESIDUAL = 8'h11; // src0 = residual added to the next GEMM's C
+    localparam OPCODE_SRAM_BASE = 8'h13;  // flags[2:0]: load dst/src0/src1 base from the field
+    localparam OPCODE_CALL      = 8'h14;  // imm = target pc; flags[3:0] load the weight/activation/
+                                          // KV frames from dst/src0/src1 and the DDR frame from {n,m}
+    localparam OPCODE_RET       = 8'h15;  // return to the instruction after the last CALL
     
     localparam OPCODE_BARRIER   = 8'hFE;
     localparam OPCODE_END       = 8'hFF;
+
+    // Compact format (64 bits) for ops whose K and imm are 0. A slot whose
+    // low byte starts 2'b10 (no full opcode does) holds two of them, low
+    // half first. Addresses count 16-byte granules of the 64KB window the
+    // base registers select; the upper flags bits, K and imm expand to 0.
+    typedef struct packed {
+        logic [11:0] n;
+        logic [7:0]  m;
+        logic [11:0] src1;
+        logic [11:0] src0;
+        logic [11:0] dst;
+        logic [1:0]  mark;    // 2'b10
+        logic [1:0]  flags;
+        logic [3:0]  opcode;  // short opcode
+    } compact_t;
+
+    localparam COMPACT_MARK = 2'b10;
+
+    function automatic logic is_compact(input logic [63:0] half);
+        return half[7:6] == COMPACT_MARK;
+    endfunction
+
+    function automatic instruction_t expand(input compact_t c);
+        instruction_t i;
+        case (c.opcode)
+            4'h0: i.opcode = OPCODE_NOP;
+            4'h1: i.opcode = OPCODE_DMA_LOAD;
+            4'h2: i.opcode = OPCODE_DMA_STORE;
+            4'h3: i.opcode = OPCODE_VEC;
+            4'h4: i.opcode = OPCODE_SOFTMAX;
+            4'h5: i.opcode = OPCODE_LAYERNORM;
+            4'h6: i.opcode = OPCODE_GELU;
+            4'h7: i.opcode = OPCODE_VEC_ADD;
+            4'h8: i.opcode = OPCODE_VEC_MUL;
+            4'h9: i.opcode = OPCODE_VEC_COPY;
+            4'hA: i.opcode = OPCODE_GEMM_RESIDUAL;
+            4'hB: i.opcode = OPCODE_GEMM_BATCH;
+            4'hC: i.opcode = OPCODE_SRAM_BASE;
+            4'hD: i.opcode = OPCODE_RET;
+            4'hE: i.opcode = OPCODE_BARRIER;
+            default: i.opcode = OPCODE_END;
+        endcase
+        i.flags = {6'd0, c.flags};
+        i.dst = {c.dst, 4'd0};
+        i.src0 = {c.src0, 4'd0};
+        i.src1 = {c.src1, 4'd0};
+        i.m = {8'd0, c.m};
+        i.n = {4'd0, c.n};
+        i.k = '0;
+        i.imm = '0;
+        return i;
+    endfunction
     
     // Engine IDs
     localparam ENGINE_GEMM      = 3'd0;
@@ -127,18 +222,108 @@ module microcode_controller #(
         DONE_STATE
     } state_t;
     
-    state_t state, next_state;
+    // state, pc, upper_half and scoreboard are public so harnesses can
+    // sample them (e.g. the PC profiler in testbenches/common/pc_profiler.h)
+    state_t state /*verilator public_flat_rd*/;
+    state_t next_state;
     
-    // Program counter
-    logic [15:0] pc;
+    // Program counter (counts 128-bit slots)
+    logic [15:0] pc /*verilator public_flat_rd*/;
     logic [15:0] ucode_end;
     
     // Current instruction
     instruction_t current_instr;
     logic instr_valid;
+
+    // The fetched slot's upper half. After the low half of a compact pair
+    // it is decoded from here, skipping FETCH; DECODE keeps the scoreboard
+    // a cycle to see the low half's engine go busy.
+    compact_t slot_hi;
+    logic slot_pair;
+    logic upper_half /*verilator public_flat_rd*/;
+    logic upper_next;
+    assign upper_next = slot_pair && !upper_half;
     
+    // Strided-batch registers set by GEMM_BATCH. They stay set and apply to
+    // every GEMM with flags[3] until the next GEMM_BATCH; the engine only
+    // sees them at dispatch, so a running GEMM is unaffected.
+    logic [15:0] batch_count_reg;
+    logic [15:0] batch_stride_a_reg, batch_stride_b_reg, batch_stride_c_reg;
+    logic [15:0] batch_ldc_reg;
+
+    // Tile loop order set by GEMM_ORDER; applies to every later GEMM
+    logic [1:0] loop_order_reg;
+
+    // Residual set by GEMM_RESIDUAL. Unlike the registers above it is
+    // consumed by the next GEMM dispatch: each residual add names its own
+    // tensor.
+    logic        residual_pending;
+    logic [SRAM_ADDR_WIDTH-1:0] residual_reg;
+
+    // SRAM0 base registers set by SRAM_BASE, one per address field. The
+    // 16-bit dst/src0/src1 fields address 64KB; an operand's address is
+    // its field with base[13:0] as bits 16 and up, so SRAM0 beyond 64KB
+    // needs no wider ISA fields. base[15:14] selects a CALL frame register
+    // added on top (0 = none). The registers stay set like the GEMM_BATCH
+    // ones and apply at dispatch (to a GEMM_RESIDUAL operand when it is
+    // issued). All zero after reset.
+    logic [15:0] base_dst_reg, base_src0_reg, base_src1_reg;
+
+    // CALL frame: per-call relocation of a shared subroutine body (e.g.
+    // one transformer layer called once per layer). The weight,
+    // activation and KV frames are SRAM0 offsets in 16-byte units; the DDR
+    // frame is a byte offset added to DMA DDR fields whose base register
+    // selects any frame. CALL pushes the return address together with the
+    // caller's frames and base registers, and RET restores all of them, so
+    // a nested CALL leaves its caller's operands where they were. The
+    // return stack wraps: nesting deeper than CALL_DEPTH overwrites the
+    // oldest entry. ret_depth counts the entries still held (saturating at
+    // CALL_DEPTH), and a RET with none left ends the program like END
+    // instead of popping a stale entry.
+    localparam FRAME_NONE = 2'd0, FRAME_WEIGHT = 2'd1, FRAME_ACT = 2'd2, FRAME_KV = 2'd3;
+    logic [15:0] frame_wgt_reg, frame_act_reg, frame_kv_reg;
+    logic [31:0] frame_ddr_reg;
+
+    typedef struct packed {
+        logic [15:0] ret_pc;
+        logic [15:0] frame_wgt, frame_act, frame_kv;
+        logic [31:0] frame_ddr;
+        logic [15:0] base_dst, base_src0, base_src1;
+    } call_entry_t;
+
+    call_entry_t ret_stack [CALL_DEPTH];
+    call_entry_t ret_top;   // entry the next RET pops
+    logic [$clog2(CALL_DEPTH)-1:0] ret_sp;
+    localparam int RET_DEPTH_W = $clog2(CALL_DEPTH + 1);
+    logic [RET_DEPTH_W-1:0] ret_depth;
+    assign ret_top = ret_stack[ret_sp - 1'b1];
+
+    function automatic logic [SRAM_ADDR_WIDTH-1:0] operand_addr(input logic [15:0] base,
+                                                                 input logic [15:0] field);
+        logic [15:0] frame;
+        case (base[15:14])
+            FRAME_WEIGHT: frame = frame_wgt_reg;
+            FRAME_ACT:    frame = frame_act_reg;
+            FRAME_KV:     frame = frame_kv_reg;
+            default:      frame = '0;
+        endcase
+        return SRAM_ADDR_WIDTH'({base[13:0], field} + {frame, 4'b0});
+    endfunction
+
+    function automatic logic [31:0] ddr_addr(input logic [15:0] base, input logic [31:0] offset);
+        return offset + ((base[15:14] != FRAME_NONE) ? frame_ddr_reg : 32'd0);
+    endfunction
+
+    // Step past the current instruction: to the slot's upper half when
+    // the low half of a compact pair is done, else to the next slot
+    task automatic next_instr();
+        if (upper_next) upper_half <= 1'b1;
+        else pc <= pc + 1;
+        instr_valid <= 1'b0;
+    endtask
+
     // Scoreboard
-    logic [NUM_ENGINES-1:0] scoreboard;
+    logic [NUM_ENGINES-1:0] scoreboard /*verilator public_flat_rd*/;
     logic [NUM_ENGINES-1:0] scoreboard_set;
     logic [NUM_ENGINES-1:0] scoreboard_clear;
     
@@ -149,14 +334,18 @@ module microcode_controller #(
     logic [2:0] target_engine;
     always_comb begin
         case (current_instr.opcode)
-            OPCODE_GEMM:      target_engine = ENGINE_GEMM;
+            OPCODE_GEMM,
+            OPCODE_GEMM_W4,
+            OPCODE_GEMM_STREAM: target_engine = ENGINE_GEMM;
             OPCODE_SOFTMAX:   target_engine = ENGINE_SOFTMAX;
             OPCODE_LAYERNORM: target_engine = ENGINE_LAYERNORM;
             OPCODE_GELU:      target_engine = ENGINE_GELU;
             OPCODE_VEC, OPCODE_VEC_ADD, OPCODE_VEC_MUL, OPCODE_VEC_COPY: 
                               target_engine = ENGINE_VEC;
             OPCODE_DMA_LOAD,
-            OPCODE_DMA_STORE: target_engine = ENGINE_DMA;
+            OPCODE_DMA_STORE,
+            OPCODE_DMA_STREAM: target_engine = ENGINE_DMA;
+            OPCODE_LUT_LOAD:  target_engine = current_instr.imm[0] ? ENGINE_SOFTMAX : ENGINE_GELU;
             default:          target_engine = 3'd7;
         endcase
     end
@@ -177,6 +366,9 @@ module microcode_controller #(
             ucode_end <= '0;
             current_instr <= '0;
             instr_valid <= 1'b0;
+            slot_hi <= '0;
+            slot_pair <= 1'b0;
+            upper_half <= 1'b0;
             scoreboard_set <= '0;
             gemm_start <= 1'b0;
             softmax_start <= 1'b0;
@@ -184,16 +376,34 @@ module microcode_controller #(
             gelu_start <= 1'b0;
             vec_start <= 1'b0;
             dma_start <= 1'b0;
+            lut_load_start <= 1'b0;
             barrier_wait <= 1'b0;
             
             // Output registers reset
             gemm_dim_m <= '0; gemm_dim_k <= '0; gemm_dim_n <= '0;
-            gemm_transpose_b <= '0; gemm_accumulate <= '0; gemm_requant <= '0; gemm_imm <= '0;
+            gemm_transpose_b <= '0; gemm_int4 <= '0; gemm_accumulate <= '0; gemm_requant <= '0; gemm_imm <= '0;
+            gemm_src_a <= '0; gemm_src_b <= '0; gemm_dst <= '0; gemm_out_block <= '0;
+            gemm_batch_count <= '0; gemm_stride_a <= '0; gemm_stride_b <= '0;
+            gemm_stride_c <= '0; gemm_ldc <= '0; gemm_loop_order <= '0; gemm_wgt_stream <= '0;
+            gemm_residual_en <= '0; gemm_residual <= '0;
+            batch_count_reg <= '0; batch_stride_a_reg <= '0; batch_stride_b_reg <= '0;
+            batch_stride_c_reg <= '0; batch_ldc_reg <= '0;
+            loop_order_reg <= '0;
+            residual_pending <= '0; residual_reg <= '0;
+            base_dst_reg <= '0; base_src0_reg <= '0; base_src1_reg <= '0;
+            frame_wgt_reg <= '0; frame_act_reg <= '0; frame_kv_reg <= '0; frame_ddr_reg <= '0;
+            ret_sp <= '0;
+            ret_depth <= '0;
             softmax_m <= '0; softmax_n <= '0; softmax_causal <= '0;
-            layernorm_dim <= '0;
+            softmax_window <= '0; softmax_row_offset <= '0;
+            layernorm_dim <= '0; layernorm_rows <= '0;
+            layernorm_src <= '0; layernorm_dst <= '0; layernorm_param <= '0;
+            layernorm_reload <= '0;
             gelu_count <= '0;
             vec_op <= '0; vec_count <= '0; vec_imm <= '0;
             dma_direction <= '0; dma_byte_count <= '0;
+            dma_ddr_offset <= '0; dma_sram_addr <= '0; dma_stream <= '0;
+            lut_load_table <= '0; lut_load_addr <= '0;
         end else begin
             // Default: no starts
             gemm_start <= 1'b0;
@@ -202,6 +412,7 @@ module microcode_controller #(
             gelu_start <= 1'b0;
             vec_start <= 1'b0;
             dma_start <= 1'b0;
+            lut_load_start <= 1'b0;
             scoreboard_set <= '0;
             barrier_wait <= 1'b0;
             
@@ -211,17 +422,32 @@ module microcode_controller #(
                 IDLE: begin
                     pc <= '0;
                     instr_valid <= 1'b0;
-                    if (start) ucode_end <= ucode_length;
+                    if (start) begin
+                        ucode_end <= ucode_length;
+                        ret_sp <= '0;
+                        ret_depth <= '0;
+                    end
                 end
                 
                 FETCH: begin
-                    sram_rd_addr <= ucode_base_addr + pc;
+                    // 16 bytes per instruction
+                    sram_rd_addr <= ucode_base_addr + (pc << 4);
                     sram_rd_en <= 1'b1;
+                    upper_half <= 1'b0;
                 end
                 
                 DECODE: begin
                     sram_rd_en <= 1'b0;
-                    current_instr <= instruction_t'(sram_rd_data);
+                    if (upper_half) begin
+                        current_instr <= expand(slot_hi);
+                    end else if (is_compact(sram_rd_data[63:0])) begin
+                        current_instr <= expand(compact_t'(sram_rd_data[63:0]));
+                        slot_hi <= compact_t'(sram_rd_data[127:64]);
+                        slot_pair <= 1'b1;
+                    end else begin
+                        current_instr <= instruction_t'(sram_rd_data);
+                        slot_pair <= 1'b0;
+                    end
                     instr_valid <= 1'b1;
                 end
                 
@@ -229,22 +455,111 @@ module microcode_controller #(
                     if (instr_valid) begin
                         case (current_instr.opcode)
                             OPCODE_NOP: begin
-                                pc <= pc + 1;
-                                instr_valid <= 1'b0;
+                                next_instr();
                             end
                             
-                            OPCODE_GEMM: begin
+                            OPCODE_GEMM, OPCODE_GEMM_W4, OPCODE_GEMM_STREAM: begin
                                 if (!scoreboard[ENGINE_GEMM]) begin
                                     gemm_start <= 1'b1;
                                     gemm_dim_m <= current_instr.m;
                                     gemm_dim_k <= current_instr.k;
                                     gemm_dim_n <= current_instr.n;
-                                    gemm_transpose_b <= current_instr.flags[0];
+                                    gemm_int4 <= (current_instr.opcode == OPCODE_GEMM_W4);
+                                    gemm_wgt_stream <= (current_instr.opcode == OPCODE_GEMM_STREAM);
+                                    // Packed INT4 and streamed weights are only read untransposed
+                                    gemm_transpose_b <= current_instr.flags[0] &&
+                                                        current_instr.opcode == OPCODE_GEMM;
                                     gemm_requant <= current_instr.flags[1];
                                     gemm_accumulate <= current_instr.flags[2];
                                     gemm_imm <= current_instr.imm;
+                                    gemm_src_a <= operand_addr(base_src0_reg, current_instr.src0);
+                                    gemm_src_b <= operand_addr(base_src1_reg, current_instr.src1);
+                                    gemm_dst <= operand_addr(base_dst_reg, current_instr.dst);
+                                    gemm_out_block <= current_instr.flags[7:4];
+                                    gemm_loop_order <= loop_order_reg;
+                                    gemm_residual_en <= residual_pending;
+                                    gemm_residual <= residual_reg;
+                                    residual_pending <= 1'b0;
+                                    if (current_instr.flags[3] && current_instr.opcode != OPCODE_GEMM_STREAM) begin
+                                        gemm_batch_count <= batch_count_reg;
+                                        gemm_stride_a <= batch_stride_a_reg;
+                                        gemm_stride_b <= batch_stride_b_reg;
+                                        gemm_stride_c <= batch_stride_c_reg;
+                                        gemm_ldc <= batch_ldc_reg;
+                                    end else begin
+                                        gemm_batch_count <= 16'd1;
+                                        gemm_stride_a <= '0;
+                                        gemm_stride_b <= '0;
+                                        gemm_stride_c <= '0;
+                                        gemm_ldc <= '0;
+                                    end
                                     scoreboard_set[ENGINE_GEMM] <= 1'b1;
-                                    pc <= pc + 1;
+                                    next_instr();
+                                end
+                            end
+
+                            OPCODE_GEMM_BATCH: begin
+                                // Controller-local: no engine slot to wait for
+                                batch_count_reg <= current_instr.m;
+                                batch_stride_a_reg <= current_instr.src0;
+                                batch_stride_b_reg <= current_instr.src1;
+                                batch_stride_c_reg <= current_instr.dst;
+                                batch_ldc_reg <= current_instr.n;
+                                next_instr();
+                            end
+
+                            OPCODE_GEMM_ORDER: begin
+                                loop_order_reg <= current_instr.imm[1:0];
+                                next_instr();
+                            end
+
+                            OPCODE_GEMM_RESIDUAL: begin
+                                residual_pending <= 1'b1;
+                                residual_reg <= operand_addr(base_src0_reg, current_instr.src0);
+                                next_instr();
+                            end
+
+                            OPCODE_SRAM_BASE: begin
+                                if (current_instr.flags[0]) base_dst_reg <= current_instr.dst;
+                                if (current_instr.flags[1]) base_src0_reg <= current_instr.src0;
+                                if (current_instr.flags[2]) base_src1_reg <= current_instr.src1;
+                                next_instr();
+                            end
+
+                            OPCODE_CALL: begin
+                                // Controller-local like GEMM_BATCH: running
+                                // engines keep the addresses they started with
+                                if (current_instr.flags[0]) frame_wgt_reg <= current_instr.dst;
+                                if (current_instr.flags[1]) frame_act_reg <= current_instr.src0;
+                                if (current_instr.flags[2]) frame_kv_reg <= current_instr.src1;
+                                if (current_instr.flags[3]) frame_ddr_reg <= {current_instr.n, current_instr.m};
+                                ret_stack[ret_sp].ret_pc <= pc + 1;
+                                ret_stack[ret_sp].frame_wgt <= frame_wgt_reg;
+                                ret_stack[ret_sp].frame_act <= frame_act_reg;
+                                ret_stack[ret_sp].frame_kv <= frame_kv_reg;
+                                ret_stack[ret_sp].frame_ddr <= frame_ddr_reg;
+                                ret_stack[ret_sp].base_dst <= base_dst_reg;
+                                ret_stack[ret_sp].base_src0 <= base_src0_reg;
+                                ret_stack[ret_sp].base_src1 <= base_src1_reg;
+                                ret_sp <= ret_sp + 1'b1;
+                                if (ret_depth != RET_DEPTH_W'(CALL_DEPTH)) ret_depth <= ret_depth + 1'b1;
+                                pc <= current_instr.imm;
+                                instr_valid <= 1'b0;
+                            end
+
+                            OPCODE_RET: begin
+                                // With an empty stack: program complete
+                                if (ret_depth != '0) begin
+                                    pc <= ret_top.ret_pc;
+                                    frame_wgt_reg <= ret_top.frame_wgt;
+                                    frame_act_reg <= ret_top.frame_act;
+                                    frame_kv_reg <= ret_top.frame_kv;
+                                    frame_ddr_reg <= ret_top.frame_ddr;
+                                    base_dst_reg <= ret_top.base_dst;
+                                    base_src0_reg <= ret_top.base_src0;
+                                    base_src1_reg <= ret_top.base_src1;
+                                    ret_sp <= ret_sp - 1'b1;
+                                    ret_depth <= ret_depth - 1'b1;
                                     instr_valid <= 1'b0;
                                 end
                             end
@@ -255,19 +570,24 @@ module microcode_controller #(
                                     softmax_m <= current_instr.m;
                                     softmax_n <= current_instr.n;
                                     softmax_causal <= current_instr.flags[0];
+                                    softmax_window <= current_instr.k;
+                                    softmax_row_offset <= current_instr.imm;
                                     scoreboard_set[ENGINE_SOFTMAX] <= 1'b1;
-                                    pc <= pc + 1;
-                                    instr_valid <= 1'b0;
+                                    next_instr();
                                 end
                             end
                             
                             OPCODE_LAYERNORM: begin
                                 if (!scoreboard[ENGINE_LAYERNORM]) begin
                                     layernorm_start <= 1'b1;
-                                    layernorm_dim <= current_instr.n; // Assuming N is hidden dim
+                                    layernorm_dim <= current_instr.n;
+                                    layernorm_rows <= current_instr.m;
+                                    layernorm_src <= operand_addr(base_src0_reg, current_instr.src0);
+                                    layernorm_dst <= operand_addr(base_dst_reg, current_instr.dst);
+                                    layernorm_param <= operand_addr(base_src1_reg, current_instr.src1);
+                                    layernorm_reload <= current_instr.flags[0];
                                     scoreboard_set[ENGINE_LAYERNORM] <= 1'b1;
-                                    pc <= pc + 1;
-                                    instr_valid <= 1'b0;
+                                    next_instr();
                                 end
                             end
                             
@@ -276,8 +596,7 @@ module microcode_controller #(
                                     gelu_start <= 1'b1;
                                     gelu_count <= current_instr.n; // Assuming N is count
                                     scoreboard_set[ENGINE_GELU] <= 1'b1;
-                                    pc <= pc + 1;
-                                    instr_valid <= 1'b0;
+                                    next_instr();
                                 end
                             end
                             
@@ -294,8 +613,7 @@ module microcode_controller #(
                                         default: vec_op <= 3'b000;
                                     endcase
                                     scoreboard_set[ENGINE_VEC] <= 1'b1;
-                                    pc <= pc + 1;
-                                    instr_valid <= 1'b0;
+                                    next_instr();
                                 end
                             end
                             
@@ -306,9 +624,11 @@ module microcode_controller #(
                                     dma_byte_count <= {current_instr.m, current_instr.n}; // Hack: use M:N for 32-bit count? 
                                     // Or M is bytes? Spec says M=bytes.
                                     dma_byte_count <= {16'd0, current_instr.m};
+                                    dma_sram_addr <= operand_addr(base_dst_reg, current_instr.dst);
+                                    dma_ddr_offset <= ddr_addr(base_src0_reg, {16'd0, current_instr.src0});
+                                    dma_stream <= 1'b0;
                                     scoreboard_set[ENGINE_DMA] <= 1'b1;
-                                    pc <= pc + 1;
-                                    instr_valid <= 1'b0;
+                                    next_instr();
                                 end
                             end
                             
@@ -317,9 +637,36 @@ module microcode_controller #(
                                     dma_start <= 1'b1;
                                     dma_direction <= 1'b1; // SRAM -> DDR
                                     dma_byte_count <= {16'd0, current_instr.m};
+                                    dma_sram_addr <= operand_addr(base_src0_reg, current_instr.src0);
+                                    dma_ddr_offset <= ddr_addr(base_dst_reg, {16'd0, current_instr.dst});
+                                    dma_stream <= 1'b0;
                                     scoreboard_set[ENGINE_DMA] <= 1'b1;
-                                    pc <= pc + 1;
-                                    instr_valid <= 1'b0;
+                                    next_instr();
+                                end
+                            end
+                            
+                            OPCODE_DMA_STREAM: begin
+                                // Weights for a following GEMM_STREAM: 32-bit
+                                // DDR offset and byte count, no SRAM side
+                                if (!scoreboard[ENGINE_DMA]) begin
+                                    dma_start <= 1'b1;
+                                    dma_direction <= 1'b0;
+                                    dma_byte_count <= {current_instr.n, current_instr.m};
+                                    dma_sram_addr <= '0;
+                                    dma_ddr_offset <= ddr_addr(base_src0_reg, {current_instr.src1, current_instr.src0});
+                                    dma_stream <= 1'b1;
+                                    scoreboard_set[ENGINE_DMA] <= 1'b1;
+                                    next_instr();
+                                end
+                            end
+                            
+                            OPCODE_LUT_LOAD: begin
+                                if (!scoreboard[target_engine]) begin
+                                    lut_load_start <= 1'b1;
+                                    lut_load_table <= current_instr.imm[0];
+                                    lut_load_addr <= operand_addr(base_src0_reg, current_instr.src0);
+                                    scoreboard_set[target_engine] <= 1'b1;
+                                    next_instr();
                                 end
                             end
                             
@@ -332,8 +679,7 @@ module microcode_controller #(
                             end
 
                             default: begin
-                                pc <= pc + 1;
-                                instr_valid <= 1'b0;
+                                next_instr();
                             end
                         endcase
                     end
@@ -342,8 +688,7 @@ module microcode_controller #(
                 WAIT_BARRIER: begin
                     barrier_wait <= 1'b1;
                     if (all_engines_idle) begin
-                        pc <= pc + 1;
-                        instr_valid <= 1'b0;
+                        next_instr();
                     end
                 end
                 
@@ -371,13 +716,15 @@ module microcode_controller #(
                     case (current_instr.opcode)
                         OPCODE_END: next_state = DONE_STATE;
                         OPCODE_BARRIER: next_state = WAIT_BARRIER;
+                        OPCODE_CALL: next_state = FETCH;
+                        OPCODE_RET: next_state = (ret_depth != '0) ? FETCH : DONE_STATE;
                         default: begin
-                            if (!scoreboard[target_engine]) next_state = FETCH;
+                            if (!scoreboard[target_engine]) next_state = upper_next ? DECODE : FETCH;
                         end
                     endcase
                 end
             end
-            WAIT_BARRIER: if (all_engines_idle) next_state = FETCH;
+            WAIT_BARRIER: if (all_engines_idle) next_state = upper_next ? DECODE : FETCH;
             DONE_STATE: next_state = IDLE;
             default: next_state = IDLE;
         endcase
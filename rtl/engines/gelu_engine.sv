@@ -2,6 +2,7 @@
 // Lookup-table based GELU approximation
 // GELU(x) = x * Φ(x) where Φ(x) is the standard normal CDF
 // Approximated as: 0.5 * x * (1 + tanh(√(2/π) * (x + 0.044715 * x³)))
+// The table can be reprogrammed at runtime (LUT_LOAD) for other activations
 
 `timescale 1ns/1ps
 
@@ -20,6 +21,11 @@ module gelu_engine #(
     // Configuration
     input  logic [$clog2(MAX_ELEMENTS)-1:0] num_elements,
     
+    // LUT programming (one entry per cycle, e.g. from lut_loader)
+    input  logic                      lut_wr_en,
+    input  logic [7:0]                lut_wr_addr,
+    input  logic [DATA_WIDTH-1:0]     lut_wr_data,
+    
     // Data input (streaming)
     input  logic [DATA_WIDTH-1:0]     data_in,
     input  logic                      data_valid,
@@ -31,10 +37,10 @@ module gelu_engine #(
 
     // GELU lookup table
     // Maps INT8 input to INT8 output
-    // Precomputed using the tanh approximation
-    logic [DATA_WIDTH-1:0] gelu_lut [0:255];
+    // Precomputed using the tanh approximation; overwritten by lut_wr_*
+    logic [DATA_WIDTH-1:0] gelu_lut [0:255] /*verilator public_flat_rd*/;
     
-    // Initialize LUT
+    // Initialize LUT (reset default)
     initial begin
         // Local variables for computation
         int signed_val;
@@ -77,6 +83,13 @@ module gelu_engine #(
         end
     end
     
+    // Runtime reload
+    always_ff @(posedge clk) begin
+        if (lut_wr_en) begin
+            gelu_lut[lut_wr_addr] <= lut_wr_data;
+        end
+    end
+    
     // State machine
     typedef enum logic [1:0] {
         IDLE,
@@ -2,6 +2,20 @@
 // Two-pass algorithm:
 // Pass 1: Compute mean and variance across hidden dimension
 // Pass 2: Normalize, scale by gamma, add beta
+//
+// STREAM = 0 buffers the row (and gamma/beta) in registers, so hidden_dim is
+// bounded by MAX_HIDDEN_DIM. STREAM = 1 reads x and gamma/beta from SRAM
+// and writes y back instead: pass 1 streams x for the statistics, pass 2
+// re-reads x with gamma/beta and writes y. Only counters grow with the
+// hidden size, which becomes a runtime parameter (MAX_HIDDEN_DIM = 65536
+// gives a 16-bit hidden_dim). LANES (STREAM = 1 only) sets the SRAM word
+// width in elements: each cycle of either pass handles a whole word.
+//
+// PARAM_SLOTS > 0 (STREAM = 1) adds a gamma/beta cache of that many slots,
+// tagged by (param_addr, hidden_dim). The first row of a parameter set
+// fills a slot from port B; later rows and later invocations with the same
+// tag skip the gamma/beta reads. Rows longer than PARAM_DIM bypass the
+// cache. param_reload forces a refill after gamma/beta change in SRAM.
 
 `timescale 1ns/1ps
 
@@ -9,7 +23,12 @@ module layernorm_engine #(
     parameter DATA_WIDTH = 8,
     parameter ACC_WIDTH = 32,
     parameter MAX_HIDDEN_DIM = 64,
-    parameter EPS = 32'h00001000  // Small epsilon value (fixed-point)
+    parameter EPS = 32'h00001000, // Small epsilon value (fixed-point)
+    parameter STREAM = 0,         // 1 = SRAM-streaming rows, no row buffers
+    parameter LANES = 1,          // Elements per SRAM word (STREAM = 1)
+    parameter PARAM_SLOTS = 0,    // Cached gamma/beta sets (STREAM = 1)
+    parameter PARAM_DIM = 256,    // Longest row a cache slot holds
+    parameter SRAM_ADDR_WIDTH = 16
 )(
     input  logic                      clk,
     input  logic                      rst_n,
@@ -31,46 +50,31 @@ module layernorm_engine #(
     input  logic [DATA_WIDTH-1:0]     beta_in,       // Shift
     input  logic                      param_valid,
     
-    // Data output
+    // Data output (STREAM = 1: mirrors lane 0 of each y word written)
     output logic [DATA_WIDTH-1:0]     data_out,
-    output logic                      out_valid
-);
-
-    // States
-    typedef enum logic [2:0] {
-        IDLE,
-        PASS1_MEAN_VAR,   // Accumulate sum and sum of squares
-        COMPUTE_STATS,    // Calculate mean and variance
-        PASS2_NORM,       // Normalize and apply gamma/beta
-        DONE_STATE
-    } state_t;
+    output logic                      out_valid,
     
-    state_t state, next_state;
+    // SRAM streaming (STREAM = 1): num_rows rows of hidden_dim bytes at
+    // x_addr / y_addr; gamma at param_addr, beta at param_addr + hidden_dim
+    input  logic [15:0]               num_rows,
+    input  logic [SRAM_ADDR_WIDTH-1:0] x_addr,
+    input  logic [SRAM_ADDR_WIDTH-1:0] y_addr,
+    input  logic [SRAM_ADDR_WIDTH-1:0] param_addr,
+    input  logic                      param_reload,    // Refetch a cached set
+    output logic [SRAM_ADDR_WIDTH-1:0] sram_rd_addr,   // x (SRAM0 port A)
+    output logic                      sram_rd_en,
+    input  logic                      sram_rd_gnt,
+    input  logic [LANES*DATA_WIDTH-1:0] sram_rd_data,
+    output logic [SRAM_ADDR_WIDTH-1:0] sram_wr_addr,   // y (SRAM0 port A)
+    output logic [LANES*DATA_WIDTH-1:0] sram_wr_data,
+    output logic [LANES-1:0]          sram_wr_mask,    // Lanes inside the row
+    output logic                      sram_wr_en,
+    input  logic                      sram_wr_gnt,
+    output logic [SRAM_ADDR_WIDTH-1:0] param_rd_addr,  // gamma/beta (SRAM0 port B)
+    output logic                      param_rd_en,
+    input  logic [LANES*DATA_WIDTH-1:0] param_rd_data
+);
 
-    logic [ACC_WIDTH-1:0] hidden_dim_ext;
-    assign hidden_dim_ext = ACC_WIDTH'(hidden_dim);
-    
-    // Accumulators for pass 1
-    logic signed [ACC_WIDTH-1:0] sum_acc;
-    logic signed [ACC_WIDTH-1:0] sum_sq_acc;
-    logic [$clog2(MAX_HIDDEN_DIM)-1:0] element_count;
-    
-    // Computed statistics (pass 1 → pass 2)
-    logic signed [ACC_WIDTH-1:0] mean;
-    logic signed [ACC_WIDTH-1:0] variance;
-    logic signed [ACC_WIDTH-1:0] inv_sqrt_var;  // 1/sqrt(var + eps)
-    
-    // Input buffer (store for pass 2)
-    logic [DATA_WIDTH-1:0] input_buffer [0:MAX_HIDDEN_DIM-1];
-    
-    // Gamma/beta buffer
-    logic [DATA_WIDTH-1:0] gamma_buffer [0:MAX_HIDDEN_DIM-1];
-    logic [DATA_WIDTH-1:0] beta_buffer [0:MAX_HIDDEN_DIM-1];
-    
-    // Current processing index
-    logic [$clog2(MAX_HIDDEN_DIM)-1:0] current_idx;
-    logic [$clog2(MAX_HIDDEN_DIM)-1:0] param_count;
-    
     // Inverse square root LUT
     // Maps variance value to 1/sqrt(var + eps)
     // Using Q16.16 fixed point for precision
@@ -86,178 +90,522 @@ module layernorm_engine #(
         end
     end
     
-    // Sequential logic
-    always_ff @(posedge clk or negedge rst_n) begin
-        if (!rst_n) begin
-            state <= IDLE;
-            sum_acc <= '0;
-            sum_sq_acc <= '0;
-            element_count <= '0;
-            current_idx <= '0;
-            param_count <= '0;
-        end else begin
-            state <= next_state;
+    generate
+    if (!STREAM) begin : g_buffered
+        // States
+        typedef enum logic [2:0] {
+            IDLE,
+            PASS1_MEAN_VAR,   // Accumulate sum and sum of squares
+            COMPUTE_STATS,    // Calculate mean and variance
+            PASS2_NORM,       // Normalize and apply gamma/beta
+            DONE_STATE
+        } state_t;
+    
+        state_t state, next_state;
+
+        logic [ACC_WIDTH-1:0] hidden_dim_ext;
+        assign hidden_dim_ext = ACC_WIDTH'(hidden_dim);
+    
+        // Accumulators for pass 1
+        logic signed [ACC_WIDTH-1:0] sum_acc;
+        logic signed [ACC_WIDTH-1:0] sum_sq_acc;
+        logic [$clog2(MAX_HIDDEN_DIM)-1:0] element_count;
+    
+        // Computed statistics (pass 1 → pass 2)
+        logic signed [ACC_WIDTH-1:0] mean;
+        logic signed [ACC_WIDTH-1:0] variance;
+        logic signed [ACC_WIDTH-1:0] inv_sqrt_var;  // 1/sqrt(var + eps)
+    
+        // Input buffer (store for pass 2)
+        logic [DATA_WIDTH-1:0] input_buffer [0:MAX_HIDDEN_DIM-1];
+    
+        // Gamma/beta buffer
+        logic [DATA_WIDTH-1:0] gamma_buffer [0:MAX_HIDDEN_DIM-1];
+        logic [DATA_WIDTH-1:0] beta_buffer [0:MAX_HIDDEN_DIM-1];
+    
+        // Current processing index
+        logic [$clog2(MAX_HIDDEN_DIM)-1:0] current_idx;
+        logic [$clog2(MAX_HIDDEN_DIM)-1:0] param_count;
+    
+        // Sequential logic
+        always_ff @(posedge clk or negedge rst_n) begin
+            if (!rst_n) begin
+                state <= IDLE;
+                sum_acc <= '0;
+                sum_sq_acc <= '0;
+                element_count <= '0;
+                current_idx <= '0;
+                param_count <= '0;
+            end else begin
+                state <= next_state;
             
-            case (state)
-                IDLE: begin
-                    sum_acc <= '0;
-                    sum_sq_acc <= '0;
-                    element_count <= '0;
-                    current_idx <= '0;
+                case (state)
+                    IDLE: begin
+                        sum_acc <= '0;
+                        sum_sq_acc <= '0;
+                        element_count <= '0;
+                        current_idx <= '0;
                     
-                    if (start) begin
-                        // Nothing to initialize yet
+                        if (start) begin
+                            // Nothing to initialize yet
+                        end
                     end
-                end
                 
-                PASS1_MEAN_VAR: begin
-                    if (data_valid) begin
-                        // Store input
-                        input_buffer[element_count] <= data_in;
+                    PASS1_MEAN_VAR: begin
+                        if (data_valid) begin
+                            // Store input
+                            input_buffer[element_count] <= data_in;
                         
-                        // Accumulate sum
-                        sum_acc <= sum_acc + ACC_WIDTH'($signed(data_in));
+                            // Accumulate sum
+                            sum_acc <= sum_acc + ACC_WIDTH'($signed(data_in));
                         
-                        // Accumulate sum of squares
-                        sum_sq_acc <= sum_sq_acc + (ACC_WIDTH'($signed(data_in)) * ACC_WIDTH'($signed(data_in)));
+                            // Accumulate sum of squares
+                            sum_sq_acc <= sum_sq_acc + (ACC_WIDTH'($signed(data_in)) * ACC_WIDTH'($signed(data_in)));
                         
-                        element_count <= element_count + 1;
+                            element_count <= element_count + 1;
+                        end
                     end
-                end
                 
-                COMPUTE_STATS: begin
-                    // Compute mean = sum / N
-                    mean <= sum_acc / hidden_dim_ext;
+                    COMPUTE_STATS: begin
+                        // Compute mean = sum / N
+                        mean <= sum_acc / hidden_dim_ext;
                     
-                    // Compute variance = E[x^2] - (E[x])^2
-                    // var = sum_sq / N - mean^2
-                    variance <= (sum_sq_acc / hidden_dim_ext) - 
-                                ((sum_acc / hidden_dim_ext) * (sum_acc / hidden_dim_ext));
+                        // Compute variance = E[x^2] - (E[x])^2
+                        // var = sum_sq / N - mean^2
+                        variance <= (sum_sq_acc / hidden_dim_ext) - 
+                                    ((sum_acc / hidden_dim_ext) * (sum_acc / hidden_dim_ext));
                     
-                    // Lookup 1/sqrt(var + eps)
-                    // Clamp variance to LUT range
-                    if (variance > 0 && variance < 1024) begin
-                        inv_sqrt_var <= rsqrt_lut[variance[9:0]];
-                    end else if (variance >= 1024) begin
-                        inv_sqrt_var <= rsqrt_lut[1023];  // Clamp
-                    end else begin
-                        inv_sqrt_var <= rsqrt_lut[0];  // Minimum variance
-                    end
+                        // Lookup 1/sqrt(var + eps)
+                        // Clamp variance to LUT range
+                        if (variance > 0 && variance < 1024) begin
+                            inv_sqrt_var <= rsqrt_lut[variance[9:0]];
+                        end else if (variance >= 1024) begin
+                            inv_sqrt_var <= rsqrt_lut[1023];  // Clamp
+                        end else begin
+                            inv_sqrt_var <= rsqrt_lut[0];  // Minimum variance
+                        end
                     
-                    current_idx <= '0;
-                end
+                        current_idx <= '0;
+                    end
                 
-                PASS2_NORM: begin
-                    if (current_idx < hidden_dim) begin
-                        // x_norm = (x - mean) * inv_sqrt_var
-                        logic signed [DATA_WIDTH-1:0] x;
-                        logic signed [ACC_WIDTH-1:0] x_minus_mean;
-                        logic signed [ACC_WIDTH-1:0] x_norm;
-                        logic signed [ACC_WIDTH-1:0] scaled;
-                        logic signed [ACC_WIDTH-1:0] shifted;
+                    PASS2_NORM: begin
+                        if (current_idx < hidden_dim) begin
+                            // x_norm = (x - mean) * inv_sqrt_var
+                            logic signed [DATA_WIDTH-1:0] x;
+                            logic signed [ACC_WIDTH-1:0] x_minus_mean;
+                            logic signed [ACC_WIDTH-1:0] x_norm;
+                            logic signed [ACC_WIDTH-1:0] scaled;
+                            logic signed [ACC_WIDTH-1:0] shifted;
                         
-                        x = $signed(input_buffer[current_idx]);
-                        x_minus_mean = ACC_WIDTH'($signed(x)) - mean;
+                            x = $signed(input_buffer[current_idx]);
+                            x_minus_mean = ACC_WIDTH'($signed(x)) - mean;
                         
-                        // Multiply by inv_sqrt_var (Q16.16 format)
-                        // Result needs to be shifted right by 16
-                        x_norm = (x_minus_mean * inv_sqrt_var) >>> 16;
+                            // Multiply by inv_sqrt_var (Q16.16 format)
+                            // Result needs to be shifted right by 16
+                            x_norm = (x_minus_mean * inv_sqrt_var) >>> 16;
                         
-                        // Apply gamma (scale)
-                        scaled = (x_norm * $signed(gamma_buffer[current_idx])) >>> 7;
+                            // Apply gamma (scale)
+                            scaled = (x_norm * $signed(gamma_buffer[current_idx])) >>> 7;
                         
-                        // Apply beta (shift)
-                        shifted = scaled + ACC_WIDTH'($signed(beta_buffer[current_idx]));
+                            // Apply beta (shift)
+                            shifted = scaled + ACC_WIDTH'($signed(beta_buffer[current_idx]));
                         
-                        // Clamp to INT8 range
-                        if (shifted > 127) begin
-                            input_buffer[current_idx] <= 8'd127;
-                        end else if (shifted < -128) begin
-                            input_buffer[current_idx] <= 8'h80;  // -128
-                        end else begin
-                            input_buffer[current_idx] <= shifted[7:0];
-                        end
+                            // Clamp to INT8 range
+                            if (shifted > 127) begin
+                                input_buffer[current_idx] <= 8'd127;
+                            end else if (shifted < -128) begin
+                                input_buffer[current_idx] <= 8'h80;  // -128
+                            end else begin
+                                input_buffer[current_idx] <= shifted[7:0];
+                            end
                         
-                        current_idx <= current_idx + 1;
+                            current_idx <= current_idx + 1;
+                        end
                     end
-                end
 
-                default: begin
-                    // no-op
-                end
-            endcase
+                    default: begin
+                        // no-op
+                    end
+                endcase
+            end
         end
-    end
     
-    // Capture gamma/beta parameters
-    always_ff @(posedge clk or negedge rst_n) begin
-        if (!rst_n) begin
-            param_count <= '0;
-        end else if (state == IDLE) begin
-            if (param_valid) begin
-                gamma_buffer[param_count] <= gamma_in;
-                beta_buffer[param_count] <= beta_in;
-                param_count <= param_count + 1;
+        // Capture gamma/beta parameters
+        always_ff @(posedge clk or negedge rst_n) begin
+            if (!rst_n) begin
+                param_count <= '0;
+            end else if (state == IDLE) begin
+                if (param_valid) begin
+                    gamma_buffer[param_count] <= gamma_in;
+                    beta_buffer[param_count] <= beta_in;
+                    param_count <= param_count + 1;
+                end
+            end else begin
+                param_count <= '0;
             end
-        end else begin
-            param_count <= '0;
         end
-    end
     
-    // Next state logic
-    always_comb begin
-        next_state = state;
+        // Next state logic
+        always_comb begin
+            next_state = state;
         
-        case (state)
-            IDLE: begin
-                if (start) next_state = PASS1_MEAN_VAR;
-            end
+            case (state)
+                IDLE: begin
+                    if (start) next_state = PASS1_MEAN_VAR;
+                end
             
-            PASS1_MEAN_VAR: begin
-                if (element_count >= hidden_dim) next_state = COMPUTE_STATS;
-            end
+                PASS1_MEAN_VAR: begin
+                    if (element_count >= hidden_dim) next_state = COMPUTE_STATS;
+                end
             
-            COMPUTE_STATS: begin
-                next_state = PASS2_NORM;
-            end
+                COMPUTE_STATS: begin
+                    next_state = PASS2_NORM;
+                end
             
-            PASS2_NORM: begin
-                if (current_idx >= hidden_dim) next_state = DONE_STATE;
-            end
+                PASS2_NORM: begin
+                    if (current_idx >= hidden_dim) next_state = DONE_STATE;
+                end
             
-            DONE_STATE: begin
-                next_state = IDLE;
-            end
+                DONE_STATE: begin
+                    next_state = IDLE;
+                end
 
-            default: begin
-                next_state = IDLE;
-            end
-        endcase
-    end
+                default: begin
+                    next_state = IDLE;
+                end
+            endcase
+        end
     
-    // Output
-    logic [$clog2(MAX_HIDDEN_DIM)-1:0] out_idx;
+        // Output
+        logic [$clog2(MAX_HIDDEN_DIM)-1:0] out_idx;
     
-    always_ff @(posedge clk or negedge rst_n) begin
-        if (!rst_n) begin
-            out_idx <= '0;
-            out_valid <= 1'b0;
-        end else if (state == DONE_STATE) begin
-            if (out_idx < hidden_dim) begin
-                data_out <= input_buffer[out_idx];
-                out_valid <= 1'b1;
-                out_idx <= out_idx + 1;
+        always_ff @(posedge clk or negedge rst_n) begin
+            if (!rst_n) begin
+                out_idx <= '0;
+                out_valid <= 1'b0;
+            end else if (state == DONE_STATE) begin
+                if (out_idx < hidden_dim) begin
+                    data_out <= input_buffer[out_idx];
+                    out_valid <= 1'b1;
+                    out_idx <= out_idx + 1;
+                end else begin
+                    out_valid <= 1'b0;
+                end
             end else begin
+                out_idx <= '0;
                 out_valid <= 1'b0;
             end
-        end else begin
-            out_idx <= '0;
-            out_valid <= 1'b0;
         end
-    end
     
-    // Status
-    assign busy = (state != IDLE);
-    assign done = (state == DONE_STATE);
+        // Status
+        assign busy = (state != IDLE);
+        assign done = (state == DONE_STATE);
+
+        // No SRAM traffic in buffered mode
+        assign sram_rd_addr = '0;
+        assign sram_rd_en = 1'b0;
+        assign sram_wr_addr = '0;
+        assign sram_wr_data = '0;
+        assign sram_wr_mask = '0;
+        assign sram_wr_en = 1'b0;
+        assign param_rd_addr = '0;
+        assign param_rd_en = 1'b0;
+    end else begin : g_stream
+        // Rows are read from and written back to SRAM, so nothing scales
+        // with hidden_dim except the counters. Each access moves one word of
+        // LANES elements; sum / sum of squares reduce through adder trees
+        // and every lane has its own normalize/gamma/beta unit. W =
+        // ceil(hidden_dim / LANES) words per row:
+        //   STATS - read x, accumulate sum / sum of squares      W+1 cycles
+        //   MEAN, RSQRT - statistics and rsqrt lookup            2 cycles
+        //   READ, GAMMA, BETA, WRITE - per word: x on port A,
+        //           gamma then beta on port B, y on port A       4W cycles
+        // With gamma/beta cached, pass 2 skips GAMMA and port B:   3W cycles
+        // Port A requests wait for a grant; port B is not contended.
+        typedef enum logic [3:0] {
+            S_IDLE,
+            S_STATS,
+            S_MEAN,
+            S_RSQRT,
+            S_READ,
+            S_GAMMA,
+            S_BETA,
+            S_WRITE,
+            S_DONE
+        } stream_state_t;
+
+        stream_state_t state;
+
+        logic [15:0] row;
+        // Element counters step by LANES, so they carry a 17th bit to reach
+        // the word past a 65535-element row
+        logic [16:0] idx;           // First element of the word being normalized
+        logic [16:0] issued;        // Pass 1 elements requested (granted words)
+        logic [16:0] received;      // Pass 1 elements accumulated
+        logic        pending;       // A granted read returns data this cycle
+        logic [SRAM_ADDR_WIDTH-1:0] x_row, y_row;  // Current row base addresses
+
+        logic signed [ACC_WIDTH-1:0] sum_acc;
+        logic signed [ACC_WIDTH-1:0] sum_sq_acc;
+        logic signed [ACC_WIDTH-1:0] mean;
+        logic signed [ACC_WIDTH-1:0] variance;
+        logic signed [ACC_WIDTH-1:0] inv_sqrt_var;
+        logic signed [ACC_WIDTH-1:0] n_signed;
+        logic signed [ACC_WIDTH-1:0] mean_c;
+
+        // Lane reductions of the word returned in pass 1
+        logic signed [ACC_WIDTH-1:0] word_sum;
+        logic signed [ACC_WIDTH-1:0] word_sum_sq;
+
+        logic [LANES*DATA_WIDTH-1:0] x_q, gamma_q;
+        logic [LANES*DATA_WIDTH-1:0] y_q;
+        logic [LANES*DATA_WIDTH-1:0] y_c;
+        logic [LANES-1:0]            lane_on;   // Lanes inside the row (pass 2)
+
+        // Gamma/beta cache. Slots are filled during the first row of a miss
+        // and replaced round-robin.
+        localparam int CACHE_SLOTS = (PARAM_SLOTS > 0) ? PARAM_SLOTS : 1;
+        localparam int SLOT_BITS = (CACHE_SLOTS > 1) ? $clog2(CACHE_SLOTS) : 1;
+        localparam int SLOT_WORDS = (PARAM_DIM + LANES - 1) / LANES;
+        localparam int WORD_BITS = (SLOT_WORDS > 1) ? $clog2(SLOT_WORDS) : 1;
+
+        logic [LANES*DATA_WIDTH-1:0] gamma_cache [CACHE_SLOTS][SLOT_WORDS];
+        logic [LANES*DATA_WIDTH-1:0] beta_cache  [CACHE_SLOTS][SLOT_WORDS];
+        logic [CACHE_SLOTS-1:0]      slot_valid;
+        logic [SRAM_ADDR_WIDTH-1:0]  slot_addr [CACHE_SLOTS];
+        logic [15:0]                 slot_dim  [CACHE_SLOTS];
+        logic [SLOT_BITS-1:0]        victim;
+        logic [SLOT_BITS-1:0]        slot;      // Slot of the running invocation
+        logic                        cached;    // Pass 2 takes gamma/beta from slot
+        logic                        filling;   // Pass 2 writes gamma/beta into slot
+        logic [WORD_BITS-1:0]        word;
+
+        logic                        lookup_hit;
+        logic [SLOT_BITS-1:0]        lookup_slot;
+        logic                        cacheable;
+
+        always_comb begin
+            lookup_hit = 1'b0;
+            lookup_slot = '0;
+            for (int i = 0; i < CACHE_SLOTS; i++) begin
+                if (PARAM_SLOTS > 0 && slot_valid[i] && slot_addr[i] == param_addr &&
+                    slot_dim[i] == 16'(hidden_dim)) begin
+                    lookup_hit = 1'b1;
+                    lookup_slot = SLOT_BITS'(i);
+                end
+            end
+        end
+
+        assign cacheable = (PARAM_SLOTS > 0) && int'(hidden_dim) <= PARAM_DIM;
+        assign word = WORD_BITS'(idx / LANES);
+
+        assign n_signed = $signed(ACC_WIDTH'(hidden_dim));
+        assign mean_c = sum_acc / n_signed;
+
+        // Port A: x reads in STATS/READ, y writes in WRITE
+        assign sram_rd_en   = (state == S_STATS && issued < 17'(hidden_dim)) || state == S_READ;
+        assign sram_rd_addr = x_row + SRAM_ADDR_WIDTH'(state == S_STATS ? issued : idx);
+        assign sram_wr_en   = (state == S_WRITE);
+        assign sram_wr_addr = y_row + SRAM_ADDR_WIDTH'(idx);
+        assign sram_wr_data = y_q;
+        assign sram_wr_mask = lane_on;
+
+        // Port B: gamma[idx] in READ, beta[idx] (after gamma) in GAMMA
+        assign param_rd_en   = !cached && ((state == S_READ) || (state == S_GAMMA));
+        assign param_rd_addr = param_addr + SRAM_ADDR_WIDTH'(state == S_GAMMA ? hidden_dim : '0) +
+                               SRAM_ADDR_WIDTH'(idx);
+
+        always_comb begin
+            word_sum = '0;
+            word_sum_sq = '0;
+            for (int l = 0; l < LANES; l++) begin
+                logic signed [ACC_WIDTH-1:0] x;
+                x = ACC_WIDTH'($signed(sram_rd_data[l*DATA_WIDTH +: DATA_WIDTH]));
+                if (int'(received) + l < int'(hidden_dim)) begin
+                    word_sum = word_sum + x;
+                    word_sum_sq = word_sum_sq + x * x;
+                end
+            end
+        end
+
+        // Per lane: y = sat8(((((x - mean) * rsqrt) >>> 16) * gamma >>> 7) + beta).
+        // Uncached, x and gamma were registered in GAMMA and beta arrives on
+        // port B; cached, x arrives on port A and gamma/beta come from the slot.
+        always_comb begin
+            logic [LANES*DATA_WIDTH-1:0] x_w, gamma_w, beta_w;
+
+            x_w     = cached ? sram_rd_data : x_q;
+            gamma_w = cached ? gamma_cache[slot][word] : gamma_q;
+            beta_w  = cached ? beta_cache[slot][word] : param_rd_data;
+            for (int l = 0; l < LANES; l++) begin
+                logic signed [ACC_WIDTH-1:0] x_norm;
+                logic signed [ACC_WIDTH-1:0] shifted;
+
+                lane_on[l] = int'(idx) + l < int'(hidden_dim);
+                x_norm = ((ACC_WIDTH'($signed(x_w[l*DATA_WIDTH +: DATA_WIDTH])) - mean) * inv_sqrt_var) >>> 16;
+                shifted = ((x_norm * ACC_WIDTH'($signed(gamma_w[l*DATA_WIDTH +: DATA_WIDTH]))) >>> 7) +
+                          ACC_WIDTH'($signed(beta_w[l*DATA_WIDTH +: DATA_WIDTH]));
+                if (shifted > 127) begin
+                    y_c[l*DATA_WIDTH +: DATA_WIDTH] = 8'd127;
+                end else if (shifted < -128) begin
+                    y_c[l*DATA_WIDTH +: DATA_WIDTH] = 8'h80;
+                end else begin
+                    y_c[l*DATA_WIDTH +: DATA_WIDTH] = shifted[7:0];
+                end
+            end
+        end
+
+        always_ff @(posedge clk or negedge rst_n) begin
+            if (!rst_n) begin
+                state <= S_IDLE;
+                row <= '0;
+                idx <= '0;
+                issued <= '0;
+                received <= '0;
+                pending <= 1'b0;
+                x_row <= '0;
+                y_row <= '0;
+                sum_acc <= '0;
+                sum_sq_acc <= '0;
+                mean <= '0;
+                variance <= '0;
+                inv_sqrt_var <= '0;
+                x_q <= '0;
+                gamma_q <= '0;
+                y_q <= '0;
+                out_valid <= 1'b0;
+                data_out <= '0;
+                slot_valid <= '0;
+                victim <= '0;
+                slot <= '0;
+                cached <= 1'b0;
+                filling <= 1'b0;
+                for (int i = 0; i < CACHE_SLOTS; i++) begin
+                    slot_addr[i] <= '0;
+                    slot_dim[i] <= '0;
+                end
+            end else begin
+                out_valid <= 1'b0;
+
+                case (state)
+                    S_IDLE: begin
+                        row <= '0;
+                        x_row <= x_addr;
+                        y_row <= y_addr;
+                        sum_acc <= '0;
+                        sum_sq_acc <= '0;
+                        issued <= '0;
+                        received <= '0;
+                        pending <= 1'b0;
+                        if (start) begin
+                            state <= (hidden_dim == 0 || num_rows == 0) ? S_DONE : S_STATS;
+                            // A hit skips port B for the whole invocation. A miss
+                            // (or reload) refills the hit slot or the next victim.
+                            cached <= lookup_hit && !param_reload;
+                            filling <= cacheable && !(lookup_hit && !param_reload);
+                            slot <= lookup_hit ? lookup_slot : victim;
+                            if (cacheable && !(lookup_hit && !param_reload)) begin
+                                slot_valid[lookup_hit ? lookup_slot : victim] <= 1'b0;
+                                if (!lookup_hit) begin
+                                    victim <= (int'(victim) == CACHE_SLOTS - 1) ? '0 : victim + 1'b1;
+                                end
+                            end
+                        end
+                    end
+
+                    S_STATS: begin
+                        pending <= sram_rd_en && sram_rd_gnt;
+                        if (sram_rd_en && sram_rd_gnt) begin
+                            issued <= issued + LANES;
+                        end
+                        if (pending) begin
+                            sum_acc <= sum_acc + word_sum;
+                            sum_sq_acc <= sum_sq_acc + word_sum_sq;
+                            received <= received + LANES;
+                            if (int'(received) + LANES >= int'(hidden_dim)) state <= S_MEAN;
+                        end
+                    end
+
+                    S_MEAN: begin
+                        // var = E[x^2] - E[x]^2
+                        mean <= mean_c;
+                        variance <= (sum_sq_acc / n_signed) - mean_c * mean_c;
+                        state <= S_RSQRT;
+                    end
+
+                    S_RSQRT: begin
+                        if (variance > 0 && variance < 1024) begin
+                            inv_sqrt_var <= rsqrt_lut[variance[9:0]];
+                        end else if (variance >= 1024) begin
+                            inv_sqrt_var <= rsqrt_lut[1023];
+                        end else begin
+                            inv_sqrt_var <= rsqrt_lut[0];
+                        end
+                        idx <= '0;
+                        state <= S_READ;
+                    end
+
+                    S_READ: begin
+                        if (sram_rd_gnt) state <= cached ? S_BETA : S_GAMMA;
+                    end
+
+                    S_GAMMA: begin
+                        x_q <= sram_rd_data;
+                        gamma_q <= param_rd_data;
+                        state <= S_BETA;
+                    end
+
+                    S_BETA: begin
+                        y_q <= y_c;
+                        state <= S_WRITE;
+                    end
+
+                    S_WRITE: begin
+                        if (sram_wr_gnt) begin
+                            out_valid <= 1'b1;
+                            data_out <= y_q[DATA_WIDTH-1:0];
+                            if (int'(idx) + LANES >= int'(hidden_dim)) begin
+                                // The first row of a miss has filled the slot
+                                if (filling) begin
+                                    slot_valid[slot] <= 1'b1;
+                                    slot_addr[slot] <= param_addr;
+                                    slot_dim[slot] <= 16'(hidden_dim);
+                                    filling <= 1'b0;
+                                    cached <= 1'b1;
+                                end
+                                sum_acc <= '0;
+                                sum_sq_acc <= '0;
+                                issued <= '0;
+                                received <= '0;
+                                x_row <= x_row + hidden_dim;
+                                y_row <= y_row + hidden_dim;
+                                row <= row + 1;
+                                state <= (row == num_rows - 1) ? S_DONE : S_STATS;
+                            end else begin
+                                idx <= idx + LANES;
+                                state <= S_READ;
+                            end
+                        end
+                    end
+
+                    S_DONE: begin
+                        state <= S_IDLE;
+                    end
+
+                    default: state <= S_IDLE;
+                endcase
+            end
+        end
+
+        // Cache fill: gamma arrives in GAMMA, beta in BETA (uncached pass 2)
+        always_ff @(posedge clk) begin
+            if (filling && state == S_GAMMA) gamma_cache[slot][word] <= param_rd_data;
+            if (filling && state == S_BETA) beta_cache[slot][word] <= param_rd_data;
+        end
+
+        assign busy = (state != S_IDLE);
+        assign done = (state == S_DONE);
+    end
+    endgenerate
 
 endmodule
@@ -0,0 +1,142 @@
+// Activation LUT Loader
+// Executes LUT_LOAD: copies a 256-entry table from SRAM0 into the GELU LUT
+// (one byte per entry) or the softmax exp LUT (EXP_WIDTH bits per entry,
+// little-endian). Reads use the lowest-priority SRAM0 port A slot and only
+// advance when granted, so DMA/GEMM traffic just stretches the load.
+
+`timescale 1ns/1ps
+
+module lut_loader #(
+    parameter DATA_WIDTH = 8,
+    parameter EXP_WIDTH = 16,
+    parameter SRAM_ADDR_WIDTH = 16
+)(
+    input  logic                      clk,
+    input  logic                      rst_n,
+    
+    // Control
+    input  logic                      start,
+    input  logic                      table_sel,   // 0 = GELU, 1 = softmax exp
+    input  logic [SRAM_ADDR_WIDTH-1:0] src_addr,
+    output logic                      busy,
+    output logic                      done,
+    
+    // SRAM0 read (port A, granted when no higher-priority requester)
+    output logic [SRAM_ADDR_WIDTH-1:0] sram_rd_addr,
+    output logic                      sram_rd_en,
+    input  logic                      sram_rd_gnt,
+    input  logic [DATA_WIDTH-1:0]     sram_rd_data,
+    
+    // LUT write ports
+    output logic                      gelu_lut_wr_en,
+    output logic [7:0]                gelu_lut_wr_addr,
+    output logic [DATA_WIDTH-1:0]     gelu_lut_wr_data,
+    output logic                      exp_lut_wr_en,
+    output logic [7:0]                exp_lut_wr_addr,
+    output logic [EXP_WIDTH-1:0]      exp_lut_wr_data
+);
+
+    localparam int ENTRIES = 256;
+    localparam int EXP_BYTES = EXP_WIDTH / 8;
+
+    typedef enum logic [1:0] {
+        IDLE,
+        LOAD,
+        DONE_STATE
+    } state_t;
+    
+    state_t state;
+    
+    logic        sel;
+    logic [SRAM_ADDR_WIDTH-1:0] base;
+    logic [10:0] total_bytes;
+    logic [10:0] issued;      // reads granted so far
+    logic [10:0] received;    // bytes consumed so far
+    logic        pending;     // a granted read returns data this cycle
+    logic [EXP_WIDTH-1:0] exp_shift;
+    
+    // Byte index within the current exp entry
+    logic [$clog2(EXP_BYTES+1)-1:0] exp_byte;
+    
+    assign total_bytes  = sel ? 11'(ENTRIES * EXP_BYTES) : 11'(ENTRIES);
+    assign sram_rd_en   = (state == LOAD) && (issued < total_bytes);
+    assign sram_rd_addr = base + SRAM_ADDR_WIDTH'(issued);
+    
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state <= IDLE;
+            sel <= 1'b0;
+            base <= '0;
+            issued <= '0;
+            received <= '0;
+            pending <= 1'b0;
+            exp_shift <= '0;
+            exp_byte <= '0;
+            gelu_lut_wr_en <= 1'b0;
+            gelu_lut_wr_addr <= '0;
+            gelu_lut_wr_data <= '0;
+            exp_lut_wr_en <= 1'b0;
+            exp_lut_wr_addr <= '0;
+            exp_lut_wr_data <= '0;
+        end else begin
+            gelu_lut_wr_en <= 1'b0;
+            exp_lut_wr_en <= 1'b0;
+            
+            case (state)
+                IDLE: begin
+                    if (start) begin
+                        sel <= table_sel;
+                        base <= src_addr;
+                        issued <= '0;
+                        received <= '0;
+                        pending <= 1'b0;
+                        exp_byte <= '0;
+                        state <= LOAD;
+                    end
+                end
+                
+                LOAD: begin
+                    pending <= sram_rd_en && sram_rd_gnt;
+                    if (sram_rd_en && sram_rd_gnt) begin
+                        issued <= issued + 1;
+                    end
+                    
+                    if (pending) begin
+                        received <= received + 1;
+                        if (!sel) begin
+                            gelu_lut_wr_en <= 1'b1;
+                            gelu_lut_wr_addr <= received[7:0];
+                            gelu_lut_wr_data <= sram_rd_data;
+                        end else begin
+                            // Little-endian: shift bytes in from the top
+                            exp_shift <= {sram_rd_data, exp_shift[EXP_WIDTH-1:8]};
+                            if (exp_byte == EXP_BYTES - 1) begin
+                                exp_byte <= '0;
+                                exp_lut_wr_en <= 1'b1;
+                                exp_lut_wr_addr <= 8'(received / EXP_BYTES);
+                                exp_lut_wr_data <= {sram_rd_data, exp_shift[EXP_WIDTH-1:8]};
+                            end else begin
+                                exp_byte <= exp_byte + 1;
+                            end
+                        end
+                        if (received == total_bytes - 1) begin
+                            state <= DONE_STATE;
+                        end
+                    end
+                end
+                
+                DONE_STATE: begin
+                    state <= IDLE;
+                end
+                
+                default: state <= IDLE;
+            endcase
+        end
+    end
+    
+    // The last LUT write lands in the cycle after DONE_STATE is entered,
+    // so busy covers it through DONE_STATE
+    assign busy = (state != IDLE);
+    assign done = (state == DONE_STATE);
+
+endmodule
@@ -3,6 +3,18 @@
 // Pass 1: Find max (numerical stability)
 // Pass 2: Compute exp(x-max) and sum
 // Pass 3: Normalize by dividing by sum
+// The exp table can be reprogrammed at runtime (LUT_LOAD)
+//
+// LANES > 1 selects a row-parallel datapath instead: LANES elements per
+// cycle, a shift-based base-2 exp per lane and one reciprocal per row.
+// Data ports then carry LANES packed elements (lane 0 in the low byte).
+// That path does not use exp_lut.
+//
+// Sliding-window attention adds a window mask: with window = W, row r
+// keeps only the last W positions up to its own, r - W < c <= r. When
+// the scores are one band tile of a longer sequence, row_offset is the
+// distance from the tile's first key column to its first query row, so
+// query position r + row_offset is compared against key column c.
 
 `timescale 1ns/1ps
 
@@ -10,7 +22,9 @@ module softmax_engine #(
     parameter DATA_WIDTH = 8,
     parameter EXP_WIDTH = 16,     // Fixed-point exp result
     parameter SUM_WIDTH = 32,     // Accumulator for sum
-    parameter MAX_SEQ_LEN = 16
+    parameter MAX_SEQ_LEN = 16,
+    parameter LANES = 1,          // Elements per cycle (1 = three-pass LUT engine)
+    parameter FRAC_BITS = 4       // Fraction bits of the base-2 exp (LANES > 1)
 )(
     input  logic                      clk,
     input  logic                      rst_n,
@@ -23,54 +37,40 @@ module softmax_engine #(
     // Configuration
     input  logic [$clog2(MAX_SEQ_LEN)-1:0] seq_len,  // Current sequence length
     input  logic                      causal_mask,   // Apply causal masking
+    input  logic [15:0]               window,        // Sliding-window width, 0 = unlimited
+    input  logic [15:0]               row_offset,    // Query position of row 0 minus key position of col 0
+    
+    // Exp LUT programming (one entry per cycle, e.g. from lut_loader)
+    input  logic                      exp_lut_wr_en,
+    input  logic [7:0]                exp_lut_wr_addr,
+    input  logic [EXP_WIDTH-1:0]      exp_lut_wr_data,
     
     // Data input (row by row)
-    input  logic [DATA_WIDTH-1:0]     data_in,
+    input  logic [LANES*DATA_WIDTH-1:0] data_in,
     input  logic                      data_valid,
-    input  logic [$clog2(MAX_SEQ_LEN)-1:0] col_in,   // Column index
+    input  logic [$clog2(MAX_SEQ_LEN)-1:0] col_in,   // Column index (of lane 0)
     input  logic [$clog2(MAX_SEQ_LEN)-1:0] row_in,   // Row index
     
     // Data output
-    output logic [DATA_WIDTH-1:0]     data_out,
+    output logic [LANES*DATA_WIDTH-1:0] data_out,
     output logic                      out_valid,
     output logic [$clog2(MAX_SEQ_LEN)-1:0] col_out,
     output logic [$clog2(MAX_SEQ_LEN)-1:0] row_out
 );
 
-    // States
-    typedef enum logic [2:0] {
-        IDLE,
-        PASS1_MAX,      // Find max per row
-        PASS2_EXP_SUM,  // Compute exp and sum
-        PASS3_NORM,     // Normalize
-        DONE_STATE
-    } state_t;
-    
-    state_t state, next_state;
-    
-    // Row buffers
-    logic [DATA_WIDTH-1:0] input_buffer [0:MAX_SEQ_LEN-1][0:MAX_SEQ_LEN-1];
-    logic [DATA_WIDTH-1:0] max_per_row [0:MAX_SEQ_LEN-1];
-    logic [SUM_WIDTH-1:0]  sum_per_row [0:MAX_SEQ_LEN-1];
-    logic [DATA_WIDTH-1:0] result_buffer [0:MAX_SEQ_LEN-1][0:MAX_SEQ_LEN-1];
-    
-    // Current processing state
-    logic [$clog2(MAX_SEQ_LEN)-1:0] current_row;
-    logic [$clog2(MAX_SEQ_LEN)-1:0] current_col;
-    
-    // Pass 2: Exp computation
-    logic [EXP_WIDTH-1:0] exp_result;             // exp(diff)
-    
-    // Pass 3: Normalization
-    logic [EXP_WIDTH+16-1:0] norm_result;         // exp / sum
-    
+    // Whether score [row][col] takes part in its row's softmax
+    function automatic logic keep(input int row, input int col);
+        int pos;
+        pos = row + int'(row_offset);
+        return (!causal_mask || col <= pos) && (window == '0 || col + int'(window) > pos);
+    endfunction
+
     // Exp LUT: maps signed 8-bit difference to exp value
     // Precomputed: exp(x) for x in range [-8, 0] scaled to fit in EXP_WIDTH
     // For x < -8, exp(x) is effectively 0
-    logic [EXP_WIDTH-1:0] exp_lut [0:255];
+    logic [EXP_WIDTH-1:0] exp_lut [0:255] /*verilator public_flat_rd*/;
     
-    // Initialize LUT (in real implementation, use $readmemh)
-    // For now, approximate values
+    // Reset default; LUT_LOAD reprograms it from SRAM0 at runtime
     initial begin
         for (int i = 0; i < 256; i++) begin
             // i is signed 8-bit value
@@ -87,145 +87,349 @@ module softmax_engine #(
         end
     end
     
+    // Runtime reload
+    always_ff @(posedge clk) begin
+        if (exp_lut_wr_en) begin
+            exp_lut[exp_lut_wr_addr] <= exp_lut_wr_data;
+        end
+    end
 
-    // Sequential logic
-    always_ff @(posedge clk or negedge rst_n) begin
-        if (!rst_n) begin
-            state <= IDLE;
-            current_row <= '0;
-            current_col <= '0;
-        end else begin
-            state <= next_state;
+    generate
+    if (LANES == 1) begin : g_serial
+        // States
+        typedef enum logic [2:0] {
+            IDLE,
+            PASS1_MAX,      // Find max per row
+            PASS2_EXP_SUM,  // Compute exp and sum
+            PASS3_NORM,     // Normalize
+            DONE_STATE
+        } state_t;
+    
+        state_t state, next_state;
+    
+        // Row buffers
+        logic [DATA_WIDTH-1:0] input_buffer [0:MAX_SEQ_LEN-1][0:MAX_SEQ_LEN-1];
+        logic [DATA_WIDTH-1:0] max_per_row [0:MAX_SEQ_LEN-1];
+        logic [SUM_WIDTH-1:0]  sum_per_row [0:MAX_SEQ_LEN-1];
+        logic [DATA_WIDTH-1:0] result_buffer [0:MAX_SEQ_LEN-1][0:MAX_SEQ_LEN-1];
+    
+        // Current processing state
+        logic [$clog2(MAX_SEQ_LEN)-1:0] current_row;
+        logic [$clog2(MAX_SEQ_LEN)-1:0] current_col;
+    
+        // Pass 2: Exp computation
+        logic [EXP_WIDTH-1:0] exp_result;             // exp(diff)
+    
+        // Pass 3: Normalization
+        logic [EXP_WIDTH+16-1:0] norm_result;         // exp / sum
+    
+        // Sequential logic
+        always_ff @(posedge clk or negedge rst_n) begin
+            if (!rst_n) begin
+                state <= IDLE;
+                current_row <= '0;
+                current_col <= '0;
+            end else begin
+                state <= next_state;
             
-            case (state)
-                IDLE: begin
-                    current_row <= '0;
-                    current_col <= '0;
-                    if (start) begin
-                        // Initialize max values to minimum
-                        for (int i = 0; i < MAX_SEQ_LEN; i++) begin
-                            max_per_row[i] <= 8'h80;  // -128
-                            sum_per_row[i] <= '0;
+                case (state)
+                    IDLE: begin
+                        current_row <= '0;
+                        current_col <= '0;
+                        if (start) begin
+                            // Initialize max values to minimum
+                            for (int i = 0; i < MAX_SEQ_LEN; i++) begin
+                                max_per_row[i] <= 8'h80;  // -128
+                                sum_per_row[i] <= '0;
+                            end
                         end
                     end
-                end
                 
-                PASS1_MAX: begin
-                    // Find max for each row
-                    if (current_row < seq_len) begin
-                        if (current_col < seq_len) begin
-                            // Check if this element is greater than current max
-                            // Apply causal mask if enabled
-                            if (!causal_mask || current_col <= current_row) begin
-                                if ($signed(input_buffer[current_row][current_col]) > 
-                                    $signed(max_per_row[current_row])) begin
-                                    max_per_row[current_row] <= input_buffer[current_row][current_col];
+                    PASS1_MAX: begin
+                        // Find max for each row
+                        if (current_row < seq_len) begin
+                            if (current_col < seq_len) begin
+                                // Check if this element is greater than current max
+                                // Apply the causal and window masks if enabled
+                                if (keep(int'(current_row), int'(current_col))) begin
+                                    if ($signed(input_buffer[current_row][current_col]) > 
+                                        $signed(max_per_row[current_row])) begin
+                                        max_per_row[current_row] <= input_buffer[current_row][current_col];
+                                    end
                                 end
+                                current_col <= current_col + 1;
+                            end else begin
+                                current_col <= '0;
+                                current_row <= current_row + 1;
                             end
-                            current_col <= current_col + 1;
-                        end else begin
-                            current_col <= '0;
-                            current_row <= current_row + 1;
                         end
                     end
-                end
                 
-                PASS2_EXP_SUM: begin
-                    // Compute exp and sum for each row
-                    if (current_row < seq_len) begin
-                        if (current_col < seq_len) begin
-                            if (!causal_mask || current_col <= current_row) begin
-                                // Lookup exp
-                                // Convert signed diff to unsigned index
-                                exp_result <= exp_lut[$signed(input_buffer[current_row][current_col]) - 
-                                                        $signed(max_per_row[current_row])];
+                    PASS2_EXP_SUM: begin
+                        // Compute exp and sum for each row
+                        if (current_row < seq_len) begin
+                            if (current_col < seq_len) begin
+                                if (keep(int'(current_row), int'(current_col))) begin
+                                    // Lookup exp
+                                    // Convert signed diff to unsigned index
+                                    exp_result <= exp_lut[$signed(input_buffer[current_row][current_col]) - 
+                                                            $signed(max_per_row[current_row])];
                                 
-                                // Accumulate sum (pipelined)
-                                sum_per_row[current_row] <= sum_per_row[current_row] + SUM_WIDTH'(exp_result);
+                                    // Accumulate sum (pipelined)
+                                    sum_per_row[current_row] <= sum_per_row[current_row] + SUM_WIDTH'(exp_result);
+                                end
+                                current_col <= current_col + 1;
+                            end else begin
+                                current_col <= '0;
+                                current_row <= current_row + 1;
                             end
-                            current_col <= current_col + 1;
-                        end else begin
-                            current_col <= '0;
-                            current_row <= current_row + 1;
                         end
                     end
-                end
                 
-                PASS3_NORM: begin
-                    // Normalize: exp / sum
-                    if (current_row < seq_len) begin
-                        if (current_col < seq_len) begin
-                            if (!causal_mask || current_col <= current_row) begin
-                                // Multiply by reciprocal of sum
-                                // result = exp * (1/sum) * 127 (to get back to INT8 range)
-                                norm_result <= (exp_result * 16'h7FFF) / sum_per_row[current_row];
-                                result_buffer[current_row][current_col] <= 
-                                    norm_result > 127 ? 8'd127 : norm_result[7:0];
+                    PASS3_NORM: begin
+                        // Normalize: exp / sum
+                        if (current_row < seq_len) begin
+                            if (current_col < seq_len) begin
+                                if (keep(int'(current_row), int'(current_col))) begin
+                                    // Multiply by reciprocal of sum
+                                    // result = exp * (1/sum) * 127 (to get back to INT8 range)
+                                    norm_result <= (exp_result * 16'h7FFF) / sum_per_row[current_row];
+                                    result_buffer[current_row][current_col] <= 
+                                        norm_result > 127 ? 8'd127 : norm_result[7:0];
+                                end else begin
+                                    result_buffer[current_row][current_col] <= 8'd0;  // Masked
+                                end
+                                current_col <= current_col + 1;
                             end else begin
-                                result_buffer[current_row][current_col] <= 8'd0;  // Masked
+                                current_col <= '0;
+                                current_row <= current_row + 1;
                             end
-                            current_col <= current_col + 1;
-                        end else begin
-                            current_col <= '0;
-                            current_row <= current_row + 1;
                         end
                     end
-                end
                 
+                    default: begin
+                        current_row <= '0;
+                        current_col <= '0;
+                    end
+                endcase
+            end
+        end
+    
+        // Next state logic
+        always_comb begin
+            next_state = state;
+        
+            case (state)
+                IDLE: begin
+                    if (start) next_state = PASS1_MAX;
+                end
+            
+                PASS1_MAX: begin
+                    if (current_row >= seq_len) next_state = PASS2_EXP_SUM;
+                end
+            
+                PASS2_EXP_SUM: begin
+                    if (current_row >= seq_len) next_state = PASS3_NORM;
+                end
+            
+                PASS3_NORM: begin
+                    if (current_row >= seq_len) next_state = DONE_STATE;
+                end
+            
+                DONE_STATE: begin
+                    next_state = IDLE;
+                end
+
                 default: begin
-                    current_row <= '0;
-                    current_col <= '0;
+                    next_state = IDLE;
                 end
             endcase
         end
-    end
     
-    // Next state logic
-    always_comb begin
-        next_state = state;
-        
-        case (state)
-            IDLE: begin
-                if (start) next_state = PASS1_MAX;
-            end
-            
-            PASS1_MAX: begin
-                if (current_row >= seq_len) next_state = PASS2_EXP_SUM;
+        // Status
+        assign busy = (state != IDLE);
+        assign done = (state == DONE_STATE);
+    
+        // Input capture
+        always_ff @(posedge clk) begin
+            if (data_valid) begin
+                input_buffer[row_in][col_in] <= data_in;
             end
-            
-            PASS2_EXP_SUM: begin
-                if (current_row >= seq_len) next_state = PASS3_NORM;
+        end
+    
+        // Output generation
+        assign row_out = current_row;
+        assign col_out = current_col;
+        assign data_out = result_buffer[row_out][col_out];
+        assign out_valid = (state == DONE_STATE);
+    end else begin : g_lanes
+        // LANES columns per cycle, one row at a time:
+        //   MAX   - lane max tree into the row max       ceil(N/LANES) cycles
+        //   EXP   - base-2 exp per lane, lane adder tree ceil(N/LANES) cycles
+        //   RECIP - one divide per row                   1 cycle
+        //   NORM  - exp * recip per lane, LANES outputs  ceil(N/LANES) cycles
+        //
+        // exp(d) = 2^(d * log2 e). With t = -d * log2 e in Q8, the integer
+        // part becomes a right shift and the top FRAC_BITS fraction bits
+        // index a 2^-f table, so no lane needs the 256-entry exp_lut.
+        localparam int LOG2E_Q8    = 369;   // round(log2(e) * 256)
+        localparam int RECIP_SHIFT = 24;
+        localparam int FRAC_SIZE   = 1 << FRAC_BITS;
+
+        typedef enum logic [2:0] {
+            L_IDLE,
+            L_MAX,
+            L_EXP,
+            L_RECIP,
+            L_NORM,
+            L_DONE
+        } lane_state_t;
+
+        lane_state_t state;
+
+        logic [DATA_WIDTH-1:0] input_buffer [0:MAX_SEQ_LEN-1][0:MAX_SEQ_LEN-1];
+        logic [EXP_WIDTH-1:0]  exp_buffer [0:MAX_SEQ_LEN-1];   // Current row
+        logic [EXP_WIDTH-1:0]  frac_lut [0:FRAC_SIZE-1];
+
+        logic [$clog2(MAX_SEQ_LEN)-1:0] current_row;
+        logic [$clog2(MAX_SEQ_LEN):0]   current_col;             // First lane's column
+        logic signed [DATA_WIDTH-1:0]   row_max;
+        logic [SUM_WIDTH-1:0]           row_sum;
+        logic [SUM_WIDTH-1:0]           row_recip;               // (127 << RECIP_SHIFT) / row_sum
+
+        // Per-lane datapath
+        logic                          lane_on   [0:LANES-1];
+        logic signed [DATA_WIDTH-1:0]  lane_x    [0:LANES-1];
+        logic [EXP_WIDTH-1:0]          lane_exp  [0:LANES-1];
+        logic [DATA_WIDTH-1:0]         lane_prob [0:LANES-1];
+        logic signed [DATA_WIDTH-1:0]  chunk_max;
+        logic [SUM_WIDTH-1:0]          chunk_sum;
+        logic                          last_chunk;
+
+        // 2^(-f / FRAC_SIZE) in Q4.12; a ROM of FRAC_SIZE entries per lane
+        initial begin
+            for (int f = 0; f < FRAC_SIZE; f++) begin
+                frac_lut[f] = EXP_WIDTH'($rtoi(2.0 ** (-real'(f) / FRAC_SIZE) * 4096.0 + 0.5));
             end
-            
-            PASS3_NORM: begin
-                if (current_row >= seq_len) next_state = DONE_STATE;
+        end
+
+        always_comb begin
+            chunk_max = {1'b1, {(DATA_WIDTH-1){1'b0}}};
+            chunk_sum = '0;
+            for (int l = 0; l < LANES; l++) begin
+                int col;
+                logic signed [DATA_WIDTH:0] diff;
+                logic [DATA_WIDTH+9:0] t;
+                int shift;
+                logic [EXP_WIDTH+SUM_WIDTH-1:0] scaled;
+
+                col = int'(current_col) + l;
+                lane_on[l] = col < int'(seq_len) && keep(int'(current_row), col);
+                lane_x[l] = col < MAX_SEQ_LEN ? input_buffer[current_row][col] : '0;
+
+                // exp(x - max) = frac_lut[t frac] >> t int, t = (max - x) * log2 e
+                diff = row_max - lane_x[l];
+                t = diff * LOG2E_Q8;
+                shift = int'(t >> 8);
+                lane_exp[l] = shift >= EXP_WIDTH ? '0 : frac_lut[t[7 -: FRAC_BITS]] >> shift;
+
+                // exp <= sum, so the rounded product never exceeds 127
+                scaled = col < MAX_SEQ_LEN ? exp_buffer[col] * row_recip : '0;
+                lane_prob[l] = lane_on[l] ? DATA_WIDTH'((scaled + (1 << (RECIP_SHIFT-1))) >> RECIP_SHIFT) : '0;
+
+                if (lane_on[l]) begin
+                    if (lane_x[l] > chunk_max) chunk_max = lane_x[l];
+                    chunk_sum = chunk_sum + SUM_WIDTH'(lane_exp[l]);
+                end
             end
-            
-            DONE_STATE: begin
-                next_state = IDLE;
+            last_chunk = int'(current_col) + LANES >= int'(seq_len);
+        end
+
+        always_ff @(posedge clk or negedge rst_n) begin
+            if (!rst_n) begin
+                state <= L_IDLE;
+                current_row <= '0;
+                current_col <= '0;
+                row_max <= '0;
+                row_sum <= '0;
+                row_recip <= '0;
+                out_valid <= 1'b0;
+            end else begin
+                out_valid <= 1'b0;
+
+                case (state)
+                    L_IDLE: begin
+                        current_row <= '0;
+                        current_col <= '0;
+                        row_max <= {1'b1, {(DATA_WIDTH-1){1'b0}}};
+                        row_sum <= '0;
+                        if (start) state <= seq_len == 0 ? L_DONE : L_MAX;
+                    end
+
+                    L_MAX: begin
+                        if (chunk_max > row_max) row_max <= chunk_max;
+                        current_col <= last_chunk ? '0 : current_col + LANES;
+                        if (last_chunk) state <= L_EXP;
+                    end
+
+                    L_EXP: begin
+                        for (int l = 0; l < LANES; l++) begin
+                            if (int'(current_col) + l < MAX_SEQ_LEN) begin
+                                exp_buffer[int'(current_col) + l] <= lane_on[l] ? lane_exp[l] : '0;
+                            end
+                        end
+                        row_sum <= row_sum + chunk_sum;
+                        current_col <= last_chunk ? '0 : current_col + LANES;
+                        if (last_chunk) state <= L_RECIP;
+                    end
+
+                    L_RECIP: begin
+                        // The row max always contributes 1.0, so row_sum > 0
+                        row_recip <= (SUM_WIDTH'(127) << RECIP_SHIFT) / row_sum;
+                        state <= L_NORM;
+                    end
+
+                    L_NORM: begin
+                        for (int l = 0; l < LANES; l++) begin
+                            data_out[l*DATA_WIDTH +: DATA_WIDTH] <= lane_prob[l];
+                        end
+                        out_valid <= 1'b1;
+                        row_out <= current_row;
+                        col_out <= current_col[$clog2(MAX_SEQ_LEN)-1:0];
+                        current_col <= last_chunk ? '0 : current_col + LANES;
+                        if (last_chunk) begin
+                            row_max <= {1'b1, {(DATA_WIDTH-1){1'b0}}};
+                            row_sum <= '0;
+                            if (int'(current_row) + 1 >= int'(seq_len)) begin
+                                state <= L_DONE;
+                            end else begin
+                                current_row <= current_row + 1;
+                                state <= L_MAX;
+                            end
+                        end
+                    end
+
+                    default: begin
+                        state <= L_IDLE;
+                    end
+                endcase
             end
+        end
+
+        assign busy = (state != L_IDLE);
+        assign done = (state == L_DONE);
 
-            default: begin
-                next_state = IDLE;
+        // Input capture: LANES consecutive columns starting at col_in
+        always_ff @(posedge clk) begin
+            if (data_valid) begin
+                for (int l = 0; l < LANES; l++) begin
+                    if (int'(col_in) + l < MAX_SEQ_LEN) begin
+                        input_buffer[row_in][int'(col_in) + l] <= data_in[l*DATA_WIDTH +: DATA_WIDTH];
+                    end
+                end
             end
-        endcase
-    end
-    
-    // Status
-    assign busy = (state != IDLE);
-    assign done = (state == DONE_STATE);
-    
-    // Input capture
-    always_ff @(posedge clk) begin
-        if (data_valid) begin
-            input_buffer[row_in][col_in] <= data_in;
         end
     end
-    
-    // Output generation
-    assign row_out = current_row;
-    assign col_out = current_col;
-    assign data_out = result_buffer[row_out][col_out];
-    assign out_valid = (state == DONE_STATE);
+    endgenerate
 
 endmodule
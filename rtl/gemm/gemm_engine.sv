@@ -1,5 +1,43 @@
 // GEMM Engine with Tiling Support
-// Wraps systolic array with control logic for arbitrary matrix sizes
+// Wraps systolic array with control logic for arbitrary matrix sizes.
+// batch_count > 1 runs a strided batch (one GEMM per attention head, say):
+// batch i reads A at src_a + i*stride_a, B at src_b + i*stride_b and
+// writes C at dst + i*stride_c, with one start/done for the whole batch.
+// With stride_b = 0 every batch shares B (grouped-query attention: one
+// K/V head per group of query heads), and the weight tile buffer stays
+// valid across batches so B is fetched once.
+// int4_weights: B is INT4, two columns per byte, and the array computes
+// 2*ARRAY_SIZE output columns per tile (systolic_array int4_mode).
+// loop_order picks the tile loop nest, outermost first:
+//   MNK - k innermost, then n, then m. A's row panel stays in the
+//         activation tile buffer across the N loop.
+//   NMK - k innermost, then m, then n. B's column panel stays in the
+//         weight tile buffer across the M loop.
+//   KMN - n innermost, then m, then k. Each A tile is used for a row of N
+//         tiles and B's row panel stays resident across the M loop; partial
+//         sums for every output tile stay in the accumulator buffer until
+//         the last K step. Falls back to MNK when the output tiles do not
+//         fit ACC_BUF_TILES.
+// A tile load is skipped (along with its LOAD_* cycle) when the tile is
+// already resident. Both tile buffers are direct-mapped by linear tile
+// index, so a panel longer than the buffer thrashes it.
+// wgt_stream (GEMM_STREAM) takes B from the DMA weight FIFO instead of
+// SRAM. The FIFO can only be read once, so the walk is weight-stationary
+// whatever loop_order says: n outermost, then k, then m, and every B tile
+// is fetched exactly once, in that order. Each tile arrives as tile_k rows
+// of tile_n bytes, each row padded to whole 8-byte beats. LOAD_WEIGHT_TILE
+// pops one beat per cycle, stalling while the FIFO is empty, and writes a
+// row into the array (array_load_weights) on its last beat. The M tiles
+// of a column of C share the accumulator buffer, so M is limited to
+// ARRAY_SIZE * ACC_BUF_TILES rows; transpose_b and batch_count are ignored.
+// residual_en (GEMM_RESIDUAL) is meant to add an INT8 tensor R, laid out
+// like C at residual_addr, to each output tile after requantization and
+// saturate to INT8, so an output projection writes x + proj(x) in one
+// pass (gemm_residual_golden). Like the rest of the datapath this is a
+// timing/address placeholder: LOAD_RESID_TILE spends one cycle between an
+// output tile's last K step and its store with the R tile's address on
+// sram_rd_addr, but sram_rd_en stays low and no add or saturation exists
+// yet. residual_addr may equal dst_addr to update R in place.
 
 `timescale 1ns/1ps
 
@@ -7,7 +45,10 @@ module gemm_engine #(
     parameter DATA_WIDTH = 8,
     parameter ACC_WIDTH = 32,
     parameter ARRAY_SIZE = 16,
-    parameter SRAM_ADDR_WIDTH = 16
+    parameter SRAM_ADDR_WIDTH = 16,
+    parameter ACT_BUF_TILES = 16,   // activation tile buffer (ARRAY_SIZE^2 bytes each)
+    parameter WGT_BUF_TILES = 16,   // weight tile buffer
+    parameter ACC_BUF_TILES = 16    // output tiles KMN can keep partial sums for
 )(
     input  logic                      clk,
     input  logic                      rst_n,
@@ -25,10 +66,27 @@ module gemm_engine #(
     input  logic [15:0]               dim_k,         // Cols of A, rows of B
     input  logic [15:0]               dim_n,         // Cols of B and C
     input  logic                      transpose_b,   // Transpose B matrix
+    input  logic                      int4_weights,  // B packed INT4 [K, N/2]; no transpose_b
     input  logic                      accumulate,    // Accumulate with existing output
     input  logic [7:0]                scale,         // Requantization scale
     input  logic [7:0]                shift,         // Requantization shift
     input  logic                      requant_en,    // Enable requantization
+    input  logic [3:0]                out_block_log2, // 0: C row-major; b: scatter C's
+                                                      // 2^b-column blocks (see out_addr)
+    input  logic [15:0]               batch_count,   // GEMMs per start (0 and 1: one)
+    input  logic [15:0]               batch_stride_a, // Per-batch operand offsets
+    input  logic [15:0]               batch_stride_b,
+    input  logic [15:0]               batch_stride_c,
+    input  logic [15:0]               ldc,           // C row stride, 0 = dim_n
+    input  logic [1:0]                loop_order,    // LOOP_MNK / LOOP_NMK / LOOP_KMN
+    input  logic                      residual_en,   // C = sat(C + R) after requant (placeholder)
+    input  logic [SRAM_ADDR_WIDTH-1:0] residual_addr, // R, same layout as C
+    
+    // Weight stream (GEMM_STREAM): B tiles from the DMA weight FIFO
+    input  logic                       wgt_stream,
+    input  logic                       wgt_fifo_valid,
+    input  logic [63:0]                wgt_fifo_data,
+    output logic                       wgt_fifo_pop,
     
     // SRAM interface (read)
     output logic [SRAM_ADDR_WIDTH-1:0] sram_rd_addr,
@@ -55,25 +113,75 @@ module gemm_engine #(
         STORE_RESULT,
         NEXT_TILE,
         REQUANTIZE,
-        DONE_STATE
+        DONE_STATE,
+        LOAD_RESID_TILE
     } state_t;
     
-    state_t state, next_state;
+    state_t state /*verilator public_flat_rd*/;
+    state_t next_state;
     
     // Tile counters
     localparam int TILE_COUNT_W = $clog2(65536/ARRAY_SIZE) + 1;
     localparam int TILE_SIZE_W  = $clog2(ARRAY_SIZE) + 1;
+    localparam int TILE_N_W     = $clog2(2*ARRAY_SIZE) + 1;
 
     logic [TILE_COUNT_W-1:0] tile_m, tile_n, tile_k;
     logic [TILE_COUNT_W-1:0] tiles_m, tiles_n, tiles_k;
+    logic last_tile;
+
+    // Loop order (outermost first)
+    localparam logic [1:0] LOOP_MNK = 2'd0;
+    localparam logic [1:0] LOOP_NMK = 2'd1;
+    localparam logic [1:0] LOOP_KMN = 2'd2;
+    localparam logic [1:0] LOOP_NKM = 2'd3;    // weight stream only
+
+    logic [1:0] order;     // loop_order, with KMN demoted when C does not fit
+    logic [TILE_COUNT_W-1:0] next_m, next_n, next_k;
+    logic [31:0] out_tiles;
+
+    // Tile buffers: A tile (m, k) lives in activation slot
+    // (m*tiles_k + k) mod ACT_BUF_TILES, B tile (n, k) in weight slot
+    // (n*tiles_k + k) mod WGT_BUF_TILES (k*tiles_n + n under KMN, whose
+    // reused panel is a row of B), each tagged with its linear index.
+    // Only tags are tracked until the operand datapath lands.
+    localparam int ACT_SLOT_W = $clog2(ACT_BUF_TILES);
+    localparam int WGT_SLOT_W = $clog2(WGT_BUF_TILES);
+    logic [31:0] act_buf_tag   [0:ACT_BUF_TILES-1];
+    logic        act_buf_valid [0:ACT_BUF_TILES-1];
+    logic [31:0] wgt_buf_tag   [0:WGT_BUF_TILES-1];
+    logic        wgt_buf_valid [0:WGT_BUF_TILES-1];
+    logic [31:0] act_id, next_act_id;
+    logic [31:0] weight_id, next_weight_id;
+    logic        act_resident;     // current tile's A is in the buffer
+    logic        next_act_hit, next_weight_hit;
+
+    // Weight stream: row of the current B tile and beat within that row.
+    // A row's earlier beats wait in wgt_row_buf until its last one arrives.
+    localparam int BEAT_BYTES = 8;
+    logic [TILE_SIZE_W-1:0] wgt_row;
+    logic [15:0]            wgt_row_beat, row_beats;
+    logic [TILE_N_W-1:0]    row_bytes;
+    logic                   wgt_row_loaded, wgt_tile_loaded;
+    logic [DATA_WIDTH-1:0]  wgt_row_buf [0:ARRAY_SIZE-1];
+
+    // Batch counter and the running A/B/C offsets of the current batch
+    logic [15:0] batch;
+    logic [SRAM_ADDR_WIDTH-1:0] batch_a_off, batch_b_off, batch_c_off;
+    logic last_batch;
+    logic batch_advance;   // STORE_RESULT of a batch's last tile, more batches left
     
     // Current tile addresses
     logic [SRAM_ADDR_WIDTH-1:0] tile_a_addr;
     logic [SRAM_ADDR_WIDTH-1:0] tile_b_addr;
     logic [SRAM_ADDR_WIDTH-1:0] tile_c_addr;
+    logic [SRAM_ADDR_WIDTH-1:0] tile_r_addr;
     
     // Tile size (may be smaller at edges)
-    logic [TILE_SIZE_W-1:0] tile_size_m, tile_size_n, tile_size_k;
+    logic [TILE_SIZE_W-1:0] tile_size_m /*verilator public_flat_rd*/;
+    logic [TILE_SIZE_W-1:0] tile_size_k /*verilator public_flat_rd*/;
+    logic [TILE_N_W-1:0]    tile_size_n /*verilator public_flat_rd*/;  // N tile is 2x wide for INT4
+    logic [TILE_N_W-1:0]    tile_width_n;
+    logic [TILE_N_W-1:0]    dim_n_rem;
 
     // Explicitly sized intermediates for width-safe tile math
     logic [16:0] dim_m_ext, dim_n_ext, dim_k_ext;
@@ -90,9 +198,10 @@ module gemm_engine #(
     logic                      array_result_valid;
     logic                      array_busy;
     
-    // Accumulation buffer for partial sums across K tiles
-    logic [ACC_WIDTH-1:0] accum_buffer [0:ARRAY_SIZE-1][0:ARRAY_SIZE-1];
-    logic accum_buffer_valid [0:ARRAY_SIZE-1][0:ARRAY_SIZE-1];
+    // Accumulation buffer for partial sums across K tiles (one tile per
+    // output tile under KMN)
+    logic [ACC_WIDTH-1:0] accum_buffer [0:ACC_BUF_TILES-1][0:ARRAY_SIZE-1][0:ARRAY_SIZE-1];
+    logic accum_buffer_valid [0:ACC_BUF_TILES-1];
     
     // Requantization
     logic [DATA_WIDTH-1:0] requant_result [0:ARRAY_SIZE-1];
@@ -107,33 +216,99 @@ module gemm_engine #(
             tile_m <= '0;
             tile_n <= '0;
             tile_k <= '0;
+            batch <= '0;
+            batch_a_off <= '0;
+            batch_b_off <= '0;
+            batch_c_off <= '0;
             compute_cycles <= '0;
+            wgt_row <= '0;
+            wgt_row_beat <= '0;
+            act_resident <= 1'b0;
+            for (int j = 0; j < ARRAY_SIZE; j++) wgt_row_buf[j] <= '0;
+            for (int s = 0; s < ACT_BUF_TILES; s++) begin
+                act_buf_valid[s] <= 1'b0;
+                act_buf_tag[s] <= '0;
+            end
+            for (int s = 0; s < WGT_BUF_TILES; s++) begin
+                wgt_buf_valid[s] <= 1'b0;
+                wgt_buf_tag[s] <= '0;
+            end
         end else begin
             state <= next_state;
             
             case (state)
+                IDLE: begin
+                    compute_cycles <= '0;
+                    if (start) begin
+                        tile_m <= '0;
+                        tile_n <= '0;
+                        tile_k <= '0;
+                        batch <= '0;
+                        batch_a_off <= '0;
+                        batch_b_off <= '0;
+                        batch_c_off <= '0;
+                        wgt_row <= '0;
+                        wgt_row_beat <= '0;
+                        act_resident <= 1'b0;
+                        for (int s = 0; s < ACT_BUF_TILES; s++) act_buf_valid[s] <= 1'b0;
+                        for (int s = 0; s < WGT_BUF_TILES; s++) wgt_buf_valid[s] <= 1'b0;
+                    end
+                end
+
+                LOAD_WEIGHT_TILE: begin
+                    if (wgt_fifo_pop) begin
+                        for (int i = 0; i < BEAT_BYTES; i++) begin
+                            if (32'(wgt_row_beat) * BEAT_BYTES + i < ARRAY_SIZE)
+                                wgt_row_buf[32'(wgt_row_beat) * BEAT_BYTES + i] <= wgt_fifo_data[i*8 +: DATA_WIDTH];
+                        end
+                        wgt_row_beat <= wgt_row_loaded ? '0 : wgt_row_beat + 16'd1;
+                        if (wgt_row_loaded) wgt_row <= wgt_tile_loaded ? '0 : wgt_row + 1'b1;
+                    end
+                    wgt_buf_valid[WGT_SLOT_W'(weight_id % WGT_BUF_TILES)] <= 1'b1;
+                    wgt_buf_tag[WGT_SLOT_W'(weight_id % WGT_BUF_TILES)] <= weight_id;
+                end
+
+                LOAD_ACT_TILE: begin
+                    act_buf_valid[ACT_SLOT_W'(act_id % ACT_BUF_TILES)] <= 1'b1;
+                    act_buf_tag[ACT_SLOT_W'(act_id % ACT_BUF_TILES)] <= act_id;
+                end
+
                 COMPUTE_TILE: begin
                     compute_cycles <= compute_cycles + 1;
                 end
                 
                 NEXT_TILE: begin
                     compute_cycles <= '0;
-                    // Advance tile counters
-                    if (tile_k < (tiles_k - TILE_COUNT_W'(1))) begin
-                        tile_k <= tile_k + 1;
-                    end else begin
+                    tile_m <= next_m;
+                    tile_n <= next_n;
+                    tile_k <= next_k;
+                    act_resident <= next_act_hit;
+                end
+                
+                STORE_RESULT: begin
+                    compute_cycles <= '0;
+                    // Next batch: its first weight tile loads while this
+                    // batch's last tile drains
+                    if (batch_advance) begin
+                        tile_m <= '0;
+                        tile_n <= '0;
                         tile_k <= '0;
-                        if (tile_n < (tiles_n - TILE_COUNT_W'(1))) begin
-                            tile_n <= tile_n + 1;
-                        end else begin
-                            tile_n <= '0;
-                            if (tile_m < (tiles_m - TILE_COUNT_W'(1))) begin
-                                tile_m <= tile_m + 1;
-                            end
+                        batch <= batch + 16'd1;
+                        batch_a_off <= batch_a_off + SRAM_ADDR_WIDTH'(batch_stride_a);
+                        batch_b_off <= batch_b_off + SRAM_ADDR_WIDTH'(batch_stride_b);
+                        batch_c_off <= batch_c_off + SRAM_ADDR_WIDTH'(batch_stride_c);
+                        // New operands (a shared B stays buffered); the
+                        // prefetched weight tile is the batch's first
+                        act_resident <= 1'b0;
+                        for (int s = 0; s < ACT_BUF_TILES; s++) act_buf_valid[s] <= 1'b0;
+                        if (batch_stride_b != '0) begin
+                            for (int s = 1; s < WGT_BUF_TILES; s++) wgt_buf_valid[s] <= 1'b0;
                         end
+                        wgt_buf_valid[0] <= 1'b1;
+                        wgt_buf_tag[0] <= '0;
                     end
                 end
-                
+
                 default: compute_cycles <= '0;
             endcase
         end
@@ -146,18 +321,146 @@ module gemm_engine #(
     assign array_size_ext = 17'(ARRAY_SIZE);
 
     assign tiles_m = TILE_COUNT_W'((dim_m_ext + array_size_ext - 17'd1) / array_size_ext);
-    assign tiles_n = TILE_COUNT_W'((dim_n_ext + array_size_ext - 17'd1) / array_size_ext);
+    assign tiles_n = int4_weights ? TILE_COUNT_W'((dim_n_ext + 2*array_size_ext - 17'd1) / (2*array_size_ext))
+                                  : TILE_COUNT_W'((dim_n_ext + array_size_ext - 17'd1) / array_size_ext);
     assign tiles_k = TILE_COUNT_W'((dim_k_ext + array_size_ext - 17'd1) / array_size_ext);
     
     // Current tile sizes (handle edge cases)
     assign tile_size_m = (tile_m == (tiles_m - TILE_COUNT_W'(1)) && dim_m % ARRAY_SIZE != 0) ? 
                          TILE_SIZE_W'(dim_m % ARRAY_SIZE) : TILE_SIZE_W'(ARRAY_SIZE);
-    assign tile_size_n = (tile_n == (tiles_n - TILE_COUNT_W'(1)) && dim_n % ARRAY_SIZE != 0) ? 
-                         TILE_SIZE_W'(dim_n % ARRAY_SIZE) : TILE_SIZE_W'(ARRAY_SIZE);
+    assign tile_width_n = int4_weights ? TILE_N_W'(2*ARRAY_SIZE) : TILE_N_W'(ARRAY_SIZE);
+    assign dim_n_rem = int4_weights ? TILE_N_W'(dim_n % (2*ARRAY_SIZE)) : TILE_N_W'(dim_n % ARRAY_SIZE);
+    assign tile_size_n = (tile_n == (tiles_n - TILE_COUNT_W'(1)) && dim_n_rem != '0) ? dim_n_rem : tile_width_n;
     assign tile_size_k = (tile_k == (tiles_k - TILE_COUNT_W'(1)) && dim_k % ARRAY_SIZE != 0) ? 
                          TILE_SIZE_W'(dim_k % ARRAY_SIZE) : TILE_SIZE_W'(ARRAY_SIZE);
 
     assign compute_limit = 16'(tile_size_m) + 16'(tile_size_k) + 16'(tile_size_n) + 16'd4;
+
+    assign last_tile = tile_m == (tiles_m - TILE_COUNT_W'(1)) &&
+                       tile_n == (tiles_n - TILE_COUNT_W'(1)) &&
+                       tile_k == (tiles_k - TILE_COUNT_W'(1));
+    assign last_batch = wgt_stream || batch_count <= 16'd1 || batch == batch_count - 16'd1;
+
+    // Loop nest. Every order ends on the same last tile (all counters at
+    // their maximum), so last_tile and STORE_RESULT (after the last K step
+    // of an output tile) are order-independent.
+    assign out_tiles = 32'(tiles_m) * 32'(tiles_n);
+    assign order = wgt_stream ? LOOP_NKM :
+                   (loop_order == LOOP_KMN && out_tiles <= 32'(ACC_BUF_TILES)) ? LOOP_KMN :
+                   (loop_order == LOOP_NMK) ? LOOP_NMK : LOOP_MNK;
+
+    always_comb begin
+        next_m = tile_m;
+        next_n = tile_n;
+        next_k = tile_k;
+        case (order)
+            LOOP_NMK: begin
+                if (tile_k < (tiles_k - TILE_COUNT_W'(1))) next_k = tile_k + 1;
+                else begin
+                    next_k = '0;
+                    if (tile_m < (tiles_m - TILE_COUNT_W'(1))) next_m = tile_m + 1;
+                    else begin
+                        next_m = '0;
+                        if (tile_n < (tiles_n - TILE_COUNT_W'(1))) next_n = tile_n + 1;
+                    end
+                end
+            end
+            LOOP_NKM: begin
+                if (tile_m < (tiles_m - TILE_COUNT_W'(1))) next_m = tile_m + 1;
+                else begin
+                    next_m = '0;
+                    if (tile_k < (tiles_k - TILE_COUNT_W'(1))) next_k = tile_k + 1;
+                    else begin
+                        next_k = '0;
+                        if (tile_n < (tiles_n - TILE_COUNT_W'(1))) next_n = tile_n + 1;
+                    end
+                end
+            end
+            LOOP_KMN: begin
+                if (tile_n < (tiles_n - TILE_COUNT_W'(1))) next_n = tile_n + 1;
+                else begin
+                    next_n = '0;
+                    if (tile_m < (tiles_m - TILE_COUNT_W'(1))) next_m = tile_m + 1;
+                    else begin
+                        next_m = '0;
+                        if (tile_k < (tiles_k - TILE_COUNT_W'(1))) next_k = tile_k + 1;
+                    end
+                end
+            end
+            default: begin
+                if (tile_k < (tiles_k - TILE_COUNT_W'(1))) next_k = tile_k + 1;
+                else begin
+                    next_k = '0;
+                    if (tile_n < (tiles_n - TILE_COUNT_W'(1))) next_n = tile_n + 1;
+                    else begin
+                        next_n = '0;
+                        if (tile_m < (tiles_m - TILE_COUNT_W'(1))) next_m = tile_m + 1;
+                    end
+                end
+            end
+        endcase
+    end
+
+    // Tile residency for the current and the next tile
+    assign act_id = 32'(tile_m) * 32'(tiles_k) + 32'(tile_k);
+    assign next_act_id = 32'(next_m) * 32'(tiles_k) + 32'(next_k);
+    assign weight_id = (order == LOOP_KMN) ? 32'(tile_k) * 32'(tiles_n) + 32'(tile_n)
+                                           : 32'(tile_n) * 32'(tiles_k) + 32'(tile_k);
+    assign next_weight_id = (order == LOOP_KMN) ? 32'(next_k) * 32'(tiles_n) + 32'(next_n)
+                                                : 32'(next_n) * 32'(tiles_k) + 32'(next_k);
+    assign next_act_hit = act_buf_valid[ACT_SLOT_W'(next_act_id % ACT_BUF_TILES)] &&
+                          act_buf_tag[ACT_SLOT_W'(next_act_id % ACT_BUF_TILES)] == next_act_id;
+    assign next_weight_hit = wgt_buf_valid[WGT_SLOT_W'(next_weight_id % WGT_BUF_TILES)] &&
+                             wgt_buf_tag[WGT_SLOT_W'(next_weight_id % WGT_BUF_TILES)] == next_weight_id;
+    assign batch_advance = state == STORE_RESULT && last_tile && !last_batch;
+
+    // Streamed B tile: tile_k rows of tile_n bytes (ceil(tile_n/2) packed
+    // INT4), each rounded up to whole beats. Every tile ID of the NKM walk
+    // is new, so the weight buffer never hits across k and always hits
+    // across m.
+    assign row_bytes = int4_weights ? TILE_N_W'((32'(tile_size_n) + 32'd1) >> 1) : tile_size_n;
+    assign row_beats = 16'((32'(row_bytes) + BEAT_BYTES - 1) / BEAT_BYTES);
+    assign wgt_fifo_pop = state == LOAD_WEIGHT_TILE && wgt_stream && wgt_fifo_valid;
+    assign wgt_row_loaded = wgt_fifo_pop && wgt_row_beat == row_beats - 16'd1;
+    assign wgt_tile_loaded = !wgt_stream || (wgt_row_loaded && wgt_row == tile_size_k - 1'b1);
+
+    // Address of C[row][col] in the current batch, from origin = dst_addr
+    // (or residual_addr for R). Row-major C uses ldc as its row stride, so
+    // a batch can write a column slice of a wider matrix. With
+    // out_block_log2 = b each 2^b-column block of C is written as its own
+    // row-major [dim_m, 2^b] buffer, blocks back to back. For a fused QKV
+    // projection (N = 3*hidden, 2^b = head_dim) this lands Q, K and V
+    // head-major: Q head 0, Q head 1, ..., V head H-1.
+    function automatic logic [31:0] out_addr(input logic [31:0] origin, input logic [31:0] row,
+                                             input logic [31:0] col);
+        logic [31:0] base;
+        logic [31:0] block_mask;
+        base = origin + 32'(batch_c_off);
+        if (out_block_log2 == '0) return base + row * 32'(ldc != '0 ? ldc : dim_n) + col;
+        block_mask = (32'd1 << out_block_log2) - 32'd1;
+        return base + (((col >> out_block_log2) * 32'(dim_m)) << out_block_log2) +
+               (row << out_block_log2) + (col & block_mask);
+    endfunction
+
+    // Tile base addresses: A is [M,K] row-major, B is [K,N] ([N,K] with
+    // transpose_b, [K, ceil(N/2)] bytes with int4_weights)
+    logic [31:0] tile_row, tile_col, tile_depth;
+    assign tile_row   = 32'(tile_m) * ARRAY_SIZE;
+    assign tile_col   = 32'(tile_n) * 32'(tile_width_n);
+    assign tile_depth = 32'(tile_k) * ARRAY_SIZE;
+
+    logic [SRAM_ADDR_WIDTH-1:0] batch_a_addr, batch_b_addr, next_batch_b_addr;
+    assign batch_a_addr = src_a_addr + batch_a_off;
+    assign batch_b_addr = src_b_addr + batch_b_off;
+    assign next_batch_b_addr = batch_b_addr + SRAM_ADDR_WIDTH'(batch_stride_b);
+
+    assign tile_a_addr = SRAM_ADDR_WIDTH'(32'(batch_a_addr) + tile_row * 32'(dim_k) + tile_depth);
+    assign tile_b_addr = int4_weights ? SRAM_ADDR_WIDTH'(32'(batch_b_addr) + tile_depth * ((32'(dim_n) + 32'd1) >> 1) +
+                                                         (tile_col >> 1))
+                       : transpose_b  ? SRAM_ADDR_WIDTH'(32'(batch_b_addr) + tile_col * 32'(dim_k) + tile_depth)
+                                      : SRAM_ADDR_WIDTH'(32'(batch_b_addr) + tile_depth * 32'(dim_n) + tile_col);
+    assign tile_c_addr = SRAM_ADDR_WIDTH'(out_addr(32'(dst_addr), tile_row, tile_col));
+    assign tile_r_addr = SRAM_ADDR_WIDTH'(out_addr(32'(residual_addr), tile_row, tile_col));
     
     // State machine combinational logic
     always_comb begin
@@ -170,8 +473,8 @@ module gemm_engine #(
             
             LOAD_WEIGHT_TILE: begin
                 // Load weights for current tile
-                // Takes tile_size_k cycles
-                next_state = LOAD_ACT_TILE;
+                // Takes tile_size_k cycles; a streamed tile, one per beat
+                if (wgt_tile_loaded) next_state = act_resident ? COMPUTE_TILE : LOAD_ACT_TILE;
             end
             
             LOAD_ACT_TILE: begin
@@ -185,25 +488,32 @@ module gemm_engine #(
                         // More K tiles to accumulate
                         next_state = NEXT_TILE;
                     end else begin
-                        // Done with accumulation, store result
-                        next_state = STORE_RESULT;
+                        // Done with accumulation, store result (after
+                        // fetching the residual tile it is added to)
+                        next_state = residual_en ? LOAD_RESID_TILE : STORE_RESULT;
                     end
                 end
             end
+
+            LOAD_RESID_TILE: begin
+                next_state = STORE_RESULT;
+            end
             
             STORE_RESULT: begin
                 // Store one row per cycle
                 // Takes tile_size_m cycles
-                next_state = NEXT_TILE;
+                // At a batch boundary the next batch's first weight tile was
+                // fetched during the store, so go straight to its activations
+                next_state = batch_advance ? LOAD_ACT_TILE : NEXT_TILE;
             end
             
             NEXT_TILE: begin
-                if (tile_m == (tiles_m - TILE_COUNT_W'(1)) &&
-                    tile_n == (tiles_n - TILE_COUNT_W'(1)) &&
-                    tile_k == (tiles_k - TILE_COUNT_W'(1))) begin
+                if (last_tile) begin
                     next_state = DONE_STATE;
-                end else begin
+                end else if (!next_weight_hit) begin
                     next_state = LOAD_WEIGHT_TILE;
+                end else begin
+                    next_state = next_act_hit ? COMPUTE_TILE : LOAD_ACT_TILE;
                 end
             end
             
@@ -230,6 +540,7 @@ module gemm_engine #(
         .load_weights(array_load_weights),
         .start_compute(array_start),
         .clear_acc(array_clear),
+        .int4_mode(int4_weights),
         .weight_in(array_weight_in),
         .weight_row(array_weight_row),
         .activation_in(array_act_in),
@@ -241,18 +552,26 @@ module gemm_engine #(
     );
     
     // TODO: Implement full tiling logic, SRAM interface, requantization
-    // This is a structural placeholder
+    // This is a structural placeholder. The address generators already walk
+    // the operand/output tiles; the enables stay low until the datapath lands.
     
-    assign sram_rd_addr = '0;
+    assign sram_rd_addr = (state == LOAD_ACT_TILE)   ? tile_a_addr :
+                          (state == LOAD_RESID_TILE) ? tile_r_addr :
+                          batch_advance              ? next_batch_b_addr : tile_b_addr;
     assign sram_rd_en = 1'b0;
-    assign sram_wr_addr = '0;
+    assign sram_wr_addr = tile_c_addr;
     assign sram_wr_data = '0;
     assign sram_wr_en = 1'b0;
     
-    assign array_load_weights = 1'b0;
-    assign array_weight_row = '0;
-    for (genvar i = 0; i < ARRAY_SIZE; i++) begin : gen_array_weight_zero
-        assign array_weight_in[i] = '0;
+    // Streamed weight rows go to the array as they complete: columns of the
+    // current beat straight from the FIFO, earlier ones from wgt_row_buf,
+    // the row's padding as zero. SRAM-sourced B tiles are not loaded yet.
+    assign array_load_weights = wgt_row_loaded;
+    assign array_weight_row = $clog2(ARRAY_SIZE)'(wgt_row);
+    for (genvar i = 0; i < ARRAY_SIZE; i++) begin : gen_array_weight_in
+        assign array_weight_in[i] = (i >= 32'(row_bytes)) ? '0 :
+                                    (i / BEAT_BYTES == 32'(wgt_row_beat)) ?
+                                        wgt_fifo_data[(i % BEAT_BYTES)*8 +: DATA_WIDTH] : wgt_row_buf[i];
     end
     assign array_start = 1'b0;
     assign array_clear = 1'b0;
@@ -1,6 +1,10 @@
 // Multiply-Accumulate Unit
 // Basic building block for systolic array
 // Performs: accumulator += activation * weight
+//
+// int4_mode: the weight register holds two signed INT4 weights (low nibble
+// for this PE's column, high nibble for the next one) and the PE does two
+// INT8 x INT4 MACs per cycle, into accumulator and accumulator_hi.
 
 `timescale 1ns/1ps
 
@@ -15,27 +19,43 @@ module mac_unit #(
     input  logic                      en,           // Enable accumulation
     input  logic                      clr,          // Clear accumulator
     input  logic                      load_weight,  // Load new weight
+    input  logic                      int4_mode,    // Two packed INT4 weights
     
     // Data inputs
     input  logic [DATA_WIDTH-1:0]     activation_in,   // From top neighbor
     input  logic [DATA_WIDTH-1:0]     weight_in,       // From load or left neighbor
     input  logic [ACC_WIDTH-1:0]      partial_sum_in,  // From left neighbor
+    input  logic [ACC_WIDTH-1:0]      partial_sum_in_hi,  // High-nibble column (int4_mode)
     
     // Data outputs
     output logic [DATA_WIDTH-1:0]     activation_out,  // To bottom neighbor
     output logic [DATA_WIDTH-1:0]     weight_out,      // To right neighbor
-    output logic [ACC_WIDTH-1:0]      partial_sum_out  // To right neighbor
+    output logic [ACC_WIDTH-1:0]      partial_sum_out, // To right neighbor
+    output logic [ACC_WIDTH-1:0]      partial_sum_out_hi
 );
 
+    localparam int HALF = DATA_WIDTH / 2;
+
     // Internal weight register (weight-stationary)
     logic [DATA_WIDTH-1:0] weight_reg;
     
-    // Accumulator
+    // Accumulators (accumulator_hi only accumulates in int4_mode)
     logic [ACC_WIDTH-1:0] accumulator;
+    logic [ACC_WIDTH-1:0] accumulator_hi;
     
     // Signed multiplication result
     logic signed [2*DATA_WIDTH-1:0] mult_result;
     logic signed [ACC_WIDTH-1:0] mult_extended;
+
+    // The multiplier is two activation x half-weight multipliers. An INT8
+    // weight is w = w[7:4] * 16 + w[3:0] with a signed high nibble and an
+    // unsigned low nibble, so a * w = (a * w[7:4] << 4) + a * w[3:0]. In
+    // int4_mode both nibbles are signed weights and each half feeds its own
+    // accumulator.
+    logic signed [HALF:0]             weight_lo;   // low nibble, sign- or zero-extended
+    logic signed [DATA_WIDTH+HALF:0]  prod_lo;
+    logic signed [DATA_WIDTH+HALF-1:0] prod_hi;
+    logic signed [ACC_WIDTH-1:0]      prod_lo_extended, prod_hi_extended;
     
     // Weight loading
     always_ff @(posedge clk or negedge rst_n) begin
@@ -48,7 +68,12 @@ module mac_unit #(
     
     // Signed multiplication
     // Both inputs treated as signed values
-    assign mult_result = $signed(activation_in) * $signed(weight_reg);
+    assign weight_lo = $signed({int4_mode & weight_reg[HALF-1], weight_reg[HALF-1:0]});
+    assign prod_lo = $signed(activation_in) * weight_lo;
+    assign prod_hi = $signed(activation_in) * $signed(weight_reg[DATA_WIDTH-1:HALF]);
+    assign mult_result = $signed({prod_hi, {HALF{1'b0}}}) + prod_lo;
+    assign prod_lo_extended = ACC_WIDTH'(prod_lo);
+    assign prod_hi_extended = ACC_WIDTH'(prod_hi);
     
     // Sign-extend to accumulator width
     assign mult_extended = {{ACC_WIDTH-(2*DATA_WIDTH){mult_result[2*DATA_WIDTH-1]}}, mult_result};
@@ -57,12 +82,19 @@ module mac_unit #(
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             accumulator <= '0;
+            accumulator_hi <= '0;
         end else if (clr) begin
             accumulator <= '0;
+            accumulator_hi <= '0;
+        end else if (en && int4_mode) begin
+            accumulator <= partial_sum_in + prod_lo_extended;
+            accumulator_hi <= partial_sum_in_hi + prod_hi_extended;
         end else if (en) begin
             accumulator <= partial_sum_in + mult_extended;
+            accumulator_hi <= partial_sum_in_hi;
         end else begin
             accumulator <= partial_sum_in;  // Pass through
+            accumulator_hi <= partial_sum_in_hi;
         end
     end
     
@@ -72,10 +104,12 @@ module mac_unit #(
             activation_out <= '0;
             weight_out     <= '0;
             partial_sum_out<= '0;
+            partial_sum_out_hi <= '0;
         end else begin
             activation_out <= activation_in;
             weight_out     <= weight_reg;
             partial_sum_out<= accumulator;
+            partial_sum_out_hi <= accumulator_hi;
         end
     end
 
@@ -6,6 +6,10 @@
 // - During COMPUTE, activation_in is expected to be skewed by row (as in testbench).
 // - Results are emitted column-by-column on result_out[row] with result_valid high
 //   for ARRAY_SIZE cycles.
+// - int4_mode: each weight byte holds two signed INT4 weights, B[k][2j] in the
+//   low nibble and B[k][2j+1] in the high nibble (mac_unit's int4_mode). Every
+//   PE does two MACs per cycle, so the array computes 2*ARRAY_SIZE output
+//   columns and result_valid stays high for 2*ARRAY_SIZE cycles.
 
 `timescale 1ns/1ps
 
@@ -21,6 +25,7 @@ module systolic_array #(
     input  logic                          load_weights,   // Load weight matrix
     input  logic                          start_compute,  // Start computation
     input  logic                          clear_acc,      // Clear accumulators
+    input  logic                          int4_mode,      // Packed INT4 weights, 2x columns
 
     // Weight loading interface (row by row)
     input  logic [DATA_WIDTH-1:0]         weight_in [0:ARRAY_SIZE-1],
@@ -49,17 +54,29 @@ module systolic_array #(
 
     state_t state;
 
-    // Weight matrix B[k][j]
+    localparam int HALF = DATA_WIDTH / 2;
+    localparam int OUT_COLS = 2 * ARRAY_SIZE;  // INT4 mode
+
+    // Weight matrix B[k][j] (two packed INT4 columns per entry in int4_mode)
     logic signed [DATA_WIDTH-1:0] weights [0:ARRAY_SIZE-1][0:ARRAY_SIZE-1];
 
-    // Accumulated output matrix C[i][j]
-    logic signed [ACC_WIDTH-1:0] accum [0:ARRAY_SIZE-1][0:ARRAY_SIZE-1];
+    // Accumulated output matrix C[i][j]; columns ARRAY_SIZE.. are only used
+    // in int4_mode
+    logic signed [ACC_WIDTH-1:0] accum [0:ARRAY_SIZE-1][0:OUT_COLS-1];
 
     // Compute timeline counter
     logic [$clog2(ARRAY_SIZE*2+4)-1:0] cycle_count;
 
     // Output column pointer while result_valid is active
-    logic [$clog2(ARRAY_SIZE)-1:0] out_col;
+    logic [$clog2(OUT_COLS)-1:0] out_col;
+    logic [$clog2(OUT_COLS)-1:0] last_col;
+    assign last_col = int4_mode ? $clog2(OUT_COLS)'(OUT_COLS-1) : $clog2(OUT_COLS)'(ARRAY_SIZE-1);
+
+    // Signed INT4 weight in the low (hi = 0) or high nibble of a weight byte
+    function automatic logic signed [DATA_WIDTH-1:0] int4_weight(input logic [DATA_WIDTH-1:0] w,
+                                                                 input logic hi);
+        return hi ? DATA_WIDTH'($signed(w[DATA_WIDTH-1:HALF])) : DATA_WIDTH'($signed(w[HALF-1:0]));
+    endfunction
 
     assign busy = (state != IDLE);
 
@@ -90,6 +107,8 @@ module systolic_array #(
             for (i = 0; i < ARRAY_SIZE; i++) begin
                 for (j = 0; j < ARRAY_SIZE; j++) begin
                     weights[i][j] <= '0;
+                end
+                for (j = 0; j < OUT_COLS; j++) begin
                     accum[i][j] <= '0;
                 end
             end
@@ -108,7 +127,7 @@ module systolic_array #(
 
                     if (clear_acc) begin
                         for (i = 0; i < ARRAY_SIZE; i++) begin
-                            for (j = 0; j < ARRAY_SIZE; j++) begin
+                            for (j = 0; j < OUT_COLS; j++) begin
                                 accum[i][j] <= '0;
                             end
                         end
@@ -118,7 +137,7 @@ module systolic_array #(
                         // Initialize per-row partial sums for tiled accumulation.
                         // Broadcast partial_sum_in[row] across all columns.
                         for (i = 0; i < ARRAY_SIZE; i++) begin
-                            for (j = 0; j < ARRAY_SIZE; j++) begin
+                            for (j = 0; j < OUT_COLS; j++) begin
                                 accum[i][j] <= $signed(partial_sum_in[i]);
                             end
                         end
@@ -135,8 +154,15 @@ module systolic_array #(
                             k_idx = c_idx - i;
                             if ((k_idx >= 0) && (k_idx < ARRAY_SIZE)) begin
                                 for (j = 0; j < ARRAY_SIZE; j++) begin
-                                    accum[i][j] <= accum[i][j] +
-                                                   $signed(activation_in[i]) * $signed(weights[k_idx][j]);
+                                    if (int4_mode) begin
+                                        accum[i][2*j] <= accum[i][2*j] +
+                                            $signed(activation_in[i]) * int4_weight(weights[k_idx][j], 1'b0);
+                                        accum[i][2*j+1] <= accum[i][2*j+1] +
+                                            $signed(activation_in[i]) * int4_weight(weights[k_idx][j], 1'b1);
+                                    end else begin
+                                        accum[i][j] <= accum[i][j] +
+                                                       $signed(activation_in[i]) * $signed(weights[k_idx][j]);
+                                    end
                                 end
                             end
                         end
@@ -153,7 +179,7 @@ module systolic_array #(
                 end
 
                 OUTPUT: begin
-                    if (out_col == $clog2(ARRAY_SIZE)'(ARRAY_SIZE-1)) begin
+                    if (out_col == last_col) begin
                         state <= IDLE;
                         out_col <= '0;
                     end else begin
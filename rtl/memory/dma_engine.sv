@@ -1,6 +1,11 @@
 // DMA Engine
 // Transfers data between external DDR and on-chip SRAM
 // Supports burst transfers for efficient weight loading
+// With stream set, a DDR read bypasses SRAM: every read beat is handed to
+// the GEMM weight FIFO as is, and RREADY follows stream_ready, so a full
+// FIFO stalls the AXI read channel. A stream moves whole beats, so
+// byte_count is rounded up to a multiple of 8 at start; a zero-byte stream
+// finishes without touching AXI.
 
 `timescale 1ns/1ps
 
@@ -21,6 +26,7 @@ module dma_engine #(
     input  logic [ADDR_WIDTH-1:0]     ddr_addr,
     input  logic [SRAM_ADDR_WIDTH-1:0] sram_addr,
     input  logic [31:0]               byte_count,    // Total bytes to transfer
+    input  logic                      stream,        // DDR -> weight stream (direction 0)
     
     // AXI4 Read Address Channel
     output logic [ADDR_WIDTH-1:0]     m_axi_araddr,
@@ -62,7 +68,12 @@ module dma_engine #(
     output logic [DATA_WIDTH-1:0]      sram_wdata,
     output logic                       sram_we,
     output logic                       sram_re,
-    input  logic [DATA_WIDTH-1:0]      sram_rdata
+    input  logic [DATA_WIDTH-1:0]      sram_rdata,
+
+    // Weight stream (DMA_STREAM beats, to weight_fifo)
+    output logic                       stream_valid,
+    input  logic                       stream_ready,
+    output logic [63:0]                stream_data
 );
 
     // State machine
@@ -83,7 +94,9 @@ module dma_engine #(
         DONE_STATE
     } state_t;
     
-    state_t state, next_state;
+    // state is public so benchmarks can break transfers down by phase
+    state_t state /*verilator public_flat_rd*/;
+    state_t next_state;
     
     // Transfer counters
     logic [31:0] bytes_remaining;
@@ -93,7 +106,12 @@ module dma_engine #(
     // Burst counter
     logic [7:0] burst_count;
     logic [7:0] current_burst_len;
+    logic stream_mode;
     
+    // A stream start: DDR -> weight FIFO
+    logic stream_start;
+    assign stream_start = stream && direction == 1'b0;
+
     // Read buffer
     logic [63:0] read_buffer;
     logic [2:0] read_buffer_valid_bytes;
@@ -116,16 +134,19 @@ module dma_engine #(
             current_sram_addr <= '0;
             current_ddr_addr <= '0;
             burst_count <= '0;
+            stream_mode <= 1'b0;
         end else begin
             state <= next_state;
             
             case (state)
                 IDLE: begin
                     if (start) begin
-                        bytes_remaining <= byte_count;
+                        bytes_remaining <= stream_start ? {byte_count[31:3] + 29'(|byte_count[2:0]), 3'b000}
+                                                        : byte_count;
                         current_sram_addr <= sram_addr;
                         current_ddr_addr <= ddr_addr;
                         burst_count <= '0;
+                        stream_mode <= stream_start;
                     end
                 end
                 
@@ -139,6 +160,13 @@ module dma_engine #(
                     if (m_axi_rvalid && m_axi_rready) begin
                         read_buffer <= m_axi_rdata;
                         // For 64-bit data, we can extract bytes as needed
+                        if (stream_mode) begin
+                            // The beat went to the weight FIFO
+                            bytes_remaining <= (bytes_remaining > 32'd8) ? bytes_remaining - 32'd8 : '0;
+                            if (m_axi_rlast) begin
+                                current_ddr_addr <= current_ddr_addr + ((ADDR_WIDTH'(current_burst_len) + ADDR_WIDTH'(1)) * ADDR_WIDTH'(8));
+                            end
+                        end
                     end
                 end
                 
@@ -181,7 +209,9 @@ module dma_engine #(
         case (state)
             IDLE: begin
                 if (start) begin
-                    if (direction == 1'b0) begin
+                    if (stream_start && byte_count == '0) begin
+                        next_state = DONE_STATE;
+                    end else if (direction == 1'b0) begin
                         next_state = RD_ADDR;
                     end else begin
                         next_state = WR_ADDR;
@@ -198,7 +228,13 @@ module dma_engine #(
             RD_DATA: begin
                 if (m_axi_rvalid && m_axi_rready) begin
                     if (m_axi_rlast) begin
-                        next_state = RD_WRITE_SRAM;
+                        if (!stream_mode) begin
+                            next_state = RD_WRITE_SRAM;
+                        end else if (bytes_remaining <= 32'd8) begin
+                            next_state = DONE_STATE;
+                        end else begin
+                            next_state = RD_ADDR;
+                        end
                     end
                 end
             end
@@ -258,7 +294,7 @@ module dma_engine #(
     assign m_axi_arvalid = (state == RD_ADDR);
     
     // AXI Read Data Channel
-    assign m_axi_rready = (state == RD_DATA);
+    assign m_axi_rready = (state == RD_DATA) && (!stream_mode || stream_ready);
     
     // AXI Write Address Channel
     assign m_axi_awaddr = current_ddr_addr;
@@ -282,6 +318,10 @@ module dma_engine #(
     assign sram_we = (state == RD_WRITE_SRAM);
     assign sram_re = (state == WR_READ_SRAM);
     
+    // Weight stream
+    assign stream_valid = (state == RD_DATA) && stream_mode && m_axi_rvalid;
+    assign stream_data = m_axi_rdata;
+    
     // Status
     assign busy = (state != IDLE);
     assign done = (state == DONE_STATE);
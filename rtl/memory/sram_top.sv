@@ -1,5 +1,5 @@
 // Dual-Port SRAM for NPU
-// Two independent banks: SRAM0 (64KB main) and SRAM1 (8KB auxiliary)
+// Two independent memories: SRAM0 (main, 64KB banks) and SRAM1 (8KB auxiliary)
 
 `timescale 1ns/1ps
 
@@ -7,27 +7,29 @@ module sram_bank #(
     parameter DATA_WIDTH = 8,
     parameter ADDR_WIDTH = 16,
     parameter SIZE = 65536,  // 64KB default
-    parameter INIT_FILE = ""
+    parameter INIT_FILE = "",
+    parameter LANES = 1      // Consecutive words per port access
 )(
     input  logic                      clk,
     
-    // Port A (read/write)
+    // Port A (read/write); lane l is word addr_a + l
     input  logic [ADDR_WIDTH-1:0]     addr_a,
-    input  logic [DATA_WIDTH-1:0]     wdata_a,
-    output logic [DATA_WIDTH-1:0]     rdata_a,
+    input  logic [LANES*DATA_WIDTH-1:0] wdata_a,
+    output logic [LANES*DATA_WIDTH-1:0] rdata_a,
+    input  logic [LANES-1:0]          wmask_a,   // Per-lane write enable
     input  logic                      we_a,      // Write enable
     input  logic                      re_a,      // Read enable
     
     // Port B (read only)
     input  logic [ADDR_WIDTH-1:0]     addr_b,
-    output logic [DATA_WIDTH-1:0]     rdata_b,
+    output logic [LANES*DATA_WIDTH-1:0] rdata_b,
     input  logic                      re_b
 );
 
     localparam int INDEX_WIDTH = $clog2(SIZE);
 
-    // Memory array
-    logic [DATA_WIDTH-1:0] mem [0:SIZE-1];
+    // Memory array (public so harnesses can backdoor-load microcode)
+    logic [DATA_WIDTH-1:0] mem [0:SIZE-1] /*verilator public_flat_rw*/;
     
     initial begin
         if (INIT_FILE != "") begin
@@ -37,18 +39,22 @@ module sram_bank #(
     
     // Port A operation
     always_ff @(posedge clk) begin
-        if (we_a) begin
-            mem[addr_a[INDEX_WIDTH-1:0]] <= wdata_a;
-        end
-        if (re_a) begin
-            rdata_a <= mem[addr_a[INDEX_WIDTH-1:0]];
+        for (int l = 0; l < LANES; l++) begin
+            if (we_a && wmask_a[l]) begin
+                mem[INDEX_WIDTH'(addr_a + l)] <= wdata_a[l*DATA_WIDTH +: DATA_WIDTH];
+            end
+            if (re_a) begin
+                rdata_a[l*DATA_WIDTH +: DATA_WIDTH] <= mem[INDEX_WIDTH'(addr_a + l)];
+            end
         end
     end
     
     // Port B operation (read only)
     always_ff @(posedge clk) begin
-        if (re_b) begin
-            rdata_b <= mem[addr_b[INDEX_WIDTH-1:0]];
+        for (int l = 0; l < LANES; l++) begin
+            if (re_b) begin
+                rdata_b[l*DATA_WIDTH +: DATA_WIDTH] <= mem[INDEX_WIDTH'(addr_b + l)];
+            end
         end
     end
 
@@ -58,6 +64,9 @@ endmodule
 // SRAM Top Level - Both banks with arbitration
 module sram_top #(
     parameter DATA_WIDTH = 8,
+    parameter LN_LANES = 1,  // LayerNorm port width in bytes (SRAM0 lanes)
+    parameter SRAM0_SIZE = 65536,  // Whole 64KB banks
+    parameter ADDR_WIDTH = $clog2(SRAM0_SIZE),
     parameter SRAM0_INIT_FILE = "sram0_init.hex",
     parameter SRAM1_INIT_FILE = "sram1_init.hex"
 )(
@@ -68,10 +77,10 @@ module sram_top #(
     // Each engine can request read/write access
     
     // GEMM engine
-    input  logic [15:0]               gemm_rd_addr,
+    input  logic [ADDR_WIDTH-1:0]     gemm_rd_addr,
     output logic [DATA_WIDTH-1:0]     gemm_rd_data,
     input  logic                      gemm_rd_en,
-    input  logic [15:0]               gemm_wr_addr,
+    input  logic [ADDR_WIDTH-1:0]     gemm_wr_addr,
     input  logic [DATA_WIDTH-1:0]     gemm_wr_data,
     input  logic                      gemm_wr_en,
     
@@ -80,15 +89,19 @@ module sram_top #(
     output logic [DATA_WIDTH-1:0]     softmax_rd_data,
     input  logic                      softmax_rd_en,
     
-    // LayerNorm engine
-    input  logic [15:0]               layernorm_rd_addr,
-    output logic [DATA_WIDTH-1:0]     layernorm_rd_data,
+    // LayerNorm engine (port A granted below DMA/GEMM; gamma/beta on port B).
+    // Each access covers LN_LANES consecutive bytes.
+    input  logic [ADDR_WIDTH-1:0]     layernorm_rd_addr,
+    output logic [LN_LANES*DATA_WIDTH-1:0] layernorm_rd_data,
     input  logic                      layernorm_rd_en,
-    input  logic [15:0]               layernorm_wr_addr,
-    input  logic [DATA_WIDTH-1:0]     layernorm_wr_data,
+    output logic                      layernorm_rd_gnt,
+    input  logic [ADDR_WIDTH-1:0]     layernorm_wr_addr,
+    input  logic [LN_LANES*DATA_WIDTH-1:0] layernorm_wr_data,
+    input  logic [LN_LANES-1:0]       layernorm_wr_mask,
     input  logic                      layernorm_wr_en,
-    input  logic [15:0]               layernorm_rd_addr_b,  // For beta/gamma
-    output logic [DATA_WIDTH-1:0]     layernorm_rd_data_b,
+    output logic                      layernorm_wr_gnt,
+    input  logic [ADDR_WIDTH-1:0]     layernorm_rd_addr_b,  // For beta/gamma
+    output logic [LN_LANES*DATA_WIDTH-1:0] layernorm_rd_data_b,
     input  logic                      layernorm_rd_en_b,
     
     // GELU engine
@@ -111,28 +124,36 @@ module sram_top #(
     input  logic                      vec_wr_en,
     
     // DMA engine
-    input  logic [15:0]               dma_rd_addr,
+    input  logic [ADDR_WIDTH-1:0]     dma_rd_addr,
     output logic [DATA_WIDTH-1:0]     dma_rd_data,
     input  logic                      dma_rd_en,
-    input  logic [15:0]               dma_wr_addr,
+    input  logic [ADDR_WIDTH-1:0]     dma_wr_addr,
     input  logic [DATA_WIDTH-1:0]     dma_wr_data,
     input  logic                      dma_wr_en,
     
-    // Microcode storage (read only by controller)
+    // Activation LUT loader (lowest priority; gnt says the read was taken)
+    input  logic [ADDR_WIDTH-1:0]     lut_rd_addr,
+    output logic [DATA_WIDTH-1:0]     lut_rd_data,
+    input  logic                      lut_rd_en,
+    output logic                      lut_rd_gnt,
+    
+    // Microcode storage (read only by controller, bank 0)
     input  logic [15:0]               ucode_rd_addr,
     output logic [127:0]              ucode_rd_data,  // 128-bit instructions
     input  logic                      ucode_rd_en
 );
 
     // Priority arbiter
-    // SRAM0 (64KB) - Main workspace
+    // SRAM0 (SRAM0_SIZE) - Main workspace
     // Port A: Writes (DMA > GEMM > Softmax > LN > GELU > Vec) + Reads (DMA > GEMM > ...)
     // Port B: UCODE Read (High priority dedicated or shared?)
     
     // SRAM0 Port A signals
-    logic [15:0] sram0_addr_a;
-    logic [7:0] sram0_wdata_a;
-    logic [7:0] sram0_rdata_a;
+    // Port A is LN_LANES bytes wide; byte-wide requesters use lane 0
+    logic [ADDR_WIDTH-1:0] sram0_addr_a;
+    logic [LN_LANES*DATA_WIDTH-1:0] sram0_wdata_a;
+    logic [LN_LANES*DATA_WIDTH-1:0] sram0_rdata_a;
+    logic [LN_LANES-1:0] sram0_wmask_a;
     logic sram0_we_a;
     logic sram0_re_a;
     
@@ -174,36 +195,55 @@ module sram_top #(
     always_comb begin
         sram0_addr_a = '0;
         sram0_wdata_a = '0;
+        sram0_wmask_a = LN_LANES'(1);
         sram0_we_a = 0;
         sram0_re_a = 0;
         
         // Priority: DMA > GEMM > Engines
         if (dma_wr_en) begin
             sram0_addr_a = dma_wr_addr;
-            sram0_wdata_a = dma_wr_data;
+            sram0_wdata_a[DATA_WIDTH-1:0] = dma_wr_data;
             sram0_we_a = 1;
         end else if (dma_rd_en) begin
             sram0_addr_a = dma_rd_addr;
             sram0_re_a = 1;
         end else if (gemm_wr_en) begin
             sram0_addr_a = gemm_wr_addr;
-            sram0_wdata_a = gemm_wr_data;
+            sram0_wdata_a[DATA_WIDTH-1:0] = gemm_wr_data;
             sram0_we_a = 1;
         end else if (gemm_rd_en) begin
             sram0_addr_a = gemm_rd_addr;
             sram0_re_a = 1;
+        end else if (layernorm_wr_en) begin
+            sram0_addr_a = layernorm_wr_addr;
+            sram0_wdata_a = layernorm_wr_data;
+            sram0_wmask_a = layernorm_wr_mask;
+            sram0_we_a = 1;
+        end else if (layernorm_rd_en) begin
+            sram0_addr_a = layernorm_rd_addr;
+            sram0_re_a = 1;
+        end else if (lut_rd_en) begin
+            sram0_addr_a = lut_rd_addr;
+            sram0_re_a = 1;
         end
         // ... add others
     end
     
+    assign layernorm_wr_gnt = layernorm_wr_en && !(dma_wr_en || dma_rd_en || gemm_wr_en || gemm_rd_en);
+    assign layernorm_rd_gnt = layernorm_rd_en && !(dma_wr_en || dma_rd_en || gemm_wr_en || gemm_rd_en ||
+                                                   layernorm_wr_en);
+    assign lut_rd_gnt = lut_rd_en && !(dma_wr_en || dma_rd_en || gemm_wr_en || gemm_rd_en ||
+                                       layernorm_wr_en || layernorm_rd_en);
+    
     // Read data distribution
-    assign dma_rd_data = (dma_rd_en) ? sram0_rdata_a : '0;
-    assign gemm_rd_data = (gemm_rd_en) ? sram0_rdata_a : '0;
+    assign dma_rd_data = (dma_rd_en) ? sram0_rdata_a[DATA_WIDTH-1:0] : '0;
+    assign gemm_rd_data = (gemm_rd_en) ? sram0_rdata_a[DATA_WIDTH-1:0] : '0;
+    assign lut_rd_data = sram0_rdata_a[DATA_WIDTH-1:0];  // registered: valid the cycle after lut_rd_gnt
+    assign layernorm_rd_data = sram0_rdata_a;  // registered, like lut_rd_data
+    assign layernorm_rd_data_b = sram0_rdata_b;
 
     // Unimplemented engine paths are tied off for deterministic top-level wiring
     assign softmax_rd_data = '0;
-    assign layernorm_rd_data = '0;
-    assign layernorm_rd_data_b = '0;
     assign gelu_rd_data = '0;
     assign vec_rd_data = '0;
     assign vec_rd_data_b = '0;
@@ -212,29 +252,89 @@ module sram_top #(
     // We will cheat slightly and read 16 consecutive bytes in one cycle
     // to satisfy the 128-bit instruction width requirement without changing controller.
     logic [15:0] ucode_addr_b;
-    logic [DATA_WIDTH-1:0] sram0_rdata_b_unused;
+    logic [ADDR_WIDTH-1:0] sram0_addr_b;
+    logic sram0_re_b;
+    logic [LN_LANES*DATA_WIDTH-1:0] sram0_rdata_b;
     logic [DATA_WIDTH-1:0] sram1_rdata_a_unused;
     logic [DATA_WIDTH-1:0] sram1_rdata_b_unused;
     assign ucode_addr_b = ucode_rd_addr;
     
-    // Instantiate SRAM0
+    // The wide UCODE read below bypasses port B, so its scalar read
+    // serves LayerNorm gamma/beta
+    assign sram0_addr_b = layernorm_rd_en_b ? layernorm_rd_addr_b : ADDR_WIDTH'(ucode_addr_b);
+    assign sram0_re_b = layernorm_rd_en_b || ucode_rd_en;
+
+    // SRAM0 banks: 64KB each, picked by address bits 16 and up. Bank 0
+    // keeps the sram0 instance (microcode lives there, and harnesses
+    // backdoor-load it); the rest are sram0_hi[1..]. Each port drives one
+    // bank per access, and read data comes back from the bank registered
+    // with the read.
+    localparam int BANK_BYTES = 65536;
+    localparam int SRAM0_BANKS = (SRAM0_SIZE + BANK_BYTES - 1) / BANK_BYTES;
+    localparam int BANK_SEL_WIDTH = (SRAM0_BANKS > 1) ? $clog2(SRAM0_BANKS) : 1;
+
+    function automatic logic [BANK_SEL_WIDTH-1:0] bank_of(input logic [ADDR_WIDTH-1:0] addr);
+        return BANK_SEL_WIDTH'(32'(addr) >> 16);
+    endfunction
+
+    logic [BANK_SEL_WIDTH-1:0] bank_a, bank_b, bank_a_q, bank_b_q;
+    logic [LN_LANES*DATA_WIDTH-1:0] bank_rdata_a [SRAM0_BANKS];
+    logic [LN_LANES*DATA_WIDTH-1:0] bank_rdata_b [SRAM0_BANKS];
+
+    assign bank_a = bank_of(sram0_addr_a);
+    assign bank_b = bank_of(sram0_addr_b);
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            bank_a_q <= '0;
+            bank_b_q <= '0;
+        end else begin
+            if (sram0_re_a) bank_a_q <= bank_a;
+            if (sram0_re_b) bank_b_q <= bank_b;
+        end
+    end
+
+    assign sram0_rdata_a = bank_rdata_a[bank_a_q];
+    assign sram0_rdata_b = bank_rdata_b[bank_b_q];
+
     sram_bank #(
         .DATA_WIDTH(DATA_WIDTH),
         .ADDR_WIDTH(16),
-        .SIZE(65536),
-        .INIT_FILE(SRAM0_INIT_FILE)
+        .SIZE(BANK_BYTES),
+        .INIT_FILE(SRAM0_INIT_FILE),
+        .LANES(LN_LANES)
     ) sram0 (
         .clk(clk),
-        .addr_a(sram0_addr_a),
+        .addr_a(sram0_addr_a[15:0]),
         .wdata_a(sram0_wdata_a),
-        .rdata_a(sram0_rdata_a),
-        .we_a(sram0_we_a),
-        .re_a(sram0_re_a),
-        
-        .addr_b(ucode_addr_b),
-        .rdata_b(sram0_rdata_b_unused), // Port B scalar read is unused; wide-read path used below
-        .re_b(ucode_rd_en)
+        .rdata_a(bank_rdata_a[0]),
+        .wmask_a(sram0_wmask_a),
+        .we_a(sram0_we_a && bank_a == '0),
+        .re_a(sram0_re_a && bank_a == '0),
+        .addr_b(sram0_addr_b[15:0]),
+        .rdata_b(bank_rdata_b[0]),
+        .re_b(sram0_re_b && bank_b == '0)
     );
+
+    for (genvar b = 1; b < SRAM0_BANKS; b++) begin : sram0_hi
+        sram_bank #(
+            .DATA_WIDTH(DATA_WIDTH),
+            .ADDR_WIDTH(16),
+            .SIZE(BANK_BYTES),
+            .LANES(LN_LANES)
+        ) bank (
+            .clk(clk),
+            .addr_a(sram0_addr_a[15:0]),
+            .wdata_a(sram0_wdata_a),
+            .rdata_a(bank_rdata_a[b]),
+            .wmask_a(sram0_wmask_a),
+            .we_a(sram0_we_a && bank_a == BANK_SEL_WIDTH'(b)),
+            .re_a(sram0_re_a && bank_a == BANK_SEL_WIDTH'(b)),
+            .addr_b(sram0_addr_b[15:0]),
+            .rdata_b(bank_rdata_b[b]),
+            .re_b(sram0_re_b && bank_b == BANK_SEL_WIDTH'(b))
+        );
+    end
     
     // Wide read for UCODE
     // Only valid if sram_bank exposes mem, or we do it inside sram_bank.
@@ -256,16 +356,8 @@ module sram_top #(
     logic unused_sram_inputs;
     assign unused_sram_inputs = &{
         1'b0,
-        rst_n,
         softmax_rd_addr,
         softmax_rd_en,
-        layernorm_rd_addr,
-        layernorm_rd_en,
-        layernorm_wr_addr,
-        layernorm_wr_data,
-        layernorm_wr_en,
-        layernorm_rd_addr_b,
-        layernorm_rd_en_b,
         gelu_rd_addr,
         gelu_rd_en,
         gelu_wr_addr,
@@ -278,7 +370,6 @@ module sram_top #(
         vec_wr_addr,
         vec_wr_data,
         vec_wr_en,
-        sram0_rdata_b_unused,
         sram1_rdata_a_unused,
         sram1_rdata_b_unused
     };
@@ -291,7 +382,7 @@ module sram_top #(
         .INIT_FILE(SRAM1_INIT_FILE)
     ) sram1 (
         .clk(clk),
-        .addr_a('0), .wdata_a('0), .rdata_a(sram1_rdata_a_unused), .we_a(0), .re_a(0),
+        .addr_a('0), .wdata_a('0), .rdata_a(sram1_rdata_a_unused), .wmask_a('1), .we_a(0), .re_a(0),
         .addr_b('0), .rdata_b(sram1_rdata_b_unused), .re_b(0)
     );
 
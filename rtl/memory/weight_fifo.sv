@@ -0,0 +1,56 @@
+// Weight Stream FIFO
+// Carries DMA_STREAM read beats from dma_engine to the GEMM weight loader
+// without going through SRAM0. First-word fall-through: rd_data is the
+// oldest beat whenever rd_valid is set. wr_ready drops when the FIFO is
+// full, which dma_engine turns into RREADY backpressure on the AXI master.
+
+`timescale 1ns/1ps
+
+module weight_fifo #(
+    parameter WIDTH = 64,   // one AXI read beat
+    parameter DEPTH = 16    // beats; a power of two
+)(
+    input  logic             clk,
+    input  logic             rst_n,
+
+    // Write side (dma_engine)
+    input  logic             wr_valid,
+    output logic             wr_ready,
+    input  logic [WIDTH-1:0] wr_data,
+
+    // Read side (gemm_engine)
+    output logic             rd_valid,
+    input  logic             rd_pop,
+    output logic [WIDTH-1:0] rd_data
+);
+
+    localparam int PTR_W = $clog2(DEPTH);
+
+    logic [WIDTH-1:0] mem [0:DEPTH-1];
+    logic [PTR_W-1:0] wr_ptr, rd_ptr;
+    logic [PTR_W:0]   count;
+    logic push, pop;
+
+    assign wr_ready = count != (PTR_W+1)'(DEPTH);
+    assign rd_valid = count != '0;
+    assign rd_data = mem[rd_ptr];
+    assign push = wr_valid && wr_ready;
+    assign pop = rd_pop && rd_valid;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wr_ptr <= '0;
+            rd_ptr <= '0;
+            count <= '0;
+        end else begin
+            if (push) wr_ptr <= wr_ptr + 1'b1;
+            if (pop) rd_ptr <= rd_ptr + 1'b1;
+            count <= count + (PTR_W+1)'(push) - (PTR_W+1)'(pop);
+        end
+    end
+
+    always_ff @(posedge clk) begin
+        if (push) mem[wr_ptr] <= wr_data;
+    end
+
+endmodule
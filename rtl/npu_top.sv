@@ -7,8 +7,13 @@ module npu_top #(
     parameter DATA_WIDTH = 8,
     parameter ACC_WIDTH = 32,
     parameter ARRAY_SIZE = 16,
-    parameter SRAM0_SIZE = 65536,  // 64KB
-    parameter SRAM1_SIZE = 8192     // 8KB
+    parameter SRAM0_SIZE = 65536,  // 64KB banks, up to 1MB (see SRAM_BASE)
+    parameter SRAM1_SIZE = 8192,    // 8KB
+    parameter DMA_BURST_LEN = 16,   // AXI beats per DMA burst
+    parameter LN_LANES = 1,         // LayerNorm bytes per SRAM0 access
+    parameter LN_PARAM_SLOTS = 8,   // Cached LayerNorm gamma/beta sets
+    parameter LN_PARAM_DIM = 256,   // Longest cached LayerNorm row
+    parameter WGT_FIFO_DEPTH = 16   // DMA_STREAM -> GEMM weight FIFO (8-byte beats)
 )(
     input  logic        clk,
     input  logic        rst_n,
@@ -64,6 +69,9 @@ module npu_top #(
     output logic        done
 );
 
+    // Engine operand addresses span all of SRAM0
+    localparam int SRAM_ADDR_WIDTH = $clog2(SRAM0_SIZE);
+
     // Internal signals
     
     // Control registers
@@ -89,13 +97,23 @@ module npu_top #(
     
     // Engine configuration signals
     logic [15:0] gemm_dim_m, gemm_dim_k, gemm_dim_n;
-    logic gemm_transpose_b, gemm_accumulate, gemm_requant;
+    logic gemm_transpose_b, gemm_accumulate, gemm_requant, gemm_int4;
     logic [15:0] gemm_imm;
+    logic [SRAM_ADDR_WIDTH-1:0] gemm_src_a, gemm_src_b, gemm_dst;
+    logic [3:0] gemm_out_block;
+    logic [15:0] gemm_batch_count, gemm_stride_a, gemm_stride_b, gemm_stride_c, gemm_ldc;
+    logic [1:0] gemm_loop_order;
+    logic gemm_wgt_stream;
+    logic gemm_residual_en;
+    logic [SRAM_ADDR_WIDTH-1:0] gemm_residual;
     
     logic softmax_causal;
+    logic [15:0] softmax_window, softmax_row_offset;
     logic [15:0] softmax_m, softmax_n;
     
-    logic [15:0] layernorm_dim;
+    logic [15:0] layernorm_dim, layernorm_rows;
+    logic [SRAM_ADDR_WIDTH-1:0] layernorm_src, layernorm_dst, layernorm_param;
+    logic layernorm_reload;
     logic [15:0] gelu_count;
     
     logic [2:0] vec_op;
@@ -104,13 +122,31 @@ module npu_top #(
     
     logic dma_direction;
     logic [31:0] dma_byte_count;
+    logic [31:0] dma_ddr_offset;
+    logic [SRAM_ADDR_WIDTH-1:0] dma_sram_addr;
+    logic dma_stream;
+    
+    // Weight stream: DMA_STREAM beats into the FIFO, GEMM_STREAM pops them
+    logic wgt_fifo_wr_valid, wgt_fifo_wr_ready;
+    logic [63:0] wgt_fifo_wr_data;
+    logic wgt_fifo_rd_valid, wgt_fifo_pop;
+    logic [63:0] wgt_fifo_rd_data;
+    
+    // Activation LUT load
+    logic lut_load_start, lut_load_busy, lut_load_done;
+    logic lut_load_table;
+    logic [SRAM_ADDR_WIDTH-1:0] lut_load_addr;
+    logic gelu_lut_wr_en, exp_lut_wr_en;
+    logic [7:0] gelu_lut_wr_addr, exp_lut_wr_addr;
+    logic [DATA_WIDTH-1:0] gelu_lut_wr_data;
+    logic [15:0] exp_lut_wr_data;
     
     // SRAM interfaces
     // GEMM
-    logic [15:0] gemm_rd_addr;
+    logic [SRAM_ADDR_WIDTH-1:0] gemm_rd_addr;
     logic [DATA_WIDTH-1:0] gemm_rd_data;
     logic gemm_rd_en;
-    logic [15:0] gemm_wr_addr;
+    logic [SRAM_ADDR_WIDTH-1:0] gemm_wr_addr;
     logic [DATA_WIDTH-1:0] gemm_wr_data;
     logic gemm_wr_en;
     
@@ -120,14 +156,17 @@ module npu_top #(
     logic softmax_rd_en;
     
     // LayerNorm
-    logic [15:0] layernorm_rd_addr;
-    logic [DATA_WIDTH-1:0] layernorm_rd_data;
+    logic [SRAM_ADDR_WIDTH-1:0] layernorm_rd_addr;
+    logic [LN_LANES*DATA_WIDTH-1:0] layernorm_rd_data;
     logic layernorm_rd_en;
-    logic [15:0] layernorm_wr_addr;
-    logic [DATA_WIDTH-1:0] layernorm_wr_data;
+    logic layernorm_rd_gnt;
+    logic [SRAM_ADDR_WIDTH-1:0] layernorm_wr_addr;
+    logic [LN_LANES*DATA_WIDTH-1:0] layernorm_wr_data;
+    logic [LN_LANES-1:0] layernorm_wr_mask;
     logic layernorm_wr_en;
-    logic [15:0] layernorm_rd_addr_b;
-    logic [DATA_WIDTH-1:0] layernorm_rd_data_b;
+    logic layernorm_wr_gnt;
+    logic [SRAM_ADDR_WIDTH-1:0] layernorm_rd_addr_b;
+    logic [LN_LANES*DATA_WIDTH-1:0] layernorm_rd_data_b;
     logic layernorm_rd_en_b;
     
     // GELU
@@ -150,13 +189,19 @@ module npu_top #(
     logic vec_wr_en;
     
     // DMA
-    logic [15:0] dma_rd_addr;
+    logic [SRAM_ADDR_WIDTH-1:0] dma_rd_addr;
     logic [DATA_WIDTH-1:0] dma_rd_data;
     logic dma_rd_en;
-    logic [15:0] dma_wr_addr;
+    logic [SRAM_ADDR_WIDTH-1:0] dma_wr_addr;
     logic [DATA_WIDTH-1:0] dma_wr_data;
     logic dma_wr_en;
     
+    // LUT loader
+    logic [SRAM_ADDR_WIDTH-1:0] lut_rd_addr;
+    logic [DATA_WIDTH-1:0] lut_rd_data;
+    logic lut_rd_en;
+    logic lut_rd_gnt;
+    
     // Microcode
     logic [15:0] ucode_rd_addr;
     logic [127:0] ucode_rd_data;
@@ -172,13 +217,6 @@ module npu_top #(
     // Tie-offs for currently unimplemented engine SRAM ports to avoid dead/undriven wiring
     assign softmax_rd_addr   = '0;
     assign softmax_rd_en     = 1'b0;
-    assign layernorm_rd_addr = '0;
-    assign layernorm_rd_en   = 1'b0;
-    assign layernorm_wr_addr = '0;
-    assign layernorm_wr_data = '0;
-    assign layernorm_wr_en   = 1'b0;
-    assign layernorm_rd_addr_b = '0;
-    assign layernorm_rd_en_b = 1'b0;
     assign gelu_rd_addr      = '0;
     assign gelu_rd_en        = 1'b0;
     assign gelu_wr_addr      = '0;
@@ -238,7 +276,10 @@ module npu_top #(
     // ========================================================================
     // Microcode Controller
     // ========================================================================
-    microcode_controller #(.DATA_WIDTH(DATA_WIDTH)) controller (
+    microcode_controller #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .SRAM_ADDR_WIDTH(SRAM_ADDR_WIDTH)
+    ) controller (
         .clk(clk),
         .rst_n(rst_n),
         .start(start_pulse),
@@ -256,19 +297,40 @@ module npu_top #(
         .gemm_dim_k(gemm_dim_k),
         .gemm_dim_n(gemm_dim_n),
         .gemm_transpose_b(gemm_transpose_b),
+        .gemm_int4(gemm_int4),
         .gemm_accumulate(gemm_accumulate),
         .gemm_requant(gemm_requant),
         .gemm_imm(gemm_imm),
+        .gemm_src_a(gemm_src_a),
+        .gemm_src_b(gemm_src_b),
+        .gemm_dst(gemm_dst),
+        .gemm_out_block(gemm_out_block),
+        .gemm_batch_count(gemm_batch_count),
+        .gemm_stride_a(gemm_stride_a),
+        .gemm_stride_b(gemm_stride_b),
+        .gemm_stride_c(gemm_stride_c),
+        .gemm_ldc(gemm_ldc),
+        .gemm_loop_order(gemm_loop_order),
+        .gemm_wgt_stream(gemm_wgt_stream),
+        .gemm_residual_en(gemm_residual_en),
+        .gemm_residual(gemm_residual),
         
         .softmax_start(softmax_start),
         .softmax_busy(softmax_busy),
         .softmax_m(softmax_m),
         .softmax_n(softmax_n),
         .softmax_causal(softmax_causal),
+        .softmax_window(softmax_window),
+        .softmax_row_offset(softmax_row_offset),
         
         .layernorm_start(layernorm_start),
         .layernorm_busy(layernorm_busy),
         .layernorm_dim(layernorm_dim),
+        .layernorm_rows(layernorm_rows),
+        .layernorm_src(layernorm_src),
+        .layernorm_dst(layernorm_dst),
+        .layernorm_param(layernorm_param),
+        .layernorm_reload(layernorm_reload),
         
         .gelu_start(gelu_start),
         .gelu_busy(gelu_busy),
@@ -284,6 +346,13 @@ module npu_top #(
         .dma_busy(dma_busy),
         .dma_direction(dma_direction),
         .dma_byte_count(dma_byte_count),
+        .dma_ddr_offset(dma_ddr_offset),
+        .dma_sram_addr(dma_sram_addr),
+        .dma_stream(dma_stream),
+        
+        .lut_load_start(lut_load_start),
+        .lut_load_table(lut_load_table),
+        .lut_load_addr(lut_load_addr),
         
         .barrier_wait(barrier_wait_unused),
         .all_engines_idle(!gemm_busy && !softmax_busy && !layernorm_busy && 
@@ -293,7 +362,11 @@ module npu_top #(
     // ========================================================================
     // SRAM Top
     // ========================================================================
-    sram_top #(.DATA_WIDTH(DATA_WIDTH)) sram (
+    sram_top #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .LN_LANES(LN_LANES),
+        .SRAM0_SIZE(SRAM0_SIZE)
+    ) sram (
         .clk(clk),
         .rst_n(rst_n),
         .gemm_rd_addr(gemm_rd_addr),
@@ -308,9 +381,12 @@ module npu_top #(
         .layernorm_rd_addr(layernorm_rd_addr),
         .layernorm_rd_data(layernorm_rd_data),
         .layernorm_rd_en(layernorm_rd_en),
+        .layernorm_rd_gnt(layernorm_rd_gnt),
         .layernorm_wr_addr(layernorm_wr_addr),
         .layernorm_wr_data(layernorm_wr_data),
+        .layernorm_wr_mask(layernorm_wr_mask),
         .layernorm_wr_en(layernorm_wr_en),
+        .layernorm_wr_gnt(layernorm_wr_gnt),
         .layernorm_rd_addr_b(layernorm_rd_addr_b),
         .layernorm_rd_data_b(layernorm_rd_data_b),
         .layernorm_rd_en_b(layernorm_rd_en_b),
@@ -335,6 +411,10 @@ module npu_top #(
         .dma_wr_addr(dma_wr_addr),
         .dma_wr_data(dma_wr_data),
         .dma_wr_en(dma_wr_en),
+        .lut_rd_addr(lut_rd_addr),
+        .lut_rd_data(lut_rd_data),
+        .lut_rd_en(lut_rd_en),
+        .lut_rd_gnt(lut_rd_gnt),
         .ucode_rd_addr(ucode_rd_addr),
         .ucode_rd_data(ucode_rd_data),
         .ucode_rd_en(ucode_rd_en)
@@ -344,19 +424,38 @@ module npu_top #(
     // Engines
     // ========================================================================
     
-    gemm_engine #(.DATA_WIDTH(DATA_WIDTH)) gemm (
+    gemm_engine #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .ACC_WIDTH(ACC_WIDTH),
+        .ARRAY_SIZE(ARRAY_SIZE),
+        .SRAM_ADDR_WIDTH(SRAM_ADDR_WIDTH)
+    ) gemm (
         .clk(clk),
         .rst_n(rst_n),
         .start(gemm_start),
         .busy(gemm_busy),
         .done(gemm_done),
-        .src_a_addr('0), // TODO: Wire from controller instr
-        .src_b_addr('0),
-        .dst_addr('0),
+        .src_a_addr(gemm_src_a),
+        .src_b_addr(gemm_src_b),
+        .dst_addr(gemm_dst),
+        .out_block_log2(gemm_out_block),
+        .batch_count(gemm_batch_count),
+        .batch_stride_a(gemm_stride_a),
+        .batch_stride_b(gemm_stride_b),
+        .batch_stride_c(gemm_stride_c),
+        .ldc(gemm_ldc),
+        .loop_order(gemm_loop_order),
+        .residual_en(gemm_residual_en),
+        .residual_addr(gemm_residual),
+        .wgt_stream(gemm_wgt_stream),
+        .wgt_fifo_valid(wgt_fifo_rd_valid),
+        .wgt_fifo_data(wgt_fifo_rd_data),
+        .wgt_fifo_pop(wgt_fifo_pop),
         .dim_m(gemm_dim_m),
         .dim_k(gemm_dim_k),
         .dim_n(gemm_dim_n),
         .transpose_b(gemm_transpose_b),
+        .int4_weights(gemm_int4),
         .accumulate(gemm_accumulate),
         .scale(gemm_imm[15:8]),
         .shift(gemm_imm[7:0]),
@@ -372,16 +471,21 @@ module npu_top #(
         .array_weight_in(gemm_array_weight_in_unused)
     );
     
-    dma_engine #(.DATA_WIDTH(DATA_WIDTH)) dma (
+    dma_engine #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .SRAM_ADDR_WIDTH(SRAM_ADDR_WIDTH),
+        .BURST_LEN(DMA_BURST_LEN)
+    ) dma (
         .clk(clk),
         .rst_n(rst_n),
         .start(dma_start),
         .busy(dma_busy),
         .done(dma_done),
         .direction(dma_direction),
-        .ddr_addr('0), // TODO: from instr
-        .sram_addr('0),
+        .ddr_addr(ddr_base_wgt_reg + dma_ddr_offset),
+        .sram_addr(dma_sram_addr),
         .byte_count(dma_byte_count),
+        .stream(dma_stream),
         .m_axi_araddr(m_axi_araddr),
         .m_axi_arlen(m_axi_arlen),
         .m_axi_arsize(m_axi_arsize),
@@ -411,15 +515,153 @@ module npu_top #(
         .sram_wdata(dma_wr_data),
         .sram_we(dma_wr_en),
         .sram_re(dma_rd_en),
-        .sram_rdata(dma_rd_data)
+        .sram_rdata(dma_rd_data),
+        .stream_valid(wgt_fifo_wr_valid),
+        .stream_ready(wgt_fifo_wr_ready),
+        .stream_data(wgt_fifo_wr_data)
+    );
+    
+    // Streamed weights bypass SRAM0; a full FIFO holds off the AXI R channel
+    weight_fifo #(
+        .WIDTH(64),
+        .DEPTH(WGT_FIFO_DEPTH)
+    ) wgt_fifo (
+        .clk(clk),
+        .rst_n(rst_n),
+        .wr_valid(wgt_fifo_wr_valid),
+        .wr_ready(wgt_fifo_wr_ready),
+        .wr_data(wgt_fifo_wr_data),
+        .rd_valid(wgt_fifo_rd_valid),
+        .rd_pop(wgt_fifo_pop),
+        .rd_data(wgt_fifo_rd_data)
+    );
+    
+    // LUT_LOAD: reprogram the GELU / softmax exp tables from SRAM0
+    lut_loader #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .SRAM_ADDR_WIDTH(SRAM_ADDR_WIDTH)
+    ) lut_load (
+        .clk(clk),
+        .rst_n(rst_n),
+        .start(lut_load_start),
+        .table_sel(lut_load_table),
+        .src_addr(lut_load_addr),
+        .busy(lut_load_busy),
+        .done(lut_load_done),
+        .sram_rd_addr(lut_rd_addr),
+        .sram_rd_en(lut_rd_en),
+        .sram_rd_gnt(lut_rd_gnt),
+        .sram_rd_data(lut_rd_data),
+        .gelu_lut_wr_en(gelu_lut_wr_en),
+        .gelu_lut_wr_addr(gelu_lut_wr_addr),
+        .gelu_lut_wr_data(gelu_lut_wr_data),
+        .exp_lut_wr_en(exp_lut_wr_en),
+        .exp_lut_wr_addr(exp_lut_wr_addr),
+        .exp_lut_wr_data(exp_lut_wr_data)
+    );
+    
+    // LayerNorm streams rows through SRAM0: x/y on port A, gamma/beta on
+    // port B, so the hidden size is limited only by the 16-bit N field
+    logic [DATA_WIDTH-1:0] layernorm_data_out_unused;
+    logic layernorm_out_valid_unused;
+    
+    layernorm_engine #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .MAX_HIDDEN_DIM(65536),
+        .STREAM(1),
+        .LANES(LN_LANES),
+        .PARAM_SLOTS(LN_PARAM_SLOTS),
+        .PARAM_DIM(LN_PARAM_DIM),
+        .SRAM_ADDR_WIDTH(SRAM_ADDR_WIDTH)
+    ) layernorm (
+        .clk(clk),
+        .rst_n(rst_n),
+        .start(layernorm_start),
+        .busy(layernorm_busy),
+        .done(layernorm_done),
+        .hidden_dim(layernorm_dim),
+        .data_in('0),
+        .data_valid(1'b0),
+        .gamma_in('0),
+        .beta_in('0),
+        .param_valid(1'b0),
+        .data_out(layernorm_data_out_unused),
+        .out_valid(layernorm_out_valid_unused),
+        .num_rows(layernorm_rows),
+        .x_addr(layernorm_src),
+        .y_addr(layernorm_dst),
+        .param_addr(layernorm_param),
+        .param_reload(layernorm_reload),
+        .sram_rd_addr(layernorm_rd_addr),
+        .sram_rd_en(layernorm_rd_en),
+        .sram_rd_gnt(layernorm_rd_gnt),
+        .sram_rd_data(layernorm_rd_data),
+        .sram_wr_addr(layernorm_wr_addr),
+        .sram_wr_data(layernorm_wr_data),
+        .sram_wr_mask(layernorm_wr_mask),
+        .sram_wr_en(layernorm_wr_en),
+        .sram_wr_gnt(layernorm_wr_gnt),
+        .param_rd_addr(layernorm_rd_addr_b),
+        .param_rd_en(layernorm_rd_en_b),
+        .param_rd_data(layernorm_rd_data_b)
+    );
+    
+    // GELU and softmax are instantiated for their LUTs. Their streaming
+    // datapaths are not connected to SRAM yet, so start/data stay tied off
+    // and GELU/SOFTMAX instructions still complete immediately. Softmax's
+    // mask inputs (causal, window, row offset) follow the controller but
+    // have no effect until start is driven: nothing is masked on the chip.
+    logic [DATA_WIDTH-1:0] gelu_data_out_unused;
+    logic gelu_out_valid_unused, gelu_engine_busy_unused, gelu_engine_done_unused;
+    logic [DATA_WIDTH-1:0] softmax_data_out_unused;
+    logic softmax_out_valid_unused, softmax_engine_busy_unused, softmax_engine_done_unused;
+    logic [3:0] softmax_col_out_unused, softmax_row_out_unused;
+    
+    gelu_engine #(.DATA_WIDTH(DATA_WIDTH)) gelu (
+        .clk(clk),
+        .rst_n(rst_n),
+        .start(1'b0),
+        .busy(gelu_engine_busy_unused),
+        .done(gelu_engine_done_unused),
+        .num_elements('0),
+        .lut_wr_en(gelu_lut_wr_en),
+        .lut_wr_addr(gelu_lut_wr_addr),
+        .lut_wr_data(gelu_lut_wr_data),
+        .data_in('0),
+        .data_valid(1'b0),
+        .data_out(gelu_data_out_unused),
+        .out_valid(gelu_out_valid_unused)
     );
     
+    softmax_engine #(.DATA_WIDTH(DATA_WIDTH)) softmax (
+        .clk(clk),
+        .rst_n(rst_n),
+        .start(1'b0),
+        .busy(softmax_engine_busy_unused),
+        .done(softmax_engine_done_unused),
+        .seq_len('0),
+        .causal_mask(softmax_causal),
+        .window(softmax_window),
+        .row_offset(softmax_row_offset),
+        .exp_lut_wr_en(exp_lut_wr_en),
+        .exp_lut_wr_addr(exp_lut_wr_addr),
+        .exp_lut_wr_data(exp_lut_wr_data),
+        .data_in('0),
+        .data_valid(1'b0),
+        .col_in('0),
+        .row_in('0),
+        .data_out(softmax_data_out_unused),
+        .out_valid(softmax_out_valid_unused),
+        .col_out(softmax_col_out_unused),
+        .row_out(softmax_row_out_unused)
+    );
+    
+    // A table load occupies the scoreboard slot of the engine that owns it
+    assign softmax_busy = lut_load_busy && lut_load_table;
+    assign gelu_busy = lut_load_busy && !lut_load_table;
+    
     // Placeholders for other engines until fully implemented
-    assign softmax_busy = 1'b0;
     assign softmax_done = 1'b0;
-    assign layernorm_busy = 1'b0;
-    assign layernorm_done = 1'b0;
-    assign gelu_busy = 1'b0;
     assign gelu_done = 1'b0;
     assign vec_busy = 1'b0;
     assign vec_done = 1'b0;
@@ -428,29 +670,36 @@ module npu_top #(
     assign unused_top_wiring = &{
         1'b0,
         status_reg[31:1],
-        ddr_base_wgt_reg,
         exec_mode_reg,
         gemm_done,
         softmax_start,
         softmax_done,
-        layernorm_start,
         layernorm_done,
+        layernorm_data_out_unused,
+        layernorm_out_valid_unused,
         gelu_start,
         gelu_done,
         vec_start,
         vec_done,
         dma_done,
-        softmax_causal,
+        lut_load_done,
+        gelu_data_out_unused,
+        gelu_out_valid_unused,
+        gelu_engine_busy_unused,
+        gelu_engine_done_unused,
+        softmax_data_out_unused,
+        softmax_out_valid_unused,
+        softmax_engine_busy_unused,
+        softmax_engine_done_unused,
+        softmax_col_out_unused,
+        softmax_row_out_unused,
         softmax_m,
         softmax_n,
-        layernorm_dim,
         gelu_count,
         vec_op,
         vec_count,
         vec_imm,
         softmax_rd_data,
-        layernorm_rd_data,
-        layernorm_rd_data_b,
         gelu_rd_data,
         vec_rd_data,
         vec_rd_data_b,
@@ -17,35 +17,81 @@ if ! [[ "${RUNS}" =~ ^[0-9]+$ ]] || [[ "${RUNS}" -lt 1 ]]; then
   exit 1
 fi
 
+# Cycle-budget gate: workloads append "metric,cycles" lines to $NPU_PERF_OUT.
+# Run 1 is compared against the per-workload baseline; a metric more than
+# CYCLE_TOLERANCE_PCT above its budget fails the run. UPDATE_CYCLE_BASELINE=1
+# rewrites the baseline from this run instead. Gated workloads must have a
+# baseline row for every metric they report; a missing row fails the gate.
+CYCLE_BASELINE="${CYCLE_BASELINE:-${OUT_DIR}/cycle_baseline.csv}"
+CYCLE_TOLERANCE_PCT="${CYCLE_TOLERANCE_PCT:-2}"
+UPDATE_CYCLE_BASELINE="${UPDATE_CYCLE_BASELINE:-0}"
+if ! [[ "${CYCLE_TOLERANCE_PCT}" =~ ^[0-9]+([.][0-9]+)?$ ]]; then
+  echo "CYCLE_TOLERANCE_PCT must be a non-negative number (got: ${CYCLE_TOLERANCE_PCT})"
+  exit 1
+fi
+
+# Workload name followed by its arguments
 runs=(
-  test_mac_unit
-  test_systolic_array
-  test_npu_smoke
-  test_integration
-  test_gpt2_block
+  "test_mac_unit"
+  "test_systolic_array"
+  "test_npu_smoke"
+  "test_integration"
+  "test_gpt2_block"
+  "bench_block_scaling --max-seq 16 --hidden 64 --csv block_scaling_gate.csv"
 )
 
+# Workloads whose cycle counters are gated. test_integration loads no program
+# and only reports its run_until_done() timeout, so it is not gated.
+gated=" test_gpt2_block bench_block_scaling "
+
 summary_csv="${OUT_DIR}/deterministic_summary.csv"
+cycles_csv="${OUT_DIR}/cycle_summary.csv"
 echo "test,run,sha256" > "${summary_csv}"
+echo "test,metric,cycles,baseline,delta_pct,sim_wall_ms,status" > "${cycles_csv}"
+
+new_baseline="$(mktemp)"
+trap 'rm -f "${new_baseline}"' EXIT
+echo "test,metric,cycles" > "${new_baseline}"
+
+baseline_cycles() {
+  local test="$1" metric="$2"
+  [[ -f "${CYCLE_BASELINE}" ]] || return 0
+  awk -F, -v t="${test}" -v m="${metric}" '$1 == t && $2 == m { print $3 }' "${CYCLE_BASELINE}"
+}
 
 overall_status=0
-for t in "${runs[@]}"; do
+for entry in "${runs[@]}"; do
+  read -r -a cmd <<< "${entry}"
+  t="${cmd[0]}"
   ref_hash=""
+  ref_perf=""
   mismatch=0
+  wall_ms=0
 
   for i in $(seq 1 "${RUNS}"); do
     outfile="${OUT_DIR}/${t}.run${i}.out"
-    (cd "${BUILD_DIR}" && "./${t}") > "${outfile}" 2>&1
+    perffile="${OUT_DIR}/${t}.run${i}.perf"
+    rm -f "${perffile}"
+    start_ns="$(date +%s%N)"
+    (cd "${BUILD_DIR}" && NPU_PERF_OUT="${perffile}" "./${cmd[@]}") > "${outfile}" 2>&1
+    end_ns="$(date +%s%N)"
+    [[ "${i}" -eq 1 ]] && wall_ms=$(( (end_ns - start_ns) / 1000000 ))
+    touch "${perffile}"
     hash="$(sha256sum "${outfile}" | awk '{print $1}')"
     echo "${t},${i},${hash}" >> "${summary_csv}"
 
     if [[ -z "${ref_hash}" ]]; then
       ref_hash="${hash}"
+      ref_perf="${perffile}"
       echo "${t}: run ${i}/${RUNS} hash=${hash} (baseline)"
     elif [[ "${hash}" != "${ref_hash}" ]]; then
       mismatch=1
       overall_status=1
       echo "${t}: run ${i}/${RUNS} hash=${hash} (MISMATCH vs ${ref_hash})"
+    elif ! cmp -s "${perffile}" "${ref_perf}"; then
+      mismatch=1
+      overall_status=1
+      echo "${t}: run ${i}/${RUNS} hash=${hash} (match, but cycle counts differ from run 1)"
     else
       echo "${t}: run ${i}/${RUNS} hash=${hash} (match)"
     fi
@@ -56,14 +102,62 @@ for t in "${runs[@]}"; do
   else
     echo "${t}: FAIL (hash mismatch detected across ${RUNS} runs)"
   fi
+
+  # Cycle budgets (run 1)
+  is_gated=0
+  [[ "${gated}" == *" ${t} "* ]] && is_gated=1
+  if [[ ! -s "${ref_perf}" ]]; then
+    echo "${t}: no cycle counters (sim wall ${wall_ms} ms)"
+    if [[ "${is_gated}" -eq 1 ]]; then
+      overall_status=1
+      echo "${t}: FAIL gated workload reported no cycle counters"
+    fi
+    echo "${t},,,,,${wall_ms},none" >> "${cycles_csv}"
+  fi
+  while IFS=, read -r metric cycles; do
+    [[ -n "${metric}" ]] || continue
+    echo "${t},${metric},${cycles}" >> "${new_baseline}"
+    base="$(baseline_cycles "${t}" "${metric}")"
+    if [[ -z "${base}" ]]; then
+      delta=""
+      if [[ "${is_gated}" -eq 1 && "${UPDATE_CYCLE_BASELINE}" != "1" ]]; then
+        status="missing"
+        overall_status=1
+        echo "${t}: ${metric}=${cycles} has NO BASELINE; gated metrics need a budget" \
+             "(seed with UPDATE_CYCLE_BASELINE=1)"
+      else
+        status="new"
+        echo "${t}: ${metric}=${cycles} (no baseline)"
+      fi
+    else
+      delta="$(awk -v c="${cycles}" -v b="${base}" 'BEGIN { printf "%.2f", b ? 100.0 * (c - b) / b : (c ? 100.0 : 0.0) }')"
+      if awk -v d="${delta}" -v tol="${CYCLE_TOLERANCE_PCT}" 'BEGIN { exit !(d > tol) }'; then
+        status="regressed"
+        [[ "${UPDATE_CYCLE_BASELINE}" == "1" ]] || overall_status=1
+        echo "${t}: ${metric}=${cycles} vs budget ${base} (${delta}%) REGRESSED beyond ${CYCLE_TOLERANCE_PCT}%"
+      elif awk -v d="${delta}" -v tol="${CYCLE_TOLERANCE_PCT}" 'BEGIN { exit !(d < -tol) }'; then
+        status="improved"
+        echo "${t}: ${metric}=${cycles} vs budget ${base} (${delta}%) improved; refresh the baseline"
+      else
+        status="ok"
+        echo "${t}: ${metric}=${cycles} vs budget ${base} (${delta}%) ok"
+      fi
+    fi
+    echo "${t},${metric},${cycles},${base},${delta},${wall_ms},${status}" >> "${cycles_csv}"
+  done < "${ref_perf}"
   echo
- done
+done
 
 echo "Wrote ${summary_csv}"
+echo "Wrote ${cycles_csv}"
+if [[ "${UPDATE_CYCLE_BASELINE}" == "1" ]]; then
+  cp "${new_baseline}" "${CYCLE_BASELINE}"
+  echo "Updated cycle baseline ${CYCLE_BASELINE}"
+fi
 if [[ "${overall_status}" -eq 0 ]]; then
-  echo "Deterministic benchmark repeatability: PASS"
+  echo "Deterministic benchmark repeatability + cycle budgets: PASS"
 else
-  echo "Deterministic benchmark repeatability: FAIL"
+  echo "Deterministic benchmark repeatability + cycle budgets: FAIL"
 fi
 
 exit "${overall_status}"
@@ -0,0 +1,336 @@
+// Transformer block scaling benchmark
+// Generates real block microcode (common/block_program.h) for a grid of
+// sequence lengths and hidden sizes, runs each on npu_top and records total
+// cycles, per-engine busy cycles (controller scoreboard occupancy) and the
+// SRAM0 footprint. Writes a CSV and summarizes where scaling stops being
+// linear in sequence length: the attention quadratic term and SRAM capacity
+// cliffs (weights no longer resident, layout no longer fitting).
+// --kv-heads runs grouped-query attention (K/V heads shared by
+// heads/kv_heads query heads) and --store-kv writes each block's K/V to
+// the DDR KV cache, so dma_bytes shows the cache traffic.
+// --window W runs sliding-window attention, whose attention cost grows
+// with seq_len * W rather than seq_len^2. --decode N also runs single-token
+// decode steps at positions 0, 1, 2, 4, ... N against the KV ring (W
+// slots, or --max-seq without a window); their cycles stop growing once
+// the ring is full.
+// --layers L stacks L blocks in one program. --sram-kb K lays it out for a
+// K KB SRAM0 (64KB banks, build with -GSRAM0_SIZE to match): weights that
+// no longer fit beside the activations stay resident in the upper banks,
+// and an extra pass reruns every sample with a 64KB layout to show the
+// DDR traffic the bigger SRAM saves.
+// --full-ucode encodes every instruction in the 128-bit form instead of
+// pairing compact ones; ucode_bytes shows the microcode footprint.
+//
+// Usage: bench_block_scaling [--csv FILE] [--max-seq N] [--hidden H] [--kv-heads N] [--store-kv]
+//                            [--window W] [--decode N] [--layers L] [--sram-kb K] [--full-ucode]
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/axi_ddr_model.h"
+#include "common/block_program.h"
+#include "common/npu_driver.h"
+#include "common/npu_utils.h"
+#include "common/perf_report.h"
+
+namespace {
+
+constexpr uint32_t DDR_BASE = 0x100000;
+constexpr int MAX_CYCLES = 50000000;
+
+struct Sample {
+    BlockConfig cfg;
+    BlockProgram prog;
+    uint64_t cycles = 0;
+    uint64_t engine_busy[NUM_ENGINES] = {};
+    uint64_t ddr_bytes = 0;  // read + written on the AXI port
+};
+
+void run(Sample& s) {
+    AxiDdrModel<Vnpu_top> ddr;
+    NpuDriver<Vnpu_top> npu;
+
+    npu.reset(10);
+    npu.toggle();
+    npu.write_reg(REG_DDR_BASE, DDR_BASE);
+    npu.load_microcode(s.prog.ucode_base, s.prog.ucode);
+    npu.start(s.prog.ucode_base, s.prog.ucode.slots());
+
+    s.cycles = npu.run_until_done(MAX_CYCLES, [&](Vnpu_top* top) {
+        ddr.step(top);
+        uint8_t sb = top->rootp->npu_top__DOT__controller__DOT__scoreboard;
+        for (int e = 0; e < NUM_ENGINES; e++) {
+            if ((sb >> e) & 1) s.engine_busy[e]++;
+        }
+    });
+
+    if (!npu->done) {
+        std::cerr << "Timeout: seq=" << s.cfg.seq_len << " hidden=" << s.cfg.hidden << std::endl;
+        std::exit(1);
+    }
+    s.ddr_bytes = 8 * ddr.stats().read_beats + ddr.stats().write_bytes;
+}
+
+const char* residency(const BlockProgram& prog) {
+    return prog.weights_banked     ? "banked"
+           : prog.weights_resident ? "yes"
+           : !prog.fits_sram       ? "overflow"
+           : prog.weights_streamed ? "streamed"
+                                   : "staged";
+}
+
+// Least-squares fit of cycles = a + b*S + c*S^2 over one hidden size
+void fit_quadratic(const std::vector<const Sample*>& pts, double coef[3]) {
+    double a[9] = {}, b[3] = {};
+    for (const Sample* p : pts) {
+        double x[3] = {1.0, double(p->cfg.seq_len), double(p->cfg.seq_len) * p->cfg.seq_len};
+        for (int i = 0; i < 3; i++) {
+            b[i] += x[i] * p->cycles;
+            for (int j = 0; j < 3; j++) a[i * 3 + j] += x[i] * x[j];
+        }
+    }
+    // Gauss-Jordan on the 3x3 normal equations
+    for (int c = 0; c < 3; c++) {
+        int piv = c;
+        for (int r = c + 1; r < 3; r++) {
+            if (std::fabs(a[r * 3 + c]) > std::fabs(a[piv * 3 + c])) piv = r;
+        }
+        for (int j = 0; j < 3; j++) std::swap(a[c * 3 + j], a[piv * 3 + j]);
+        std::swap(b[c], b[piv]);
+        if (std::fabs(a[c * 3 + c]) < 1e-12) continue;
+        for (int r = 0; r < 3; r++) {
+            if (r == c) continue;
+            double f = a[r * 3 + c] / a[c * 3 + c];
+            for (int j = 0; j < 3; j++) a[r * 3 + j] -= f * a[c * 3 + j];
+            b[r] -= f * b[c];
+        }
+    }
+    for (int i = 0; i < 3; i++) coef[i] = std::fabs(a[i * 3 + i]) < 1e-12 ? 0.0 : b[i] / a[i * 3 + i];
+}
+
+void summarize(const std::vector<Sample>& samples, const std::vector<uint16_t>& hiddens) {
+    std::cout << "=== Scaling summary ===" << std::endl;
+    for (uint16_t hidden : hiddens) {
+        std::vector<const Sample*> pts;
+        for (const auto& s : samples) {
+            if (s.cfg.hidden == hidden) pts.push_back(&s);
+        }
+        if (pts.size() < 2) continue;
+
+        std::cout << "hidden=" << hidden << std::endl;
+
+        double coef[3];
+        fit_quadratic(pts, coef);
+        const Sample* last = pts.back();
+        double s = last->cfg.seq_len;
+        double quad_share = last->cycles ? 100.0 * coef[2] * s * s / last->cycles : 0.0;
+        std::cout << std::fixed << std::setprecision(2) << "  fit: cycles = " << coef[0] << " + " << coef[1]
+                  << "*S + " << coef[2] << "*S^2  (S^2 term " << std::setprecision(1) << quad_share
+                  << "% of cycles at S=" << last->cfg.seq_len << ")" << std::endl;
+
+        // Per-token cost between successive points; flag >10% growth and
+        // name the engine whose per-token busy cycles grew the most
+        for (size_t i = 1; i < pts.size(); i++) {
+            const Sample* a = pts[i - 1];
+            const Sample* b = pts[i];
+            double per_a = double(a->cycles) / a->cfg.seq_len;
+            double per_b = double(b->cycles) / b->cfg.seq_len;
+            double growth = per_a ? per_b / per_a : 0.0;
+            if (growth <= 1.10) continue;
+            int worst = 0;
+            double worst_delta = -1e30;
+            for (int e = 0; e < NUM_ENGINES; e++) {
+                double delta = double(b->engine_busy[e]) / b->cfg.seq_len - double(a->engine_busy[e]) / a->cfg.seq_len;
+                if (delta > worst_delta) {
+                    worst_delta = delta;
+                    worst = e;
+                }
+            }
+            std::cout << "  superlinear S=" << a->cfg.seq_len << "->" << b->cfg.seq_len << ": cycles/token x"
+                      << std::setprecision(2) << growth << ", driven by " << engine_name(worst) << std::endl;
+        }
+
+        // SRAM capacity cliffs
+        for (size_t i = 0; i < pts.size(); i++) {
+            bool was_resident = i == 0 || pts[i - 1]->prog.weights_resident;
+            bool did_fit = i == 0 || pts[i - 1]->prog.fits_sram;
+            if (i == 0 && !pts[i]->prog.weights_resident) {
+                std::cout << "  weights never resident (" << pts[i]->prog.weight_bytes << " B), "
+                          << (pts[i]->prog.weights_streamed ? "streamed" : "staged") << " from DDR" << std::endl;
+            } else if (was_resident && !pts[i]->prog.weights_resident) {
+                std::cout << "  cliff at S=" << pts[i]->cfg.seq_len << ": weights no longer resident, +"
+                          << pts[i]->prog.dma_bytes - (i ? pts[i - 1]->prog.dma_bytes : 0) << " B DMA/block"
+                          << std::endl;
+            }
+            if (did_fit && !pts[i]->prog.fits_sram) {
+                std::cout << "  cliff at S=" << pts[i]->cfg.seq_len << ": layout exceeds SRAM0 ("
+                          << pts[i]->prog.sram_peak << " B)" << std::endl;
+            }
+        }
+    }
+}
+
+// One decode step per position; cycles are flat once the ring is full
+void run_decode(const std::vector<uint16_t>& hiddens, const BlockConfig& base, uint32_t max_pos) {
+    const uint32_t slots = base.window ? base.window : base.seq_len;
+    std::cout << "=== Decode steps (KV ring of " << slots << " slots) ===" << std::endl;
+    std::cout << "  hidden       pos  instrs      cycles      gemm      dma" << std::endl;
+    for (uint16_t hidden : hiddens) {
+        uint64_t full_cycles = 0;
+        bool flat = true;
+        for (uint32_t pos = 0; pos <= max_pos; pos = pos ? pos * 2 : 1) {
+            Sample s;
+            s.cfg = base;
+            s.cfg.hidden = hidden;
+            s.cfg.decode = true;
+            s.cfg.position = pos;
+            s.prog = build_block_program(s.cfg);
+            run(s);
+            std::cout << "  " << std::setw(6) << hidden << std::setw(10) << pos << std::setw(8)
+                      << s.prog.instrs.size() << std::setw(12) << s.cycles << std::setw(10)
+                      << s.engine_busy[ENGINE_GEMM] << std::setw(9) << s.engine_busy[ENGINE_DMA] << std::endl;
+            perf_report("h" + std::to_string(hidden) + "_decode_p" + std::to_string(pos) + "_cycles", s.cycles);
+            if (pos + 1 < slots) continue;
+            if (full_cycles && s.cycles != full_cycles) flat = false;
+            full_cycles = s.cycles;
+        }
+        if (full_cycles) {
+            std::cout << "  hidden=" << hidden << ": " << (flat ? "constant " : "varying ") << full_cycles
+                      << " cycles/token once the ring is full" << std::endl;
+        }
+    }
+}
+
+// Same programs laid out for bank 0 alone: what the extra SRAM saves
+void run_onchip(const std::vector<Sample>& samples) {
+    std::cout << "=== On-chip weights (" << samples.front().cfg.sram_bytes / 1024 << "KB vs "
+              << SRAM0_BYTES / 1024 << "KB SRAM0, " << samples.front().cfg.layers << " layers) ===" << std::endl;
+    std::cout << "  hidden  seq    ddr_64k   ddr_big   saved   cyc_64k   cyc_big   preload  resident" << std::endl;
+    for (const Sample& big : samples) {
+        Sample small;
+        small.cfg = big.cfg;
+        small.cfg.sram_bytes = SRAM0_BYTES;
+        small.prog = build_block_program(small.cfg);
+        run(small);
+        double saved = small.ddr_bytes ? 100.0 * (1.0 - double(big.ddr_bytes) / small.ddr_bytes) : 0.0;
+        std::cout << "  " << std::setw(6) << big.cfg.hidden << std::setw(5) << big.cfg.seq_len << std::setw(11)
+                  << small.ddr_bytes << std::setw(10) << big.ddr_bytes << std::setw(7) << std::fixed
+                  << std::setprecision(1) << saved << "%" << std::setw(10) << small.cycles << std::setw(10)
+                  << big.cycles << std::setw(10) << big.prog.preload_bytes << std::setw(10) << residency(big.prog)
+                  << std::endl;
+        std::string tag = "h" + std::to_string(big.cfg.hidden) + "_s" + std::to_string(big.cfg.seq_len);
+        perf_report(tag + "_ddr_bytes_64k", small.ddr_bytes);
+        perf_report(tag + "_ddr_bytes", big.ddr_bytes);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    const char* csv_path = "block_scaling.csv";
+    uint32_t max_seq = 64;
+    std::vector<uint16_t> hiddens = {64, 128, 256};
+    uint16_t kv_heads = 0;
+    bool store_kv = false;
+    uint16_t window = 0;
+    uint32_t decode_steps = 0;
+    uint16_t layers = 1;
+    uint32_t sram_bytes = SRAM0_BYTES;
+    bool compact_ucode = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--max-seq") == 0 && i + 1 < argc) {
+            max_seq = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--hidden") == 0 && i + 1 < argc) {
+            hiddens = {static_cast<uint16_t>(atoi(argv[++i]))};
+        } else if (strcmp(argv[i], "--kv-heads") == 0 && i + 1 < argc) {
+            kv_heads = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--store-kv") == 0) {
+            store_kv = true;
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            window = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--decode") == 0 && i + 1 < argc) {
+            decode_steps = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--layers") == 0 && i + 1 < argc) {
+            layers = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--sram-kb") == 0 && i + 1 < argc) {
+            sram_bytes = static_cast<uint32_t>(atoi(argv[++i])) * 1024;
+        } else if (strcmp(argv[i], "--full-ucode") == 0) {
+            compact_ucode = false;
+        }
+    }
+
+    std::ofstream csv(csv_path);
+    if (!csv) {
+        std::cerr << "Failed to write " << csv_path << std::endl;
+        return 1;
+    }
+    csv << "hidden,seq_len,instructions,cycles,cycles_per_token";
+    for (int e = 0; e < NUM_ENGINES; e++) csv << "," << engine_name(e) << "_busy";
+    csv << ",sram_peak,weight_bytes,activation_bytes,dma_bytes,kv_heads,kv_bytes,weights_resident,weights_streamed,"
+           "fits_sram,layers,weights_banked,preload_bytes,ddr_bytes,ucode_bytes\n";
+
+    std::cout << "=== Transformer Block Scaling ===" << std::endl;
+    std::cout << "  hidden  seq  instrs      cycles  cyc/token      gemm   softmax   lnorm    gelu     vec"
+                 "      dma  sram_peak  resident" << std::endl;
+
+    std::vector<Sample> samples;
+    for (uint16_t hidden : hiddens) {
+        for (uint32_t seq = 1; seq <= max_seq; seq *= 2) {
+            Sample s;
+            s.cfg.hidden = hidden;
+            s.cfg.seq_len = static_cast<uint16_t>(seq);
+            s.cfg.kv_heads = kv_heads;
+            s.cfg.store_kv = store_kv;
+            s.cfg.window = window;
+            s.cfg.layers = layers;
+            s.cfg.sram_bytes = sram_bytes;
+            s.cfg.compact_ucode = compact_ucode;
+            s.prog = build_block_program(s.cfg);
+            run(s);
+            samples.push_back(s);
+
+            double per_token = double(s.cycles) / seq;
+            std::cout << "  " << std::setw(6) << hidden << std::setw(5) << seq << std::setw(8) << s.prog.instrs.size()
+                      << std::setw(12) << s.cycles << std::setw(11) << std::fixed << std::setprecision(1) << per_token;
+            for (uint64_t busy : s.engine_busy) std::cout << std::setw(9) << busy;
+            std::cout << std::setw(11) << s.prog.sram_peak << std::setw(10) << residency(s.prog) << std::endl;
+
+            csv << hidden << "," << seq << "," << s.prog.instrs.size() << "," << s.cycles << "," << per_token;
+            for (uint64_t busy : s.engine_busy) csv << "," << busy;
+            perf_report("h" + std::to_string(hidden) + "_s" + std::to_string(seq) + "_cycles", s.cycles);
+
+            csv << "," << s.prog.sram_peak << "," << s.prog.weight_bytes << "," << s.prog.activation_bytes << ","
+                << s.prog.dma_bytes << "," << (kv_heads ? kv_heads : s.cfg.heads) << "," << s.prog.kv_bytes << ","
+                << s.prog.weights_resident << "," << s.prog.weights_streamed << ","
+                << s.prog.fits_sram << "," << layers << "," << s.prog.weights_banked << ","
+                << s.prog.preload_bytes << "," << s.ddr_bytes << "," << s.prog.ucode.bytes.size() << "\n";
+        }
+    }
+
+    summarize(samples, hiddens);
+    if (sram_bytes > SRAM0_BYTES) run_onchip(samples);
+    if (decode_steps) {
+        BlockConfig base;
+        base.seq_len = static_cast<uint16_t>(max_seq);
+        base.kv_heads = kv_heads;
+        base.window = window;
+        base.layers = layers;
+        base.sram_bytes = sram_bytes;
+        base.compact_ucode = compact_ucode;
+        run_decode(hiddens, base, decode_steps);
+    }
+    std::cout << "Wrote " << csv_path << std::endl;
+    return 0;
+}
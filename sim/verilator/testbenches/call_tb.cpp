@@ -0,0 +1,203 @@
+// Subroutine (CALL/RET) Testbench
+// Builds multi-layer block programs twice, with every layer inlined and
+// with one block body CALLed per layer (frames relocating its weights,
+// activations, KV ring and DDR), and runs both on npu_top from the same
+// DDR contents. Checks that the engines see the same command stream
+// (GEMM, LayerNorm and DMA addresses, in order) and that DDR and SRAM0
+// outside the microcode end up identical, then reports the microcode
+// footprint of each. A RET with an empty return stack must end the
+// program like END rather than jump to a stale return address, and a
+// nested CALL must leave its caller's frames and base registers as they
+// were once it returns.
+//
+// The cases keep the DDR image below 64KB: an inlined DMA_LOAD/DMA_STORE
+// can only reach DDR through its 16-bit field, the called body reaches
+// the layers above through the DDR frame.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <verilated.h>
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/axi_ddr_model.h"
+#include "common/block_program.h"
+#include "common/block_run.h"
+#include "common/npu_driver.h"
+#include "common/npu_utils.h"
+
+namespace {
+
+constexpr uint32_t DDR_BASE = 0x0;
+constexpr int MAX_CYCLES = 5000000;
+constexpr uint32_t SEED = 0xca11;  // same DDR contents for both runs
+
+int run_case(const char* name, BlockConfig cfg) {
+    cfg.call_layers = false;
+    BlockRun inl = run_block<Vnpu_top>(cfg, SEED, MAX_CYCLES);
+    cfg.call_layers = true;
+    BlockRun call = run_block<Vnpu_top>(cfg, SEED, MAX_CYCLES);
+
+    if (!inl.done || !call.done) {
+        std::cout << "FAIL [" << name << "]: timeout (" << (inl.done ? "call" : "inline") << ")" << std::endl;
+        return 1;
+    }
+
+    int errors = diff_block_runs(inl, "inline", call, "called");
+
+    std::cout << (errors ? "FAIL" : "PASS") << " [" << name << "]: " << cfg.layers << " layers, "
+              << call.commands.size() << " commands, ucode " << inl.prog.ucode.bytes.size() << " -> "
+              << call.prog.ucode.bytes.size() << " B, cycles " << inl.cycles << " -> " << call.cycles << std::endl;
+    return errors ? 1 : 0;
+}
+
+// Hand-written program whose RETs outnumber its CALLs: it has to finish,
+// having issued exactly `dmas` DMA commands
+int run_ret_case(const char* name, const std::vector<Instruction>& program, size_t dmas) {
+    constexpr uint32_t UCODE_BASE = 0xF600;
+    NpuDriver<Vnpu_top> npu;
+    AxiDdrModel<Vnpu_top> ddr;
+    Microcode ucode = encode_microcode(program, false);
+
+    npu.reset(10);
+    npu.toggle();
+    npu.write_reg(REG_DDR_BASE, DDR_BASE);
+    npu.load_microcode(UCODE_BASE, ucode);
+    npu.start(UCODE_BASE, ucode.slots());
+    size_t issued = 0;
+    uint64_t cycles = npu.run_until_done(10000, [&](Vnpu_top* top) {
+        ddr.step(top);
+        if (top->rootp->npu_top__DOT__dma_start) issued++;
+    });
+
+    int errors = 0;
+    if (!npu->done) {
+        std::cout << "  timeout: RET jumped instead of ending the program" << std::endl;
+        errors++;
+    }
+    if (issued != dmas) {
+        std::cout << "  " << issued << " DMA commands, expected " << dmas << std::endl;
+        errors++;
+    }
+    std::cout << (errors ? "FAIL" : "PASS") << " [" << name << "]: " << cycles << " cycles" << std::endl;
+    return errors ? 1 : 0;
+}
+
+// Hand-written nested CALL: the outer body loads through its activation
+// and DDR frames, CALLs an inner body that replaces both frames and the
+// base registers, then repeats its load. The repeat has to hit the same
+// SRAM0 and DDR addresses as the first load.
+int run_nested_case() {
+    constexpr uint32_t UCODE_BASE = 0xF600;
+    const uint16_t act = sram_base(0, FRAME_ACT), kv = sram_base(0, FRAME_KV);
+    const Instruction load = {OP_DMA_LOAD, 0, 0x40, 0, 0, 64, 0, 0, 0};
+    const Instruction barrier = {OP_BARRIER, 0, 0, 0, 0, 0, 0, 0, 0};
+    const Instruction ret = {OP_RET, 0, 0, 0, 0, 0, 0, 0, 0};
+    const std::vector<Instruction> program = {
+        {OP_CALL, CALL_ACT | CALL_DDR, 0, 0x100, 0, 0x2000, 0, 0, 2},
+        {OP_END, 0, 0, 0, 0, 0, 0, 0, 0},
+        // Outer body (2): SRAM0 0x1040, DDR 0x2000
+        {OP_SRAM_BASE, BASE_DST | BASE_SRC0, act, act, 0, 0, 0, 0, 0},
+        load,
+        {OP_CALL, CALL_ACT | CALL_KV | CALL_DDR, 0, 0x200, 0x300, 0x5000, 0, 0, 8},
+        load,
+        barrier,
+        ret,
+        // Inner body (8): SRAM0 0x3040, DDR 0x5000
+        {OP_SRAM_BASE, BASE_DST | BASE_SRC0, kv, kv, 0, 0, 0, 0, 0},
+        load,
+        barrier,
+        ret,
+    };
+    const std::vector<std::pair<uint32_t, uint32_t>> want = {{0x1040, 0x2000}, {0x3040, 0x5000}, {0x1040, 0x2000}};
+
+    NpuDriver<Vnpu_top> npu;
+    AxiDdrModel<Vnpu_top> ddr;
+    Microcode ucode = encode_microcode(program, false);
+    npu.reset(10);
+    npu.toggle();
+    npu.write_reg(REG_DDR_BASE, DDR_BASE);
+    npu.load_microcode(UCODE_BASE, ucode);
+    npu.start(UCODE_BASE, ucode.slots());
+    std::vector<std::pair<uint32_t, uint32_t>> got;
+    uint64_t cycles = npu.run_until_done(10000, [&](Vnpu_top* top) {
+        ddr.step(top);
+        auto* root = top->rootp;
+        if (root->npu_top__DOT__dma_start)
+            got.push_back({root->npu_top__DOT__dma_sram_addr, root->npu_top__DOT__dma_ddr_offset});
+    });
+
+    int errors = 0;
+    if (!npu->done) {
+        std::cout << "  timeout" << std::endl;
+        errors++;
+    }
+    if (got.size() != want.size()) {
+        std::cout << "  " << got.size() << " DMA commands, expected " << want.size() << std::endl;
+        errors++;
+    }
+    for (size_t i = 0; i < std::min(got.size(), want.size()); i++) {
+        if (got[i] != want[i]) {
+            std::cout << "  DMA " << i << ": SRAM0 0x" << std::hex << got[i].first << " DDR 0x" << got[i].second
+                      << ", expected SRAM0 0x" << want[i].first << " DDR 0x" << want[i].second << std::dec
+                      << std::endl;
+            errors++;
+        }
+    }
+    std::cout << (errors ? "FAIL" : "PASS") << " [nested CALL]: " << cycles << " cycles" << std::endl;
+    return errors ? 1 : 0;
+}
+
+BlockConfig config(uint16_t hidden, bool stream, bool store_kv) {
+    BlockConfig cfg;
+    cfg.hidden = hidden;
+    cfg.seq_len = 16;
+    cfg.layers = 3;
+    cfg.stream_weights = stream;
+    cfg.store_kv = store_kv;
+    return cfg;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    std::cout << "=== Subroutine Test ===" << std::endl;
+
+    // Prefill keeps every layer's weights resident at H=32 (and H=40 with
+    // shared K/V heads); at H=40 they are streamed or staged through the
+    // body's DDR frame
+    int failures = 0;
+    failures += run_case("resident", config(32, true, false));
+    BlockConfig gqa = config(40, true, true);
+    gqa.kv_heads = 2;
+    failures += run_case("resident, GQA, store K/V", gqa);
+    failures += run_case("streamed, store K/V", config(40, true, true));
+    BlockConfig staged = config(40, false, true);
+    staged.window = 8;
+    failures += run_case("staged, window, store K/V", staged);
+    BlockConfig decode = config(40, true, false);
+    decode.decode = true;
+    decode.position = 5;
+    failures += run_case("decode", decode);
+    BlockConfig ring = config(40, false, false);
+    ring.decode = true;
+    ring.window = 8;
+    ring.position = 9;
+    failures += run_case("decode, wrapped ring", ring);
+    BlockConfig four = config(32, true, true);
+    four.layers = 4;
+    failures += run_case("4 layers", four);
+
+    const Instruction ret = {OP_RET, 0, 0, 0, 0, 0, 0, 0, 0};
+    const Instruction load = {OP_DMA_LOAD, 0, 0x1000, 0, 0, 64, 0, 0, 0};
+    const Instruction barrier = {OP_BARRIER, 0, 0, 0, 0, 0, 0, 0, 0};
+    const Instruction end = {OP_END, 0, 0, 0, 0, 0, 0, 0, 0};
+    const Instruction call = {OP_CALL, 0, 0, 0, 0, 0, 0, 0, 3};
+    failures += run_ret_case("bare RET", {ret, load, barrier, end}, 0);
+    failures += run_ret_case("RET after returning", {call, ret, end, load, ret}, 1);
+    failures += run_nested_case();
+    return failures ? 1 : 0;
+}
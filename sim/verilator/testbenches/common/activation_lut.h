@@ -0,0 +1,50 @@
+#pragma once
+// Activation tables for LUT_LOAD, in the layout the engines use:
+//   activation_lut   - 256 INT8 outputs indexed by the INT8 input's bit pattern
+//   softmax_exp_lut  - 256 x 16-bit little-endian exp(x - max) values (Q4.12)
+// Mirrors activation_lut / softmax_exp_lut in python/golden/reference.py.
+// Values are round-half-up then saturated to INT8.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+enum class Activation { GELU, SILU, RELU, TANH };
+
+inline double activation_fn(Activation act, double x) {
+    switch (act) {
+        case Activation::GELU:
+            return 0.5 * x * (1.0 + std::tanh(0.7978845608 * (x + 0.044715 * x * x * x)));
+        case Activation::SILU: return x / (1.0 + std::exp(-x));
+        case Activation::RELU: return x > 0.0 ? x : 0.0;
+        case Activation::TANH: return std::tanh(x);
+    }
+    return x;
+}
+
+// y_q = sat8(round(f(x_q * in_scale) / out_scale))
+inline std::vector<uint8_t> activation_lut(Activation act, double in_scale = 1.0, double out_scale = 1.0) {
+    std::vector<uint8_t> lut(256);
+    for (int i = 0; i < 256; i++) {
+        int x = i < 128 ? i : i - 256;
+        double y = std::floor(activation_fn(act, x * in_scale) / out_scale + 0.5);
+        lut[i] = static_cast<uint8_t>(static_cast<int8_t>(std::clamp(y, -128.0, 127.0)));
+    }
+    return lut;
+}
+
+// base^d * 4096 for d = x - max <= 0 (truncated, at least 1); positive
+// indices never occur after max subtraction and saturate. base = e
+// reproduces the softmax engine's reset table.
+inline std::vector<uint8_t> softmax_exp_lut(double base = M_E) {
+    std::vector<uint8_t> bytes(512);
+    for (int i = 0; i < 256; i++) {
+        int d = i < 128 ? i : i - 256;
+        uint16_t v = 0xFFFF;
+        if (d <= 0) v = static_cast<uint16_t>(std::max(1.0, std::trunc(std::pow(base, d) * 4096.0)));
+        bytes[2 * i] = v & 0xFF;
+        bytes[2 * i + 1] = v >> 8;
+    }
+    return bytes;
+}
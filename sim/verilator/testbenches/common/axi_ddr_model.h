@@ -0,0 +1,151 @@
+#pragma once
+// Behavioral AXI4 DDR slave for npu_top harnesses.
+// Services the m_axi_* master port: read bursts return data from a byte
+// backing store after a fixed latency, write bursts are applied with WSTRB
+// and acknowledged after a fixed latency. Beat/byte counters let benchmarks
+// report achieved bandwidth.
+//
+// Call step() once per clock, after the rising edge has been evaluated. It
+// drives the slave-side inputs for the next edge and records the handshakes
+// that edge will complete (npu_top has no input->output combinational paths
+// on this port, so the master's valid/ready are already final).
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+struct DdrConfig {
+    uint32_t read_latency = 8;     // AR handshake -> first R beat (cycles)
+    uint32_t write_latency = 4;    // WLAST -> BVALID (cycles)
+    uint32_t max_outstanding = 1;  // bursts in flight per direction
+    uint32_t size = 1u << 20;      // backing store bytes (addresses wrap)
+};
+
+struct DdrStats {
+    uint64_t read_bursts = 0;
+    uint64_t read_beats = 0;
+    uint64_t write_bursts = 0;
+    uint64_t write_beats = 0;
+    uint64_t write_bytes = 0;  // bytes enabled by WSTRB
+    uint64_t unaligned_bursts = 0;    // start address not 8-byte aligned
+    uint64_t crossing_4k_bursts = 0;  // burst spans a 4KB boundary (AXI violation)
+    uint64_t short_write_bursts = 0;  // WLAST before AWLEN+1 beats
+};
+
+template <typename Top>
+class AxiDdrModel {
+public:
+    explicit AxiDdrModel(const DdrConfig& cfg = DdrConfig()) : cfg_(cfg), mem_(cfg.size, 0) {
+        if (cfg_.read_latency < 1) cfg_.read_latency = 1;
+        if (cfg_.write_latency < 1) cfg_.write_latency = 1;
+        if (cfg_.max_outstanding < 1) cfg_.max_outstanding = 1;
+        // Deterministic default contents: each byte holds its low address bits
+        for (uint32_t i = 0; i < cfg_.size; i++) mem_[i] = static_cast<uint8_t>(i);
+    }
+
+    void step(Top* top) {
+        cycle_++;
+        step_read(top);
+        step_write(top);
+    }
+
+    uint8_t& byte(uint64_t addr) { return mem_[addr % cfg_.size]; }
+    const DdrStats& stats() const { return stats_; }
+    void reset_stats() { stats_ = DdrStats(); }
+    bool idle() const { return reads_.empty() && writes_.empty() && responses_.empty(); }
+
+private:
+    struct ReadBurst {
+        uint64_t addr;
+        uint32_t beats;
+        uint32_t sent;
+        uint64_t ready_cycle;
+    };
+
+    struct WriteBurst {
+        uint64_t addr;
+        uint32_t beats;
+        uint32_t beat;
+    };
+
+    void check_burst(uint64_t addr, uint32_t beats) {
+        uint64_t last = addr + 8ull * beats - 1;
+        if (addr % 8) stats_.unaligned_bursts++;
+        if ((addr >> 12) != (last >> 12)) stats_.crossing_4k_bursts++;
+    }
+
+    void step_read(Top* top) {
+        bool ar_ready = reads_.size() < cfg_.max_outstanding;
+        top->m_axi_arready = ar_ready;
+        if (top->m_axi_arvalid && ar_ready) {
+            reads_.push_back({top->m_axi_araddr, uint32_t(top->m_axi_arlen) + 1, 0,
+                              cycle_ + cfg_.read_latency});
+            stats_.read_bursts++;
+            check_burst(top->m_axi_araddr, uint32_t(top->m_axi_arlen) + 1);
+        }
+
+        if (!reads_.empty() && reads_.front().ready_cycle <= cycle_) {
+            ReadBurst& burst = reads_.front();
+            uint64_t beat_addr = burst.addr + 8ull * burst.sent;
+            uint64_t data = 0;
+            for (int b = 0; b < 8; b++) data |= uint64_t(byte(beat_addr + b)) << (8 * b);
+            top->m_axi_rvalid = 1;
+            top->m_axi_rdata = data;
+            top->m_axi_rresp = 0;
+            top->m_axi_rlast = (burst.sent + 1 == burst.beats);
+            if (top->m_axi_rready) {
+                stats_.read_beats++;
+                if (++burst.sent == burst.beats) reads_.pop_front();
+            }
+        } else {
+            top->m_axi_rvalid = 0;
+            top->m_axi_rlast = 0;
+        }
+    }
+
+    void step_write(Top* top) {
+        bool aw_ready = writes_.size() + responses_.size() < cfg_.max_outstanding;
+        top->m_axi_awready = aw_ready;
+        if (top->m_axi_awvalid && aw_ready) {
+            writes_.push_back({top->m_axi_awaddr, uint32_t(top->m_axi_awlen) + 1, 0});
+            stats_.write_bursts++;
+            check_burst(top->m_axi_awaddr, uint32_t(top->m_axi_awlen) + 1);
+        }
+
+        // W beats follow their AW; the burst ends on WLAST
+        top->m_axi_wready = !writes_.empty();
+        if (top->m_axi_wvalid && !writes_.empty()) {
+            WriteBurst& burst = writes_.front();
+            uint64_t beat_addr = burst.addr + 8ull * burst.beat;
+            for (int b = 0; b < 8; b++) {
+                if ((top->m_axi_wstrb >> b) & 1) {
+                    byte(beat_addr + b) = static_cast<uint8_t>(top->m_axi_wdata >> (8 * b));
+                    stats_.write_bytes++;
+                }
+            }
+            stats_.write_beats++;
+            burst.beat++;
+            if (top->m_axi_wlast) {
+                if (burst.beat < burst.beats) stats_.short_write_bursts++;
+                writes_.pop_front();
+                responses_.push_back(cycle_ + cfg_.write_latency);
+            }
+        }
+
+        if (!responses_.empty() && responses_.front() <= cycle_) {
+            top->m_axi_bvalid = 1;
+            top->m_axi_bresp = 0;
+            if (top->m_axi_bready) responses_.pop_front();
+        } else {
+            top->m_axi_bvalid = 0;
+        }
+    }
+
+    DdrConfig cfg_;
+    std::vector<uint8_t> mem_;
+    std::deque<ReadBurst> reads_;
+    std::deque<WriteBurst> writes_;
+    std::deque<uint64_t> responses_;
+    DdrStats stats_;
+    uint64_t cycle_ = 0;
+};
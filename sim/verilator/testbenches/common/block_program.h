@@ -0,0 +1,679 @@
+#pragma once
+// GPT-2 style transformer block microcode generator.
+// Lays out one or more blocks' activations (and their weights, when they
+// fit) in SRAM0 and emits the instruction stream:
+//   LN1 -> QKV GEMM -> per-head QK^T, causal softmax, PV -> output
+//   projection + residual -> LN2 -> FFN up -> GELU -> FFN down + residual
+// with the input DMA'd in and the output DMA'd out. BlockConfig selects
+// the variants (GQA, sliding window, KV-ring decode, weight streaming,
+// multiple layers, CALLed layer bodies, compact microcode); docs/
+// ARCHITECTURE.md describes each.
+//
+// LayerNorm streams its rows and gamma/beta through SRAM0. The other
+// engines ignore operand addresses until their datapaths land, but the
+// layout is still tracked so benchmarks can report SRAM pressure.
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "common/npu_utils.h"
+
+constexpr uint32_t SRAM0_BYTES = 65536;          // bank 0: what 16-bit fields reach with zero bases
+constexpr uint32_t UCODE_REGION_BYTES = 2560;  // 0xF600..0xFFFF in the memory map
+constexpr uint32_t MAX_DMA_CHUNK = 32768;      // M is 16 bits
+constexpr uint32_t MAX_ELEMENTWISE = 32768;    // N is 16 bits
+constexpr uint32_t FRAME_SHIFT = 28;           // address bits 28+: Frame of a called body's operand
+constexpr uint32_t ADDR_MASK = (1u << FRAME_SHIFT) - 1;
+constexpr uint32_t NO_RESIDUAL = ~0u;          // weight_gemm without GEMM_RESIDUAL
+
+// gemm_engine defaults: 16x16 tiles, 16-tile activation and weight
+// buffers, accumulators for 16 output tiles (KMN)
+constexpr uint32_t GEMM_TILE = 16;
+constexpr uint32_t GEMM_ACT_BUF_TILES = 16;
+constexpr uint32_t GEMM_WGT_BUF_TILES = 16;
+constexpr uint32_t GEMM_ACC_BUF_TILES = 16;
+
+// Operand bytes gemm_engine reads from SRAM for C[m,n] = A[m,k] x B[k,n]
+// in a GEMM_ORDER loop order. Mirrors the engine's tile walk: a tile is
+// fetched unless its direct-mapped buffer slot still holds it. Weight
+// tiles are indexed k-major under KMN, n-major otherwise.
+inline uint64_t gemm_operand_reads(uint32_t m, uint32_t k, uint32_t n, int order) {
+    const uint32_t tm = (m + GEMM_TILE - 1) / GEMM_TILE, tn = (n + GEMM_TILE - 1) / GEMM_TILE;
+    const uint32_t tk = (k + GEMM_TILE - 1) / GEMM_TILE;
+    if (order == LOOP_KMN && uint64_t(tm) * tn > GEMM_ACC_BUF_TILES) order = LOOP_MNK;
+    const uint32_t outer = order == LOOP_MNK ? tm : order == LOOP_NMK ? tn : tk;
+    const uint32_t mid = order == LOOP_MNK ? tn : tm;
+    const uint32_t inner = order == LOOP_KMN ? tn : tk;
+    std::vector<int64_t> act(GEMM_ACT_BUF_TILES, -1), wgt(GEMM_WGT_BUF_TILES, -1);
+    uint64_t bytes = 0;
+    for (uint32_t a = 0; a < outer; a++) {
+        for (uint32_t b = 0; b < mid; b++) {
+            for (uint32_t c = 0; c < inner; c++) {
+                uint32_t im = order == LOOP_NMK ? b : order == LOOP_KMN ? b : a;
+                uint32_t in = order == LOOP_MNK ? b : order == LOOP_NMK ? a : c;
+                uint32_t ik = order == LOOP_KMN ? a : c;
+                uint64_t rows = std::min(GEMM_TILE, m - im * GEMM_TILE);
+                uint64_t cols = std::min(GEMM_TILE, n - in * GEMM_TILE);
+                uint64_t depth = std::min(GEMM_TILE, k - ik * GEMM_TILE);
+                int64_t a_id = int64_t(im) * tk + ik;
+                int64_t w_id = order == LOOP_KMN ? int64_t(ik) * tn + in : int64_t(in) * tk + ik;
+                if (act[a_id % GEMM_ACT_BUF_TILES] != a_id) {
+                    act[a_id % GEMM_ACT_BUF_TILES] = a_id;
+                    bytes += rows * depth;
+                }
+                if (wgt[w_id % GEMM_WGT_BUF_TILES] != w_id) {
+                    wgt[w_id % GEMM_WGT_BUF_TILES] = w_id;
+                    bytes += depth * cols;
+                }
+            }
+        }
+    }
+    return bytes;
+}
+
+// DDR bytes of W[k,n] pre-tiled for GEMM_STREAM: for each N tile, for each
+// K tile, the tile's rows back to back, each padded to whole 8-byte beats
+inline uint64_t weight_stream_bytes(uint32_t k, uint32_t n) {
+    uint64_t bytes = 0;
+    for (uint32_t col = 0; col < n; col += GEMM_TILE) {
+        uint64_t row = (std::min(GEMM_TILE, n - col) + 7) / 8 * 8;
+        for (uint32_t depth = 0; depth < k; depth += GEMM_TILE) bytes += std::min(GEMM_TILE, k - depth) * row;
+    }
+    return bytes;
+}
+
+struct BlockConfig {
+    uint16_t seq_len = 16;
+    uint16_t hidden = 64;
+    uint16_t heads = 4;
+    uint16_t kv_heads = 0;           // K/V heads, dividing heads; 0 = heads (MHA), 1 = MQA
+    uint16_t ffn_mult = 4;
+    uint16_t staging_bytes = 16384;  // weight staging buffer when not streaming
+    bool stream_weights = true;      // non-resident weights: DMA_STREAM -> GEMM_STREAM
+    bool store_kv = false;           // DMA K and V to the DDR KV cache (prefill)
+    uint16_t window = 0;             // sliding-window attention: keys per query, itself included; 0 = all
+    bool decode = false;             // one token's step against the SRAM0 KV ring
+    uint32_t position = 0;           // decode: the token's position
+    uint16_t layers = 1;             // blocks run back to back, each with its own weights
+    uint32_t sram_bytes = SRAM0_BYTES;  // npu_top SRAM0_SIZE; banks above 64KB hold resident weights
+    bool call_layers = true;         // layers > 1: CALL one block body per layer instead of inlining
+    bool compact_ucode = true;       // pair eligible instructions in the compact 64-bit encoding
+};
+
+struct SramRegion {
+    std::string name;
+    uint32_t addr;
+    uint32_t size;
+};
+
+struct BlockProgram {
+    std::vector<Instruction> instrs;
+    Microcode ucode;                 // instrs encoded for ucode_base
+    std::vector<SramRegion> regions;
+    uint32_t ucode_base = 0;
+    uint32_t heads_per_batch = 1;    // attention heads per batched QK^T / PV
+    uint32_t sram_peak = 0;          // activations + resident weights + microcode
+    uint64_t weight_bytes = 0;       // per layer
+    uint64_t activation_bytes = 0;
+    uint64_t dma_bytes = 0;          // DDR traffic per program run
+    uint64_t preload_bytes = 0;      // resident weights and gamma/beta, loaded once
+    uint64_t kv_bytes = 0;           // K + V per layer for the sequence, or its decode KV ring
+    bool weights_resident = false;   // all layers' weights stay in SRAM0
+    bool weights_banked = false;     // ... in the banks above the first 64KB
+    bool weights_streamed = false;   // non-resident weights bypass SRAM0
+    bool fits_sram = false;          // layout fits SRAM0 at all
+
+    uint32_t region(const std::string& name) const {
+        for (const auto& r : regions) {
+            if (r.name == name) return r.addr;
+        }
+        return 0;
+    }
+};
+
+class BlockProgramBuilder {
+public:
+    explicit BlockProgramBuilder(const BlockConfig& cfg) : cfg_(cfg) {}
+
+    BlockProgram build() {
+        // The microcode footprint depends on how many weight chunks are
+        // streamed, which depends on the space left after the microcode.
+        uint32_t ucode_bytes = UCODE_REGION_BYTES;
+        for (int pass = 0; pass < 4; pass++) {
+            layout(ucode_bytes);
+            emit();
+            prog_.ucode = encode_microcode(prog_.instrs, cfg_.compact_ucode);
+            uint32_t needed = std::max<uint32_t>(UCODE_REGION_BYTES, prog_.ucode.bytes.size());
+            if (needed <= ucode_bytes) break;
+            ucode_bytes = needed;
+        }
+        return prog_;
+    }
+
+private:
+    uint32_t S() const { return cfg_.decode ? 1 : cfg_.seq_len; }  // rows per block
+    uint32_t H() const { return cfg_.hidden; }
+    uint32_t F() const { return uint32_t(cfg_.hidden) * cfg_.ffn_mult; }
+    uint32_t D() const { return cfg_.hidden / cfg_.heads; }
+    uint32_t KV() const { return cfg_.kv_heads ? cfg_.kv_heads : cfg_.heads; }
+    uint32_t R() const { return cfg_.heads / KV(); }  // query heads per K/V head
+    uint32_t KVD() const { return KV() * D(); }       // K (or V) columns
+    uint32_t slots() const { return cfg_.window ? cfg_.window : cfg_.seq_len; }  // decode KV ring
+
+    // Prefill with a window shorter than the sequence, on head-major Q/K/V
+    bool banded() const { return !cfg_.decode && cfg_.window && cfg_.window < S() && qkv_block_log2(); }
+    // Keys of the query block at row i0: from the window start of its
+    // first row, rounded down to a tile, through its last row
+    uint32_t band_start(uint32_t i0) const {
+        return i0 + 1 > cfg_.window ? (i0 + 1 - cfg_.window) / GEMM_TILE * GEMM_TILE : 0;
+    }
+    uint32_t band_width(uint32_t i0) const { return std::min(S(), i0 + GEMM_TILE) - band_start(i0); }
+
+    // SCORES/PROBS bytes per head of a batch
+    uint32_t score_slice() const {
+        if (cfg_.decode) return slots();
+        if (!banded()) return S() * S();
+        uint32_t widest = 0;
+        for (uint32_t i0 = 0; i0 < S(); i0 += GEMM_TILE) widest = std::max(widest, band_width(i0));
+        return std::min(GEMM_TILE, S()) * widest;
+    }
+
+    // log2(head_dim) for the QKV scatter epilogue, 0 if it cannot be used
+    uint8_t qkv_block_log2() const {
+        uint32_t d = D();
+        if (d == 0 || (d & (d - 1)) != 0) return 0;
+        uint8_t b = 0;
+        while ((1u << b) < d) b++;
+        return b <= 15 ? b : 0;
+    }
+
+    uint32_t alloc(const std::string& name, uint32_t size) {
+        uint32_t addr = next_;
+        prog_.regions.push_back({name, addr, size});
+        next_ = (next_ + size + 15) & ~15u;
+        return addr;
+    }
+
+    void layout(uint32_t ucode_bytes) {
+        prog_ = BlockProgram();
+        next_ = 0;
+        layer_stride_ = 0;
+        param_stride_ = 0;
+        prog_.ucode_base = (SRAM0_BYTES - ucode_bytes) & ~15u;
+        prog_.weight_bytes = uint64_t(H()) * (2 * H() + 2 * KVD()) + uint64_t(H()) * F() * 2;
+        prog_.kv_bytes = 2 * (cfg_.decode ? slots() : S()) * KVD();
+        // Per-layer rings and gamma/beta sets start 16-byte aligned: CALL
+        // frames count in 16-byte units
+        const uint32_t L = cfg_.layers;
+        ring_stride_ = (uint32_t(prog_.kv_bytes) + 15) & ~15u;
+        const uint32_t ring_bytes = cfg_.decode ? ring_stride_ * (L - 1) + uint32_t(prog_.kv_bytes) : 0;
+        const uint32_t ln_bytes = 4 * H();  // gamma1 | beta1 | gamma2 | beta2
+        const uint32_t ln_stride = (ln_bytes + 15) & ~15u;
+
+        // DMA-written buffers first so they stay clear of the microcode
+        // even when the rest of the layout overflows
+        alloc("INPUT", S() * H());
+        auto act_bytes = [&](uint32_t g) {
+            return S() * H() * 5 + (cfg_.decode ? ring_bytes : uint32_t(prog_.kv_bytes)) + 2 * g * score_slice() +
+                   S() * F();
+        };
+        auto free_after = [&](uint32_t g) {
+            return prog_.ucode_base > next_ + act_bytes(g) ? prog_.ucode_base - next_ - act_bytes(g) : 0;
+        };
+        // Every layer's weights and gamma/beta next to the activations, or
+        // else in the banks past bank 0
+        const uint64_t model_bytes = L * (prog_.weight_bytes + ln_bytes);
+        const uint32_t upper_bytes = cfg_.sram_bytes > SRAM0_BYTES ? cfg_.sram_bytes - SRAM0_BYTES : 0;
+        prog_.weights_resident = model_bytes <= free_after(1);
+        prog_.weights_banked = !prog_.weights_resident && model_bytes + 16 * L <= upper_bytes;
+        prog_.weights_resident = prog_.weights_resident || prog_.weights_banked;
+        // Several resident layers keep gamma/beta with their weights, so
+        // one stride (one CALL frame) moves both
+        const bool ln_with_weights = prog_.weights_banked || (prog_.weights_resident && L > 1);
+        if (!ln_with_weights) {
+            alloc("LN_PARAMS", ln_stride * (L - 1) + ln_bytes);
+            param_stride_ = ln_stride;
+        }
+        // GEMM_STREAM keeps partial sums for a whole column of C tiles
+        prog_.weights_streamed = !prog_.weights_resident && cfg_.stream_weights &&
+                                 S() <= GEMM_TILE * GEMM_ACC_BUF_TILES;
+
+        // Batch as many heads as fit without costing the weights anything:
+        // they stay resident, or keep the staging buffer they would get.
+        // Under GQA a group is whole K/V heads' worth of query heads, or a
+        // single head. Decode always runs all heads at once.
+        uint32_t g = cfg_.decode || qkv_block_log2() ? cfg_.heads : 1;
+        const uint32_t staging = std::max<uint32_t>(std::min<uint32_t>(cfg_.staging_bytes, free_after(1)), F() * 16);
+        const uint64_t keep = prog_.weights_banked    ? 0
+                              : ln_with_weights        ? model_bytes
+                              : prog_.weights_resident ? prog_.weight_bytes
+                              : prog_.weights_streamed ? 0
+                                                       : staging;
+        while (!cfg_.decode && g > 1 && free_after(g) < keep) g = (g % (2 * R()) == 0) ? g / 2 : g > R() ? R() : 1;
+        prog_.heads_per_batch = g;
+        prog_.activation_bytes = S() * H() + act_bytes(g);
+
+        uint32_t free_bytes = free_after(g);
+        if (!prog_.weights_resident && !prog_.weights_streamed) {
+            // Staging must hold at least one 16-column block of the deepest weight
+            staging_bytes_ = std::max<uint32_t>(std::min<uint32_t>(cfg_.staging_bytes, free_bytes), F() * 16);
+            alloc("W_STAGING", staging_bytes_);
+        }
+
+        // LayerNorm writes SRAM0 too, so its output comes next. LN1's
+        // output is dead after the Q/K/V GEMMs, so LN2 reuses it.
+        alloc("LN_OUT", S() * H());
+
+        if (cfg_.decode) {
+            alloc("QKV", H());  // Q; the token's K/V go to the ring
+            alloc("KV_RING", ring_bytes);  // one ring per layer
+        } else {
+            alloc("QKV", S() * (H() + 2 * KVD()));  // Q | K | V, head-major when fused
+        }
+        alloc("SCORES", g * score_slice());
+        alloc("PROBS", g * score_slice());
+        alloc("CONTEXT", S() * H());
+        alloc("RESIDUAL1", S() * H());
+        alloc("FFN_INTER", S() * F());
+        alloc("OUTPUT", S() * H());
+        const uint32_t bank0_end = next_;
+        if (prog_.weights_resident) {
+            // Layer 0's block; layer l's sits l * layer_stride_ above it
+            if (prog_.weights_banked) next_ = SRAM0_BYTES;
+            const uint32_t first = next_;
+            if (ln_with_weights) alloc("LN_PARAMS", ln_bytes);
+            alloc("W_QKV", H() * (H() + 2 * KVD()));
+            alloc("W_O", H() * H());
+            alloc("W_UP", H() * F());
+            alloc("W_DOWN", F() * H());
+            layer_stride_ = next_ - first;
+            if (ln_with_weights) param_stride_ = layer_stride_;
+            next_ += (L - 1) * layer_stride_;
+            prog_.preload_bytes = model_bytes;
+        }
+
+        prog_.sram_peak = bank0_end + (SRAM0_BYTES - prog_.ucode_base);
+        if (prog_.weights_banked) prog_.sram_peak += next_ - SRAM0_BYTES;
+        else if (prog_.weights_resident) prog_.sram_peak += next_ - bank0_end;
+        prog_.fits_sram = (prog_.weights_banked ? bank0_end : next_) <= prog_.ucode_base;
+    }
+
+    // SRAM0 addresses may exceed 16 bits: their high bits go to the
+    // field's base register, loaded by an SRAM_BASE when they change. A
+    // 64KB SRAM0 leaves them at 0, and an overflowing layout wraps as it
+    // always has. A called body's operands carry their Frame above
+    // FRAME_SHIFT, which goes to the same register (DDR fields only use
+    // the frame).
+    void push(uint8_t op, uint32_t dst, uint32_t src0, uint32_t src1, uint32_t m, uint32_t n, uint32_t k,
+              uint8_t flags = 0, uint16_t imm = 0) {
+        const uint32_t field[3] = {dst, src0, src1};
+        const uint8_t sram = sram_address_fields(op), ddr = ddr_address_fields(op);
+        const bool banks = cfg_.sram_bytes > SRAM0_BYTES;
+        uint16_t base[3];
+        uint8_t load = 0;
+        for (int f = 0; f < 3; f++) {
+            const uint8_t frame = uint8_t(field[f] >> FRAME_SHIFT);
+            base[f] = base_[f];
+            if (sram >> f & 1) base[f] = sram_base(banks ? uint16_t((field[f] & ADDR_MASK) >> 16) : 0, frame);
+            else if (ddr >> f & 1) base[f] = sram_base(base_[f], frame);
+            if (base[f] != base_[f]) load |= uint8_t(1 << f);
+        }
+        if (load) set_base(load, base);
+        prog_.instrs.push_back({op, flags, uint16_t(dst), uint16_t(src0), uint16_t(src1), uint16_t(m),
+                                uint16_t(n), uint16_t(k), imm});
+    }
+
+    void set_base(uint8_t load, const uint16_t base[3]) {
+        for (int f = 0; f < 3; f++) {
+            if (load >> f & 1) base_[f] = base[f];
+        }
+        prog_.instrs.push_back({OP_SRAM_BASE, load, uint16_t(load & BASE_DST ? base[0] : 0),
+                                uint16_t(load & BASE_SRC0 ? base[1] : 0), uint16_t(load & BASE_SRC1 ? base[2] : 0),
+                                0, 0, 0, 0});
+    }
+
+    // GEMM_ORDER and the base registers back to their reset values
+    void reset_state() {
+        if (order_ != LOOP_MNK) push(OP_GEMM_ORDER, 0, 0, 0, 0, 0, 0, 0, LOOP_MNK);
+        order_ = LOOP_MNK;
+        if (base_[0] || base_[1] || base_[2]) {
+            const uint16_t zero[3] = {0, 0, 0};
+            set_base(BASE_DST | BASE_SRC0 | BASE_SRC1, zero);
+        }
+    }
+
+    // A called body tags layer 0's operand with the frame its CALL
+    // relocates it by; inlined layers already address layer l
+    uint32_t frame(uint32_t addr, uint8_t f) const { return body_ ? addr | uint32_t(f) << FRAME_SHIFT : addr; }
+
+    void barrier() { push(OP_BARRIER, 0, 0, 0, 0, 0, 0); }
+
+    // DDR offsets are 16-bit and wrap; timing does not depend on them
+    void dma(uint8_t op, uint32_t sram, uint32_t ddr, uint32_t bytes) {
+        for (uint32_t done = 0; done < bytes; done += MAX_DMA_CHUNK) {
+            uint32_t chunk = std::min(MAX_DMA_CHUNK, bytes - done);
+            if (op == OP_DMA_LOAD) push(op, sram + done, ddr + done, 0, chunk, 0, 0);
+            else push(op, ddr + done, sram + done, 0, chunk, 0, 0);
+            prog_.dma_bytes += chunk;
+        }
+    }
+
+    void elementwise(uint8_t op, uint32_t dst, uint32_t src0, uint32_t src1, uint32_t count) {
+        for (uint32_t done = 0; done < count; done += MAX_ELEMENTWISE) {
+            uint32_t chunk = std::min(MAX_ELEMENTWISE, count - done);
+            push(op, dst + done, src0 + done, src1 ? src1 + done : 0, 1, chunk, 0);
+        }
+    }
+
+    // C[m,n] = A[m,k] x W[k,n]; W is resident at w_addr, streamed from DDR
+    // (w_ddr) into the weight FIFO, or staged through SRAM0 in 16-column
+    // multiples. block_log2 > 0 scatters C in 2^block_log2-column blocks;
+    // staged chunks then start on a block boundary. A residual (laid out
+    // like C) is added to C by the GEMM epilogue.
+    void weight_gemm(uint32_t dst, uint32_t a, uint32_t w_addr, uint32_t w_ddr, uint32_t m, uint32_t k,
+                     uint32_t n, uint8_t block_log2 = 0, uint32_t residual = NO_RESIDUAL) {
+        uint8_t flags = uint8_t(block_log2 << 4);
+        auto add_residual = [&](uint32_t offset) {
+            if (residual != NO_RESIDUAL) push(OP_GEMM_RESIDUAL, 0, residual + offset, 0, 0, 0, 0);
+        };
+        if (prog_.weights_resident) {
+            loop_order(m, k, n);
+            add_residual(0);
+            push(OP_GEMM, dst, a, w_addr, m, n, k, flags);
+            return;
+        }
+        if (prog_.weights_streamed) {
+            // The DMA runs ahead of the GEMM by the FIFO depth; GEMM_STREAM
+            // walks its own tile order, so GEMM_ORDER does not apply
+            uint32_t bytes = uint32_t(weight_stream_bytes(k, n));
+            push(OP_DMA_STREAM, 0, (w_ddr & ~ADDR_MASK) | (w_ddr & 0xFFFF), (w_ddr & ADDR_MASK) >> 16,
+                 bytes & 0xFFFF, bytes >> 16, 0);
+            add_residual(0);
+            push(OP_GEMM_STREAM, dst, a, 0, m, n, k, flags);
+            prog_.dma_bytes += bytes;
+            return;
+        }
+        uint32_t staging = prog_.region("W_STAGING");
+        uint32_t align = std::max<uint32_t>(16, 1u << block_log2);
+        uint32_t cols = std::max<uint32_t>(align, (staging_bytes_ / k) / align * align);
+        for (uint32_t col = 0; col < n; col += cols) {
+            uint32_t width = std::min(cols, n - col);
+            uint32_t chunk_dst = block_log2 ? dst + (((col >> block_log2) * m) << block_log2) : dst + col;
+            dma(OP_DMA_LOAD, staging, w_ddr + col * k, width * k);
+            barrier();
+            loop_order(m, k, width);
+            add_residual(chunk_dst - dst);
+            push(OP_GEMM, chunk_dst, a, staging, m, width, k, flags);
+            barrier();
+        }
+    }
+
+    // DDR bytes of a [k, n] weight: pre-tiled when streamed
+    uint32_t w_bytes(uint32_t k, uint32_t n) const {
+        return prog_.weights_streamed ? uint32_t(weight_stream_bytes(k, n)) : k * n;
+    }
+
+    // Switch to the loop order that reads the fewest operand bytes
+    void loop_order(uint32_t m, uint32_t k, uint32_t n) {
+        int best = order_;
+        for (int order : {LOOP_MNK, LOOP_NMK, LOOP_KMN}) {
+            if (gemm_operand_reads(m, k, n, order) < gemm_operand_reads(m, k, n, best)) best = order;
+        }
+        if (best != order_) {
+            push(OP_GEMM_ORDER, 0, 0, 0, 0, 0, 0, 0, uint16_t(best));
+            order_ = best;
+        }
+    }
+
+    // Prefill: Q/K/V for the whole sequence, then attention per head group
+    void prefill_attention(uint32_t ln, uint32_t q, uint32_t scores, uint32_t probs, uint32_t ctx, uint32_t w_qkv,
+                           uint32_t ddr_qkv, uint32_t ddr_kv) {
+        const uint32_t k = q + S() * H(), v = k + S() * KVD();
+        // W_QKV is [H, H + 2*KV*D] resident and column-block-major in DDR,
+        // so the fused GEMM and its staged chunks see Q|K|V columns in order
+        const uint8_t block_log2 = qkv_block_log2();
+        uint32_t head_stride = D();  // row-major Q/K/V: head h starts at column h*D
+        if (block_log2) {
+            weight_gemm(q, ln, w_qkv, ddr_qkv, S(), H(), H() + 2 * KVD(), block_log2);
+            head_stride = S() * D();  // head-major: [S, D] per head
+        } else {
+            weight_gemm(q, ln, w_qkv, ddr_qkv, S(), H(), H());
+            weight_gemm(k, ln, w_qkv + H() * H(), ddr_qkv + w_bytes(H(), H()), S(), H(), KVD());
+            weight_gemm(v, ln, w_qkv + H() * (H() + KVD()), ddr_qkv + w_bytes(H(), H()) + w_bytes(H(), KVD()),
+                        S(), H(), KVD());
+        }
+        barrier();
+        // K|V is contiguous; the cache write overlaps the attention GEMMs
+        if (cfg_.store_kv) dma(OP_DMA_STORE, k, ddr_kv, 2 * S() * KVD());
+        const uint32_t g = prog_.heads_per_batch, r = R();
+        for (uint32_t h = 0; h < cfg_.heads; h += g) {
+            if (banded()) {
+                band_attention(h, q, k, v, scores, probs, ctx);
+                continue;
+            }
+            uint32_t qh = q + h * head_stride, kh = k + (h / r) * head_stride, vh = v + (h / r) * head_stride;
+            if (g == 1) {
+                push(OP_GEMM, scores, qh, kh, S(), S(), D(), 0x01);  // Q_h x K_h^T
+                barrier();
+                push(OP_SOFTMAX, probs, scores, 0, S(), S(), cfg_.window, 0x01);  // causal
+                barrier();
+                push(OP_GEMM, ctx + h * D(), probs, vh, S(), D(), S());
+                barrier();
+                continue;
+            }
+            // Q_h x K_h^T for g heads, the r heads sharing a K head stacked
+            // along M; head j's scores at scores + j*S*S
+            const uint32_t groups = g / r;
+            if (groups > 1) {
+                push(OP_GEMM_BATCH, r * S() * S(), r * S() * D(), S() * D(), groups, 0, 0);
+                push(OP_GEMM, scores, qh, kh, r * S(), S(), D(), 0x01 | 0x08);  // TRANSPOSE_B | BATCHED
+            } else {
+                push(OP_GEMM, scores, qh, kh, r * S(), S(), D(), 0x01);
+            }
+            barrier();
+            for (uint32_t j = 0; j < g; j++) {
+                push(OP_SOFTMAX, probs + j * S() * S(), scores + j * S() * S(), 0, S(), S(), cfg_.window,
+                     0x01);  // causal
+            }
+            barrier();
+            // P_h x V_h, written as head h's D columns of the [S, H] context.
+            // Heads sharing a V head batch over it with a B stride of 0.
+            if (r == 1) {
+                push(OP_GEMM_BATCH, D(), S() * S(), S() * D(), g, H(), 0);
+                push(OP_GEMM, ctx + h * D(), probs, vh, S(), D(), S(), 0x08);  // BATCHED
+            } else {
+                for (uint32_t j = 0; j < groups; j++) {
+                    push(OP_GEMM_BATCH, D(), S() * S(), 0, r, H(), 0);
+                    push(OP_GEMM, ctx + (h + j * r) * D(), probs + j * r * S() * S(), vh + j * S() * D(), S(), D(),
+                         S(), 0x08);
+                }
+            }
+            barrier();
+        }
+    }
+
+    // Sliding-window prefill for heads h..h+g-1 (head-major Q/K/V). Each
+    // GEMM_TILE-row query block scores only its band of keys. A batch
+    // covers the group's heads (MHA) or the r query heads of one K/V head,
+    // which share its K and V with a B stride of 0.
+    void band_attention(uint32_t h, uint32_t q, uint32_t k, uint32_t v, uint32_t scores, uint32_t probs,
+                        uint32_t ctx) {
+        const uint32_t g = prog_.heads_per_batch, r = R(), hs = S() * D();
+        const uint32_t b = r == 1 ? g : std::min(r, g), kv_stride = r == 1 ? hs : 0;
+        for (uint32_t i0 = 0; i0 < S(); i0 += GEMM_TILE) {
+            const uint32_t rows = std::min(GEMM_TILE, S() - i0), k0 = band_start(i0), nb = band_width(i0);
+            const uint32_t slice = rows * nb;
+            for (uint32_t j = 0; j < g; j += b) {
+                const uint32_t qj = q + (h + j) * hs + i0 * D(), kj = k + (h + j) / r * hs + k0 * D();
+                if (b > 1) push(OP_GEMM_BATCH, slice, hs, kv_stride, b, 0, 0);
+                push(OP_GEMM, scores + j * slice, qj, kj, rows, nb, D(), b > 1 ? 0x01 | 0x08 : 0x01);
+            }
+            barrier();
+            // Causal within the window; row 0 is query position i0
+            for (uint32_t j = 0; j < g; j++) {
+                push(OP_SOFTMAX, probs + j * slice, scores + j * slice, 0, rows, nb, cfg_.window, 0x01,
+                     uint16_t(i0 - k0));
+            }
+            barrier();
+            // Rows i0.. of each head's D context columns
+            for (uint32_t j = 0; j < g; j += b) {
+                const uint32_t vj = v + (h + j) / r * hs + k0 * D();
+                push(OP_GEMM_BATCH, D(), slice, kv_stride, b, H(), 0);
+                push(OP_GEMM, ctx + i0 * H() + (h + j) * D(), probs + j * slice, vj, rows, D(), nb, 0x08);
+            }
+            barrier();
+        }
+    }
+
+    // Decode: the token's K/V rows go straight into ring slot
+    // position % slots of each K/V head, then its queries attend over the
+    // ring's valid slots. A K/V head's r query heads are adjacent in Q, so
+    // they stack along M as in prefill.
+    void decode_attention(uint32_t ln, uint32_t q, uint32_t ring, uint32_t scores, uint32_t probs, uint32_t ctx,
+                          uint32_t w_qkv, uint32_t ddr_qkv) {
+        const uint32_t C = slots(), slot = cfg_.position % C, n = std::min(cfg_.position + 1, C);
+        const uint32_t r = R(), head_ring = C * D();  // [slots, head_dim] per K/V head
+        const uint32_t k = ring, v = ring + KV() * head_ring;
+        const uint32_t w_kv = w_qkv + H() * H(), ddr_kv = ddr_qkv + w_bytes(H(), H());
+        weight_gemm(q, ln, w_qkv, ddr_qkv, 1, H(), H());
+        for (uint32_t j = 0; j < 2 * KV(); j++) {  // K heads, then V heads
+            weight_gemm(ring + j * head_ring + slot * D(), ln, w_kv + j * H() * D(), ddr_kv + j * w_bytes(H(), D()),
+                        1, H(), D());
+        }
+        barrier();
+        if (KV() > 1) push(OP_GEMM_BATCH, r * n, r * D(), head_ring, KV(), 0, 0);
+        push(OP_GEMM, scores, q, k, r, n, D(), KV() > 1 ? 0x01 | 0x08 : 0x01);
+        barrier();
+        push(OP_SOFTMAX, probs, scores, 0, cfg_.heads, n, 0, 0);  // every valid slot is in the window
+        barrier();
+        if (KV() > 1) push(OP_GEMM_BATCH, r * D(), r * n, head_ring, KV(), 0, 0);
+        push(OP_GEMM, ctx, probs, v, r, D(), n, KV() > 1 ? 0x08 : 0);
+        barrier();
+    }
+
+    void emit() {
+        const BlockProgram& p = prog_;
+        order_ = LOOP_MNK;
+        std::fill(std::begin(base_), std::end(base_), uint16_t(0));
+        body_ = false;
+        const uint32_t in = p.region("INPUT"), out = p.region("OUTPUT");
+
+        // DDR layout: [input | output | per layer: W_QKV | W_O | W_UP |
+        // W_DOWN | K | V], the weights pre-tiled when streamed. Decode
+        // reads W_K / W_V as one [H, head_dim] block per K/V head.
+        const uint32_t ddr_in = 0, ddr_out = S() * H();
+        const uint32_t ddr_layers = 2 * S() * H();
+
+        dma(OP_DMA_LOAD, in, ddr_in, S() * H());
+        barrier();
+        // Called layers share one body after END. Each CALL loads the
+        // layer's frames: weights and gamma/beta, its input (INPUT for
+        // layer 0, OUTPUT after), its decode KV ring and its DDR block.
+        std::vector<size_t> calls;
+        if (cfg_.layers > 1 && cfg_.call_layers) {
+            for (uint32_t l = 0; l < cfg_.layers; l++) {
+                const uint32_t act = l ? out - in : 0, ddr = l * ddr_layer_stride();
+                calls.push_back(prog_.instrs.size());
+                push(OP_CALL, l * param_stride_ / 16, act / 16, l * ring_stride_ / 16, ddr & 0xFFFF, ddr >> 16, 0,
+                     CALL_WEIGHT | CALL_ACT | CALL_KV | CALL_DDR);  // imm patched below
+            }
+        } else {
+            for (uint32_t l = 0; l < cfg_.layers; l++) layer(l, l ? out : in, ddr_layers + l * ddr_layer_stride());
+        }
+        dma(OP_DMA_STORE, out, ddr_out, S() * H());
+        barrier();
+        reset_state();
+        push(OP_END, 0, 0, 0, 0, 0, 0);
+        if (calls.empty()) return;
+
+        // The body, run once per CALL: its DMA traffic counts every time
+        const uint16_t body = uint16_t(prog_.instrs.size());
+        const uint64_t dma_before = prog_.dma_bytes;
+        body_ = true;
+        layer(0, in, ddr_layers);
+        reset_state();
+        push(OP_RET, 0, 0, 0, 0, 0, 0);
+        body_ = false;
+        prog_.dma_bytes += (cfg_.layers - 1) * (prog_.dma_bytes - dma_before);
+        for (size_t c : calls) prog_.instrs[c].imm = body;
+    }
+
+    // DDR bytes of W_QKV (W_Q and per-head W_K / W_V blocks for decode),
+    // of a layer's weights: W_QKV | W_O | W_UP | W_DOWN, and of its whole
+    // block, with K | V
+    uint32_t ddr_qkv_bytes() const {
+        return cfg_.decode        ? w_bytes(H(), H()) + 2 * KV() * w_bytes(H(), D())
+               : qkv_block_log2() ? w_bytes(H(), H() + 2 * KVD())
+                                  : w_bytes(H(), H()) + 2 * w_bytes(H(), KVD());
+    }
+    uint32_t ddr_layer_bytes() const {
+        return ddr_qkv_bytes() + w_bytes(H(), H()) + w_bytes(H(), F()) + w_bytes(F(), H());
+    }
+    uint32_t ddr_layer_stride() const { return ddr_layer_bytes() + 2 * S() * KVD(); }
+
+    // One transformer block reading x, writing OUTPUT, with its DDR block
+    // at ddr_qkv. Resident weights of layer l sit l strides above layer
+    // 0's, and its gamma/beta l parameter strides. Every layer after the
+    // first reads the previous layer's OUTPUT in place. Both residual adds
+    // are GEMM epilogues (GEMM_RESIDUAL), so the projection outputs never
+    // exist on their own.
+    void layer(uint32_t l, uint32_t x, uint32_t ddr_qkv) {
+        const BlockProgram& p = prog_;
+        const uint32_t w_off = l * layer_stride_;
+        const uint32_t ddr_kv = frame(ddr_qkv + ddr_layer_bytes(), FRAME_KV);
+        x = frame(x, FRAME_ACT);
+        ddr_qkv = frame(ddr_qkv, FRAME_WEIGHT);
+        uint32_t ln1 = p.region("LN_OUT"), ln2 = ln1;
+        uint32_t q = p.region("QKV");
+        uint32_t scores = p.region("SCORES"), probs = p.region("PROBS");
+        uint32_t ctx = p.region("CONTEXT"), res1 = p.region("RESIDUAL1"), inter = p.region("FFN_INTER");
+        uint32_t out = p.region("OUTPUT");
+        uint32_t w_qkv = frame(p.region("W_QKV") + w_off, FRAME_WEIGHT);
+        uint32_t w_o = frame(p.region("W_O") + w_off, FRAME_WEIGHT);
+        uint32_t w_up = frame(p.region("W_UP") + w_off, FRAME_WEIGHT);
+        uint32_t w_down = frame(p.region("W_DOWN") + w_off, FRAME_WEIGHT);
+        uint32_t ln_params = frame(p.region("LN_PARAMS") + l * param_stride_, FRAME_WEIGHT);
+
+        uint32_t ddr_o = ddr_qkv + ddr_qkv_bytes();
+        uint32_t ddr_up = ddr_o + w_bytes(H(), H()), ddr_down = ddr_up + w_bytes(H(), F());
+
+        // Attention
+        push(OP_LAYERNORM, ln1, x, ln_params, S(), H(), 0);
+        barrier();
+        if (cfg_.decode) {
+            uint32_t ring = frame(p.region("KV_RING") + l * ring_stride_, FRAME_KV);
+            decode_attention(ln1, q, ring, scores, probs, ctx, w_qkv, ddr_qkv);
+        } else {
+            prefill_attention(ln1, q, scores, probs, ctx, w_qkv, ddr_qkv, ddr_kv);
+        }
+        weight_gemm(res1, ctx, w_o, ddr_o, S(), H(), H(), 0, x);  // x + attn
+        barrier();
+
+        // FFN
+        push(OP_LAYERNORM, ln2, res1, ln_params + 2 * H(), S(), H(), 0);
+        barrier();
+        weight_gemm(inter, ln2, w_up, ddr_up, S(), H(), F());
+        barrier();
+        elementwise(OP_GELU, inter, inter, 0, S() * F());
+        barrier();
+        weight_gemm(out, inter, w_down, ddr_down, S(), F(), H(), 0, res1);  // RESIDUAL1 + ffn
+        barrier();
+    }
+
+    BlockConfig cfg_;
+    BlockProgram prog_;
+    uint32_t next_ = 0;
+    uint32_t staging_bytes_ = 0;
+    uint32_t layer_stride_ = 0;  // resident weights (and gamma/beta kept with them) per layer
+    uint32_t param_stride_ = 0;  // a layer's gamma/beta: layer_stride_ or one padded set
+    uint32_t ring_stride_ = 0;   // decode KV ring per layer, padded to 16 bytes
+    bool body_ = false;          // emitting the CALLed block body
+    int order_ = LOOP_MNK;  // GEMM_ORDER in effect at this point of the program
+    uint16_t base_[3] = {};  // SRAM_BASE dst/src0/src1 in effect
+};
+
+inline BlockProgram build_block_program(const BlockConfig& cfg) {
+    return BlockProgramBuilder(cfg).build();
+}
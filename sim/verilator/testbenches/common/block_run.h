@@ -0,0 +1,122 @@
+#pragma once
+// Runs a BlockConfig's program on an npu_top model and compares two runs.
+// Harnesses that check two encodings of the same block (inlined vs CALLed
+// layers, full vs compact microcode) run each from the same random DDR
+// contents, then require the engines to see the same command stream
+// (GEMM, LayerNorm and DMA addresses, in order) and DDR and SRAM0 outside
+// the microcode to end up identical.
+//
+// The harness must include the model's headers ("Vnpu_top.h" and
+// "Vnpu_top___024root.h") for the public signals and SRAM0 contents.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "common/axi_ddr_model.h"
+#include "common/block_program.h"
+#include "common/npu_driver.h"
+#include "common/npu_utils.h"
+
+// Engine start as seen by the testbench: the operand addresses it was given
+struct BlockCommand {
+    uint8_t engine;
+    uint32_t a, b, c, d;
+
+    bool operator==(const BlockCommand& o) const {
+        return engine == o.engine && a == o.a && b == o.b && c == o.c && d == o.d;
+    }
+};
+
+struct BlockRun {
+    BlockProgram prog;
+    std::vector<BlockCommand> commands;
+    std::vector<uint8_t> ddr;
+    std::vector<uint8_t> sram0;
+    uint64_t cycles = 0;
+    bool done = false;
+};
+
+// Build cfg's program and run it with DDR filled from `seed`. DDR sits at
+// address 0 and runs longer than `max_cycles` leave done false.
+template <typename Top>
+inline BlockRun run_block(const BlockConfig& cfg, uint32_t seed, int max_cycles) {
+    BlockRun r;
+    r.prog = build_block_program(cfg);
+    AxiDdrModel<Top> ddr;
+    NpuDriver<Top> npu;
+
+    std::mt19937 rng(seed);
+    const uint32_t ddr_size = DdrConfig().size;
+    for (uint32_t i = 0; i < ddr_size; i++) ddr.byte(i) = uint8_t(rng());
+
+    npu.reset(10);
+    npu.toggle();
+    npu.write_reg(REG_DDR_BASE, 0);
+    npu.load_microcode(r.prog.ucode_base, r.prog.ucode);
+    npu.start(r.prog.ucode_base, r.prog.ucode.slots());
+
+    r.cycles = npu.run_until_done(max_cycles, [&](Top* top) {
+        ddr.step(top);
+        auto* root = top->rootp;
+        if (root->npu_top__DOT__gemm_start) {
+            r.commands.push_back({ENGINE_GEMM, root->npu_top__DOT__gemm_src_a, root->npu_top__DOT__gemm_src_b,
+                                  root->npu_top__DOT__gemm_dst,
+                                  root->npu_top__DOT__gemm_residual_en ? root->npu_top__DOT__gemm_residual : 0u});
+        }
+        if (root->npu_top__DOT__layernorm_start) {
+            r.commands.push_back({ENGINE_LAYERNORM, root->npu_top__DOT__layernorm_src,
+                                  root->npu_top__DOT__layernorm_dst, root->npu_top__DOT__layernorm_param, 0});
+        }
+        if (root->npu_top__DOT__dma_start) {
+            r.commands.push_back({ENGINE_DMA, root->npu_top__DOT__dma_direction, root->npu_top__DOT__dma_ddr_offset,
+                                  root->npu_top__DOT__dma_stream ? 0u : root->npu_top__DOT__dma_sram_addr,
+                                  root->npu_top__DOT__dma_stream});
+        }
+    });
+    r.done = npu->done;
+
+    r.ddr.resize(ddr_size);
+    for (uint32_t i = 0; i < ddr_size; i++) r.ddr[i] = ddr.byte(i);
+    auto& mem = npu->rootp->npu_top__DOT__sram__DOT__sram0__DOT__mem;
+    r.sram0.resize(SRAM0_BYTES);
+    for (uint32_t i = 0; i < SRAM0_BYTES; i++) r.sram0[i] = mem[i];
+    return r;
+}
+
+inline bool in_ucode(const BlockProgram& prog, uint32_t addr) {
+    return addr >= prog.ucode_base && addr < prog.ucode_base + prog.ucode.bytes.size();
+}
+
+// Number of differences between two finished runs; the first few are
+// printed, labelled with each run's name
+inline int diff_block_runs(const BlockRun& a, const char* a_name, const BlockRun& b, const char* b_name) {
+    int errors = 0;
+    if (a.commands.size() != b.commands.size()) {
+        std::cout << "  " << a.commands.size() << " engine commands " << a_name << ", " << b.commands.size() << " "
+                  << b_name << std::endl;
+        errors++;
+    }
+    for (size_t i = 0; i < std::min(a.commands.size(), b.commands.size()); i++) {
+        const BlockCommand& x = a.commands[i];
+        const BlockCommand& y = b.commands[i];
+        if (!(x == y) && errors++ < 5) {
+            std::cout << "  command " << i << " (" << engine_name(x.engine) << "): " << a_name << " 0x" << std::hex
+                      << x.a << "/0x" << x.b << "/0x" << x.c << "/0x" << x.d << ", " << b_name << " 0x" << y.a
+                      << "/0x" << y.b << "/0x" << y.c << "/0x" << y.d << std::dec << std::endl;
+        }
+    }
+    for (size_t i = 0; i < a.ddr.size(); i++) {
+        if (a.ddr[i] != b.ddr[i] && errors++ < 5) {
+            std::cout << "  DDR[0x" << std::hex << i << "] differs" << std::dec << std::endl;
+        }
+    }
+    for (uint32_t i = 0; i < SRAM0_BYTES; i++) {
+        if (in_ucode(a.prog, i) || in_ucode(b.prog, i)) continue;
+        if (a.sram0[i] != b.sram0[i] && errors++ < 5) {
+            std::cout << "  SRAM0[0x" << std::hex << i << "] differs" << std::dec << std::endl;
+        }
+    }
+    return errors;
+}
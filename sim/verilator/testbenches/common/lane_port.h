@@ -0,0 +1,23 @@
+#pragma once
+// Accessors for packed LANES x 8-bit engine ports (lane 0 in the low byte).
+// Verilator maps the port to CData, IData or VlWide<N> depending on LANES.
+
+#include <cstddef>
+#include <cstdint>
+#include <verilated.h>
+
+inline void set_lane(CData& port, int, uint8_t v) { port = v; }
+inline void set_lane(IData& port, int l, uint8_t v) {
+    port = (port & ~(0xFFu << (8 * l))) | (IData(v) << (8 * l));
+}
+template <std::size_t N>
+void set_lane(VlWide<N>& port, int l, uint8_t v) {
+    port[l / 4] = (port[l / 4] & ~(0xFFu << (8 * (l % 4)))) | (uint32_t(v) << (8 * (l % 4)));
+}
+
+inline uint8_t get_lane(CData port, int) { return port; }
+inline uint8_t get_lane(IData port, int l) { return uint8_t(port >> (8 * l)); }
+template <std::size_t N>
+uint8_t get_lane(const VlWide<N>& port, int l) {
+    return uint8_t(port[l / 4] >> (8 * (l % 4)));
+}
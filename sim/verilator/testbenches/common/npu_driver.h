@@ -0,0 +1,139 @@
+#pragma once
+// Common driver for Verilated npu_top models.
+// Owns the model and wraps clocking, reset and AXI4-Lite register writes so
+// each top-level harness only describes its own stimulus. Templated on the
+// Verilated class so parameterized variants of npu_top can reuse it.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "common/npu_utils.h"
+#include "common/perf_report.h"
+
+// AXI4-Lite register offsets (see npu_regs in rtl/npu_top.sv)
+enum NpuReg : uint32_t {
+    REG_CTRL       = 0x00,
+    REG_STATUS     = 0x04,
+    REG_UCODE_BASE = 0x08,
+    REG_UCODE_LEN  = 0x0C,
+    REG_DDR_BASE   = 0x14,
+    REG_EXEC_MODE  = 0x38
+};
+
+template <typename Top>
+class NpuDriver {
+public:
+    NpuDriver() : top_(new Top) {}
+
+    ~NpuDriver() {
+        top_->final();
+        delete top_;
+    }
+
+    NpuDriver(const NpuDriver&) = delete;
+    NpuDriver& operator=(const NpuDriver&) = delete;
+
+    Top* top() { return top_; }
+    Top* operator->() { return top_; }
+
+    // Half clock period
+    void toggle() {
+        top_->clk = !top_->clk;
+        top_->eval();
+    }
+
+    // Full clock period
+    void tick() {
+        toggle();
+        toggle();
+        cycles_++;
+    }
+
+    // Hold reset for the given number of clock toggles, then release it
+    void reset(int toggles = 10) {
+        top_->clk = 0;
+        top_->rst_n = 0;
+        top_->eval();
+        for (int i = 0; i < toggles; i++) toggle();
+        top_->rst_n = 1;
+    }
+
+    // Single-cycle AXI4-Lite write (npu_regs is always ready)
+    void write_reg(uint32_t addr, uint32_t data) {
+        top_->s_axi_awvalid = 1;
+        top_->s_axi_awaddr = addr;
+        top_->s_axi_wvalid = 1;
+        top_->s_axi_wdata = data;
+        top_->s_axi_wstrb = 0xF;
+        top_->s_axi_bready = 1;
+        tick();
+        top_->s_axi_awvalid = 0;
+        top_->s_axi_wvalid = 0;
+    }
+
+    // Program the microcode window and pulse start. CTRL.start is edge
+    // triggered, so it is cleared first to allow back-to-back runs.
+    void start(uint32_t ucode_base, uint32_t ucode_len) {
+        write_reg(REG_UCODE_BASE, ucode_base);
+        write_reg(REG_UCODE_LEN, ucode_len);
+        write_reg(REG_CTRL, 0x00);
+        write_reg(REG_CTRL, 0x01);
+    }
+
+    // Backdoor-write bytes into SRAM0 without going through DMA. Only
+    // instantiated when used; the harness must include the model's root
+    // header (e.g. "Vnpu_top___024root.h").
+    void write_sram0(uint32_t addr, const uint8_t* data, size_t len) {
+        auto& mem = top_->rootp->npu_top__DOT__sram__DOT__sram0__DOT__mem;
+        for (size_t i = 0; i < len; i++) mem[(addr + i) & 0xFFFF] = data[i];
+    }
+
+    void load_program(uint32_t ucode_base, const std::vector<Instruction>& program) {
+        for (size_t i = 0; i < program.size(); i++) {
+            uint8_t bytes[16];
+            program[i].pack(bytes);
+            write_sram0(ucode_base + 16 * i, bytes, sizeof(bytes));
+        }
+    }
+
+    void load_microcode(uint32_t ucode_base, const Microcode& ucode) {
+        write_sram0(ucode_base, ucode.bytes.data(), ucode.bytes.size());
+    }
+
+    // Clock until done is observed or max_cycles elapse, calling
+    // on_cycle(top) after every clock (e.g. for profiling).
+    // Returns the number of cycles spent waiting.
+    template <typename OnCycle>
+    int run_until_done(int max_cycles, OnCycle&& on_cycle) {
+        int cycles = 0;
+        while (!top_->done && cycles < max_cycles) {
+            tick();
+            on_cycle(top_);
+            cycles++;
+        }
+        run_cycles_ += cycles;
+        return cycles;
+    }
+
+    int run_until_done(int max_cycles) {
+        return run_until_done(max_cycles, [](Top*) {});
+    }
+
+    // Total full clock periods since construction (reset toggles excluded)
+    uint64_t cycles() const { return cycles_; }
+
+    // Cycles spent inside run_until_done() across all calls
+    uint64_t run_cycles() const { return run_cycles_; }
+
+    // Emit cycle counters for the benchmark regression gate (NPU_PERF_OUT)
+    void report_perf(const std::string& prefix = "") const {
+        perf_report(prefix + "run_cycles", run_cycles_);
+        perf_report(prefix + "total_cycles", cycles_);
+    }
+
+private:
+    Top* top_;
+    uint64_t cycles_ = 0;
+    uint64_t run_cycles_ = 0;
+};
@@ -51,10 +51,236 @@ enum Opcode {
     OP_VEC_ADD   = 0x08,
     OP_VEC_MUL   = 0x09,
     OP_VEC_COPY  = 0x0A,
+    OP_LUT_LOAD  = 0x0B,  // src0 = SRAM0 table, imm = LutTable
+    OP_GEMM_BATCH = 0x0C, // m = count, src0/src1/dst = A/B/C strides, n = ldc
+    OP_GEMM_W4   = 0x0D,  // GEMM with INT4 weights packed [K, ceil(N/2)]
+    OP_GEMM_ORDER = 0x0E, // imm = GemmLoopOrder for later GEMMs
+    OP_DMA_STREAM = 0x0F, // DDR offset {src1,src0} -> weight FIFO, {n,m} bytes
+    OP_GEMM_STREAM = 0x10, // GEMM with B from the weight FIFO (src1 unused)
+    OP_GEMM_RESIDUAL = 0x11, // src0 = INT8 residual added to the next GEMM's C
+    OP_SRAM_BASE = 0x13,  // flags = SramBase, dst/src0/src1 = sram_base() of those fields
+    OP_CALL      = 0x14,  // imm = target pc, flags = CallFrame loaded from dst/src0/src1/{n,m}
+    OP_RET       = 0x15,  // back to the instruction after the last CALL
     OP_BARRIER   = 0xFE,
     OP_END       = 0xFF
 };
 
+// LUT_LOAD targets (imm[0]). GELU tables are 256 INT8 entries; softmax exp
+// tables are 256 16-bit little-endian entries indexed by (x - max) as INT8.
+enum LutTable {
+    LUT_GELU        = 0,
+    LUT_SOFTMAX_EXP = 1
+};
+
+// GEMM_ORDER tile loop orders, outermost loop first
+enum GemmLoopOrder {
+    LOOP_MNK = 0,  // default; A row panel reused across N
+    LOOP_NMK = 1,  // all of A reused across N when it fits the buffer
+    LOOP_KMN = 2   // A tile reused across N; partial sums held for all of C
+};
+
+// SRAM_BASE flags: which fields' base registers to load
+enum SramBase {
+    BASE_DST  = 0x01,
+    BASE_SRC0 = 0x02,
+    BASE_SRC1 = 0x04
+};
+
+// CALL frame registers a base register can add to its field: SRAM fields
+// add frame * 16 bytes, DDR fields add the DDR frame for any but FRAME_NONE
+enum Frame {
+    FRAME_NONE   = 0,
+    FRAME_WEIGHT = 1,
+    FRAME_ACT    = 2,
+    FRAME_KV     = 3
+};
+
+// CALL flags: which frame registers to load
+enum CallFrame {
+    CALL_WEIGHT = 0x01,  // dst, 16-byte units
+    CALL_ACT    = 0x02,  // src0, 16-byte units
+    CALL_KV     = 0x04,  // src1, 16-byte units
+    CALL_DDR    = 0x08   // {n, m}, bytes
+};
+
+// Base register value: SRAM0 address bits 16 and up, plus a frame
+inline uint16_t sram_base(uint16_t high, uint8_t frame = FRAME_NONE) {
+    return uint16_t((frame & 3) << 14 | (high & 0x3FFF));
+}
+
+// Engine IDs (match microcode_controller scoreboard bit order)
+enum Engine {
+    ENGINE_GEMM      = 0,
+    ENGINE_SOFTMAX   = 1,
+    ENGINE_LAYERNORM = 2,
+    ENGINE_GELU      = 3,
+    ENGINE_VEC       = 4,
+    ENGINE_DMA       = 5,
+    NUM_ENGINES      = 6,
+    ENGINE_NONE      = 7
+};
+
+// Target engine of an opcode (mirrors the controller's decode)
+inline int opcode_engine(uint8_t opcode) {
+    switch (opcode) {
+        case OP_GEMM:
+        case OP_GEMM_W4:
+        case OP_GEMM_STREAM: return ENGINE_GEMM;
+        case OP_SOFTMAX:   return ENGINE_SOFTMAX;
+        case OP_LAYERNORM: return ENGINE_LAYERNORM;
+        case OP_GELU:      return ENGINE_GELU;
+        case OP_VEC:
+        case OP_VEC_ADD:
+        case OP_VEC_MUL:
+        case OP_VEC_COPY:  return ENGINE_VEC;
+        case OP_DMA_LOAD:
+        case OP_DMA_STORE:
+        case OP_DMA_STREAM: return ENGINE_DMA;
+        default:           return ENGINE_NONE;
+    }
+}
+
+// Fields of an opcode that hold SRAM0 addresses, as SramBase flags. The
+// controller extends each with that field's SRAM_BASE register.
+inline uint8_t sram_address_fields(uint8_t opcode) {
+    switch (opcode) {
+        case OP_GEMM:
+        case OP_GEMM_W4:
+        case OP_LAYERNORM: return BASE_DST | BASE_SRC0 | BASE_SRC1;
+        case OP_GEMM_STREAM: return BASE_DST | BASE_SRC0;
+        case OP_DMA_LOAD:  return BASE_DST;
+        case OP_DMA_STORE:
+        case OP_LUT_LOAD:
+        case OP_GEMM_RESIDUAL: return BASE_SRC0;
+        default:           return 0;
+    }
+}
+
+// Fields of an opcode that hold DDR offsets, as SramBase flags. Only the
+// frame select of their base register applies. DMA_STREAM's offset is
+// {src1, src0}, relocated through src0's.
+inline uint8_t ddr_address_fields(uint8_t opcode) {
+    switch (opcode) {
+        case OP_DMA_LOAD:
+        case OP_DMA_STREAM: return BASE_SRC0;
+        case OP_DMA_STORE: return BASE_DST;
+        default:           return 0;
+    }
+}
+
+// Target engine of an instruction; LUT_LOAD occupies the table owner's slot
+inline int instr_engine(const Instruction& instr) {
+    if (instr.opcode == OP_LUT_LOAD) return (instr.imm & 1) ? ENGINE_SOFTMAX : ENGINE_GELU;
+    return opcode_engine(instr.opcode);
+}
+
+inline const char* opcode_name(uint8_t opcode) {
+    switch (opcode) {
+        case OP_NOP:       return "NOP";
+        case OP_DMA_LOAD:  return "DMA_LOAD";
+        case OP_DMA_STORE: return "DMA_STORE";
+        case OP_GEMM:      return "GEMM";
+        case OP_VEC:       return "VEC";
+        case OP_SOFTMAX:   return "SOFTMAX";
+        case OP_LAYERNORM: return "LAYERNORM";
+        case OP_GELU:      return "GELU";
+        case OP_VEC_ADD:   return "VEC_ADD";
+        case OP_VEC_MUL:   return "VEC_MUL";
+        case OP_VEC_COPY:  return "VEC_COPY";
+        case OP_LUT_LOAD:  return "LUT_LOAD";
+        case OP_GEMM_BATCH: return "GEMM_BATCH";
+        case OP_GEMM_W4:   return "GEMM_W4";
+        case OP_GEMM_ORDER: return "GEMM_ORDER";
+        case OP_DMA_STREAM: return "DMA_STREAM";
+        case OP_GEMM_STREAM: return "GEMM_STREAM";
+        case OP_GEMM_RESIDUAL: return "GEMM_RESIDUAL";
+        case OP_SRAM_BASE: return "SRAM_BASE";
+        case OP_CALL:      return "CALL";
+        case OP_RET:       return "RET";
+        case OP_BARRIER:   return "BARRIER";
+        case OP_END:       return "END";
+        default:           return "UNKNOWN";
+    }
+}
+
+inline const char* engine_name(int engine) {
+    static const char* names[NUM_ENGINES] = {
+        "gemm", "softmax", "layernorm", "gelu", "vec", "dma"
+    };
+    return (engine >= 0 && engine < NUM_ENGINES) ? names[engine] : "none";
+}
+
+// Compact 64-bit encoding for ops with K = imm = 0, flags < 4, m < 256,
+// n < 4096 and dst/src0/src1 multiples of 16 (stored as 12-bit granules
+// of the 64KB window the base registers select). Two share a 128-bit slot
+// and the controller decodes the upper one without a FETCH.
+//   [3:0] short opcode  [5:4] flags  [7:6] 2'b10  [19:8] dst
+//   [31:20] src0  [43:32] src1  [51:44] m  [63:52] n
+constexpr uint8_t COMPACT_MARK = 0x80;  // no full opcode starts 2'b10
+constexpr uint8_t COMPACT_OPCODES[16] = {
+    OP_NOP, OP_DMA_LOAD, OP_DMA_STORE, OP_VEC, OP_SOFTMAX, OP_LAYERNORM, OP_GELU, OP_VEC_ADD,
+    OP_VEC_MUL, OP_VEC_COPY, OP_GEMM_RESIDUAL, OP_GEMM_BATCH, OP_SRAM_BASE, OP_RET, OP_BARRIER, OP_END
+};
+
+// Short opcode of an opcode, -1 if it has no compact form
+inline int compact_opcode(uint8_t opcode) {
+    for (int i = 0; i < 16; i++) {
+        if (COMPACT_OPCODES[i] == opcode) return i;
+    }
+    return -1;
+}
+
+inline bool compact_fits(const Instruction& i) {
+    return compact_opcode(i.opcode) >= 0 && i.flags < 4 && i.k == 0 && i.imm == 0 &&
+           ((i.dst | i.src0 | i.src1) & 15) == 0 && i.m < 256 && i.n < 4096;
+}
+
+inline void pack_compact(const Instruction& i, uint8_t* buffer) {
+    uint64_t word = uint64_t(compact_opcode(i.opcode)) | uint64_t(i.flags) << 4 | COMPACT_MARK |
+                    uint64_t(i.dst >> 4) << 8 | uint64_t(i.src0 >> 4) << 20 | uint64_t(i.src1 >> 4) << 32 |
+                    uint64_t(i.m) << 44 | uint64_t(i.n) << 52;
+    for (int b = 0; b < 8; b++) buffer[b] = uint8_t(word >> (8 * b));
+}
+
+// Microcode image: one 16-byte slot per full instruction or compact pair.
+// The controller's pc counts slots, so CALL targets (instruction indices
+// in the program) become slots and always start one.
+struct Microcode {
+    std::vector<uint8_t> bytes;
+    std::vector<uint16_t> slot;  // slot of each instruction
+
+    size_t slots() const { return bytes.size() / 16; }
+};
+
+inline Microcode encode_microcode(const std::vector<Instruction>& program, bool compact) {
+    std::vector<bool> target(program.size() + 1, false);
+    for (const auto& instr : program) {
+        if (instr.opcode == OP_CALL && instr.imm < target.size()) target[instr.imm] = true;
+    }
+    Microcode mc;
+    mc.slot.resize(program.size());
+    for (size_t i = 0; i < program.size(); i++) {
+        const size_t off = mc.bytes.size();
+        mc.slot[i] = uint16_t(off / 16);
+        mc.bytes.resize(off + 16);
+        if (compact && i + 1 < program.size() && !target[i + 1] && compact_fits(program[i]) &&
+            compact_fits(program[i + 1])) {
+            pack_compact(program[i], &mc.bytes[off]);
+            pack_compact(program[i + 1], &mc.bytes[off + 8]);
+            mc.slot[++i] = uint16_t(off / 16);
+        } else {
+            program[i].pack(&mc.bytes[off]);
+        }
+    }
+    for (size_t i = 0; i < program.size(); i++) {
+        if (program[i].opcode != OP_CALL || program[i].imm >= program.size()) continue;
+        Instruction call = program[i];
+        call.imm = mc.slot[call.imm];
+        call.pack(&mc.bytes[16 * mc.slot[i]]);
+    }
+    return mc;
+}
+
 // Helper to write instructions to binary file
 inline void write_microcode(const std::string& filename, const std::vector<Instruction>& instrs) {
     std::ofstream file(filename, std::ios::binary);
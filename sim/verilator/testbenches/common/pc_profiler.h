@@ -0,0 +1,205 @@
+#pragma once
+// Sampling PC profiler for microcode programs.
+// Every `interval` cycles the harness samples microcode_controller's public
+// pc/upper_half/state/scoreboard signals and attributes the sample to the
+// instruction the controller is on and the reason it is sitting there. pc
+// counts 16-byte slots, so the slot and half are mapped back to an
+// instruction through the Microcode's slot table. The hot path is a single
+// counter increment, so it can stay enabled for full-model runs.
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "common/npu_utils.h"
+
+// microcode_controller state_t encoding
+enum ControllerState {
+    CTRL_IDLE         = 0,
+    CTRL_FETCH        = 1,
+    CTRL_DECODE       = 2,
+    CTRL_DISPATCH     = 3,
+    CTRL_WAIT_BARRIER = 4,
+    CTRL_DONE         = 5
+};
+
+// Why the controller is spending a cycle on the instruction at pc.
+// REASON_ENGINE_BUSY is followed by one slot per engine.
+enum StallReason {
+    REASON_FETCH = 0,
+    REASON_DECODE,
+    REASON_ISSUE,
+    REASON_BARRIER,
+    REASON_ENGINE_BUSY,
+    NUM_REASONS = REASON_ENGINE_BUSY + NUM_ENGINES
+};
+
+class PcProfiler {
+public:
+    PcProfiler(const std::vector<Instruction>& program, const Microcode& ucode, uint32_t interval)
+        : program_(program),
+          slot_(ucode.slot),
+          first_(ucode.slots(), program.size()),
+          interval_(interval ? interval : 1),
+          countdown_(interval_),
+          samples_((program.size() + 1) * NUM_REASONS, 0) {
+        for (size_t i = program.size(); i-- > 0;) first_[slot_[i]] = i;
+    }
+
+    // Call once per clock; true when a sample should be taken this cycle
+    bool due() {
+        if (--countdown_ != 0) return false;
+        countdown_ = interval_;
+        return true;
+    }
+
+    void record(uint16_t pc, bool upper_half, uint8_t state, uint8_t scoreboard) {
+        if (state == CTRL_IDLE || state == CTRL_DONE) return;
+
+        size_t idx = instr_at(pc, upper_half, state);
+        samples_[idx * NUM_REASONS + classify(engine_at(idx), state, scoreboard)]++;
+        total_++;
+    }
+
+    uint64_t total_samples() const { return total_; }
+
+    void print_flat(std::ostream& os) const {
+        os << "=== Microcode PC profile (interval=" << interval_
+           << " cycles, samples=" << total_ << ") ===" << std::endl;
+
+        std::vector<uint64_t> per_instr(program_.size() + 1, 0);
+        std::vector<uint64_t> per_op_reason(256 * NUM_REASONS, 0);
+        for (size_t idx = 0; idx <= program_.size(); idx++) {
+            for (int reason = 0; reason < NUM_REASONS; reason++) {
+                uint64_t n = samples_[idx * NUM_REASONS + reason];
+                per_instr[idx] += n;
+                per_op_reason[opcode_at(idx) * NUM_REASONS + reason] += n;
+            }
+        }
+
+        os << "  instr     pc  opcode        samples      pct" << std::endl;
+        for (size_t idx : sorted_nonzero(per_instr)) {
+            os << "  " << std::setw(5) << idx << "  " << std::setw(5) << pc_name(idx) << "  " << std::left
+               << std::setw(12) << instr_name(idx) << std::right << std::setw(9) << per_instr[idx] << "  "
+               << pct(per_instr[idx]) << std::endl;
+        }
+
+        os << "=== By opcode / stall reason ===" << std::endl;
+        os << "  opcode        reason              samples      pct" << std::endl;
+        for (size_t idx : sorted_nonzero(per_op_reason)) {
+            uint8_t opcode = static_cast<uint8_t>(idx / NUM_REASONS);
+            int reason = static_cast<int>(idx % NUM_REASONS);
+            os << "  " << std::left << std::setw(12) << opcode_name(opcode) << "  " << std::setw(18)
+               << reason_name(reason) << std::right << std::setw(9) << per_op_reason[idx] << "  "
+               << pct(per_op_reason[idx]) << std::endl;
+        }
+    }
+
+    // Folded-stack output ("ucode;iNNNN_OPCODE;reason count" per line, NNNN
+    // the instruction index), consumable by flamegraph.pl, inferno or
+    // speedscope.
+    bool write_folded(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        for (size_t idx = 0; idx <= program_.size(); idx++) {
+            for (int reason = 0; reason < NUM_REASONS; reason++) {
+                uint64_t n = samples_[idx * NUM_REASONS + reason];
+                if (!n) continue;
+                out << "ucode;i" << std::setw(4) << std::setfill('0') << idx << std::setfill(' ') << "_"
+                    << instr_name(idx) << ";" << reason_name(reason) << " " << n << "\n";
+            }
+        }
+        return true;
+    }
+
+private:
+    // Instruction the controller is on. In FETCH upper_half still belongs
+    // to the previous slot, so only later states can be on an upper half.
+    // Out-of-range pcs share the last bucket.
+    size_t instr_at(uint16_t pc, bool upper_half, uint8_t state) const {
+        if (pc >= first_.size()) return program_.size();
+        size_t idx = first_[pc];
+        if (upper_half && state != CTRL_FETCH && idx + 1 < program_.size() && slot_[idx + 1] == pc) idx++;
+        return idx;
+    }
+
+    uint8_t opcode_at(size_t idx) const {
+        return idx < program_.size() ? program_[idx].opcode : static_cast<uint8_t>(OP_END);
+    }
+
+    int engine_at(size_t idx) const {
+        return idx < program_.size() ? instr_engine(program_[idx]) : static_cast<int>(ENGINE_NONE);
+    }
+
+    std::string instr_name(size_t idx) const {
+        return idx < program_.size() ? opcode_name(program_[idx].opcode) : "OUT_OF_RANGE";
+    }
+
+    std::string pc_name(size_t idx) const {
+        return idx < program_.size() ? std::to_string(slot_[idx]) : "-";
+    }
+
+    static int classify(int engine, uint8_t state, uint8_t scoreboard) {
+        switch (state) {
+            case CTRL_FETCH:        return REASON_FETCH;
+            case CTRL_DECODE:       return REASON_DECODE;
+            case CTRL_WAIT_BARRIER: return REASON_BARRIER;
+            default: {
+                if (engine != ENGINE_NONE && ((scoreboard >> engine) & 1)) {
+                    return REASON_ENGINE_BUSY + engine;
+                }
+                return REASON_ISSUE;
+            }
+        }
+    }
+
+    static std::string reason_name(int reason) {
+        switch (reason) {
+            case REASON_FETCH:   return "fetch";
+            case REASON_DECODE:  return "decode";
+            case REASON_ISSUE:   return "issue";
+            case REASON_BARRIER: return "barrier";
+            default:
+                return std::string("stall_") + engine_name(reason - REASON_ENGINE_BUSY) + "_busy";
+        }
+    }
+
+    std::string pct(uint64_t n) const {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1) << std::setw(6) << (total_ ? 100.0 * n / total_ : 0.0) << "%";
+        return ss.str();
+    }
+
+    static std::vector<size_t> sorted_nonzero(const std::vector<uint64_t>& counts) {
+        std::vector<size_t> idx;
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (counts[i]) idx.push_back(i);
+        }
+        std::stable_sort(idx.begin(), idx.end(), [&](size_t a, size_t b) { return counts[a] > counts[b]; });
+        return idx;
+    }
+
+    std::vector<Instruction> program_;
+    std::vector<uint16_t> slot_;   // pc of each instruction
+    std::vector<size_t> first_;    // first instruction of each pc
+    uint32_t interval_;
+    uint32_t countdown_;
+    std::vector<uint64_t> samples_;  // [instruction][reason]
+    uint64_t total_ = 0;
+};
+
+// Sample an npu_top model's controller. The harness must include the model's
+// root header (e.g. "Vnpu_top___024root.h") for the public signals.
+template <typename Top>
+inline void profile_npu(PcProfiler& prof, Top* top) {
+    if (!prof.due()) return;
+    const auto* root = top->rootp;
+    prof.record(root->npu_top__DOT__controller__DOT__pc,
+                root->npu_top__DOT__controller__DOT__upper_half,
+                root->npu_top__DOT__controller__DOT__state,
+                root->npu_top__DOT__controller__DOT__scoreboard);
+}
@@ -0,0 +1,16 @@
+#pragma once
+// Machine-readable performance counters for scripts/benchmark_deterministic.sh.
+// When NPU_PERF_OUT names a file, each metric is appended to it as
+// "metric,value". Stdout is untouched, so output hashes are unaffected.
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+inline void perf_report(const std::string& metric, uint64_t value) {
+    const char* path = std::getenv("NPU_PERF_OUT");
+    if (!path || !*path) return;
+    std::ofstream out(path, std::ios::app);
+    out << metric << "," << value << "\n";
+}
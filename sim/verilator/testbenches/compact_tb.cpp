@@ -0,0 +1,82 @@
+// Compact Encoding Testbench
+// Builds block programs twice, with every instruction in the 128-bit form
+// and with eligible neighbours paired into 64-bit compact halves of one
+// slot, and runs both on npu_top from the same DDR contents. Checks that
+// the engines see the same command stream (GEMM, LayerNorm and DMA
+// addresses, in order) and that DDR and SRAM0 outside the microcode end
+// up identical, that the compact microcode is smaller and that it takes
+// no more cycles, then reports bytes and cycles of each.
+
+#include <cstdint>
+#include <iostream>
+#include <verilated.h>
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/block_program.h"
+#include "common/block_run.h"
+#include "common/npu_utils.h"
+
+namespace {
+
+constexpr int MAX_CYCLES = 5000000;
+constexpr uint32_t SEED = 0xc0de;  // same DDR contents for both runs
+
+int run_case(const char* name, BlockConfig cfg) {
+    cfg.compact_ucode = false;
+    BlockRun full = run_block<Vnpu_top>(cfg, SEED, MAX_CYCLES);
+    cfg.compact_ucode = true;
+    BlockRun compact = run_block<Vnpu_top>(cfg, SEED, MAX_CYCLES);
+
+    if (!full.done || !compact.done) {
+        std::cout << "FAIL [" << name << "]: timeout (" << (full.done ? "compact" : "full") << ")" << std::endl;
+        return 1;
+    }
+
+    int errors = diff_block_runs(full, "full", compact, "compact");
+    if (compact.prog.ucode.bytes.size() >= full.prog.ucode.bytes.size()) {
+        std::cout << "  compact microcode is not smaller" << std::endl;
+        errors++;
+    }
+    if (compact.cycles > full.cycles) {
+        std::cout << "  compact microcode takes longer" << std::endl;
+        errors++;
+    }
+
+    std::cout << (errors ? "FAIL" : "PASS") << " [" << name << "]: " << full.prog.instrs.size() << " instrs, ucode "
+              << full.prog.ucode.bytes.size() << " -> " << compact.prog.ucode.bytes.size() << " B, cycles "
+              << full.cycles << " -> " << compact.cycles << std::endl;
+    return errors ? 1 : 0;
+}
+
+BlockConfig config(uint16_t hidden, bool stream, bool store_kv) {
+    BlockConfig cfg;
+    cfg.hidden = hidden;
+    cfg.seq_len = 16;
+    cfg.stream_weights = stream;
+    cfg.store_kv = store_kv;
+    return cfg;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    std::cout << "=== Compact Encoding Test ===" << std::endl;
+
+    int failures = 0;
+    failures += run_case("resident", config(32, true, false));
+    failures += run_case("streamed, store K/V", config(40, true, true));
+    BlockConfig staged = config(40, false, true);
+    staged.window = 8;
+    failures += run_case("staged, window, store K/V", staged);
+    BlockConfig decode = config(40, true, false);
+    decode.decode = true;
+    decode.position = 5;
+    failures += run_case("decode", decode);
+    // CALL targets are slots: the called body must start a fresh slot
+    BlockConfig called = config(32, true, true);
+    called.layers = 3;
+    called.call_layers = true;
+    failures += run_case("3 layers, called", called);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+// DMA bandwidth microbenchmark
+// Runs single DMA_LOAD / DMA_STORE programs on npu_top against the behavioral
+// DDR model and sweeps transfer size, DDR alignment, DDR latency and the
+// model's outstanding-burst limit. For each point it reports achieved
+// bytes/cycle against the 8 bytes/beat AXI peak and splits the DMA's busy
+// cycles by phase (address, data, byte-serial SRAM side, write response),
+// plus the DDR model's protocol counters.
+//
+// Every point runs on a fresh model so results do not depend on DMA state
+// left behind by earlier transfers.
+//
+// Usage: bench_dma_bandwidth [--csv FILE]
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/axi_ddr_model.h"
+#include "common/npu_driver.h"
+#include "common/npu_utils.h"
+
+namespace {
+
+constexpr uint32_t UCODE_BASE = 0xF600;
+constexpr uint32_t DDR_BASE = 0x10000;
+constexpr uint32_t MAX_BYTES = 0xF000;  // stay below the UCODE region
+constexpr double PEAK_BYTES_PER_CYCLE = 8.0;
+constexpr int MAX_CYCLES = 4000000;
+
+// dma_engine state_t encoding
+enum DmaState {
+    DMA_IDLE = 0,
+    DMA_RD_ADDR,
+    DMA_RD_DATA,
+    DMA_RD_WRITE_SRAM,
+    DMA_WR_ADDR,
+    DMA_WR_READ_SRAM,
+    DMA_WR_DATA,
+    DMA_WR_RESP,
+    DMA_DONE,
+    NUM_DMA_STATES
+};
+
+enum Phase { PHASE_ADDR, PHASE_DATA, PHASE_SRAM, PHASE_RESP, NUM_PHASES };
+
+int phase_of(int state) {
+    switch (state) {
+        case DMA_RD_ADDR:
+        case DMA_WR_ADDR:       return PHASE_ADDR;
+        case DMA_RD_DATA:
+        case DMA_WR_DATA:       return PHASE_DATA;
+        case DMA_RD_WRITE_SRAM:
+        case DMA_WR_READ_SRAM:  return PHASE_SRAM;
+        default:                return PHASE_RESP;  // WR_RESP, DONE
+    }
+}
+
+struct Config {
+    std::string sweep;
+    bool store;
+    uint32_t bytes;
+    uint32_t ddr_offset;
+    uint32_t latency;
+    uint32_t outstanding;
+};
+
+struct Result {
+    uint64_t busy_cycles = 0;
+    uint64_t phase_cycles[NUM_PHASES] = {};
+    DdrStats ddr;
+};
+
+Result run(const Config& cfg) {
+    DdrConfig ddr_cfg;
+    ddr_cfg.read_latency = cfg.latency;
+    ddr_cfg.write_latency = cfg.latency;
+    ddr_cfg.max_outstanding = cfg.outstanding;
+    AxiDdrModel<Vnpu_top> ddr(ddr_cfg);
+    NpuDriver<Vnpu_top> npu;
+
+    Instruction dma = {uint8_t(cfg.store ? OP_DMA_STORE : OP_DMA_LOAD), 0, 0, 0, 0,
+                       uint16_t(cfg.bytes), 0, 0, 0};
+    // DDR offset goes in src0 for loads and dst for stores; SRAM side is 0
+    if (cfg.store) dma.dst = uint16_t(cfg.ddr_offset);
+    else dma.src0 = uint16_t(cfg.ddr_offset);
+    std::vector<Instruction> program = {
+        dma,
+        {OP_BARRIER, 0, 0, 0, 0, 0, 0, 0, 0},
+        {OP_END, 0, 0, 0, 0, 0, 0, 0, 0},
+    };
+
+    npu.reset(10);
+    npu.toggle();
+    npu.write_reg(REG_DDR_BASE, DDR_BASE);
+    npu.load_program(UCODE_BASE, program);
+    npu.start(UCODE_BASE, program.size());
+
+    Result r;
+    npu.run_until_done(MAX_CYCLES, [&](Vnpu_top* top) {
+        ddr.step(top);
+        int state = top->rootp->npu_top__DOT__dma__DOT__state;
+        if (state == DMA_IDLE) return;
+        r.busy_cycles++;
+        r.phase_cycles[phase_of(state)]++;
+    });
+
+    if (!npu->done) {
+        std::cerr << "Timeout: " << (cfg.store ? "store" : "load") << " of " << cfg.bytes << " bytes" << std::endl;
+        std::exit(1);
+    }
+    r.ddr = ddr.stats();
+    return r;
+}
+
+std::vector<Config> build_configs() {
+    std::vector<Config> configs;
+    for (bool store : {false, true}) {
+        // Transfer size at nominal DDR settings
+        for (uint32_t bytes = 64; bytes <= 32768; bytes *= 2) {
+            configs.push_back({"size", store, bytes, 0, 8, 1});
+        }
+        configs.push_back({"size", store, MAX_BYTES, 0, 8, 1});
+
+        // DDR alignment (4032 makes the first burst straddle a 4KB page)
+        for (uint32_t offset : {1u, 4u, 8u, 64u, 4032u}) {
+            configs.push_back({"align", store, 4096, offset, 8, 1});
+        }
+
+        // DDR latency and outstanding-burst limit
+        for (uint32_t latency : {1u, 8u, 32u, 100u}) {
+            for (uint32_t outstanding : {1u, 4u}) {
+                configs.push_back({"latency", store, 4096, 0, latency, outstanding});
+            }
+        }
+    }
+    return configs;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    const char* csv_path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csv_path = argv[++i];
+    }
+
+    std::ofstream csv;
+    if (csv_path) {
+        csv.open(csv_path);
+        if (!csv) {
+            std::cerr << "Failed to write " << csv_path << std::endl;
+            return 1;
+        }
+        csv << "sweep,direction,bytes,ddr_offset,ddr_latency,outstanding,busy_cycles,bytes_per_cycle,"
+               "efficiency_pct,addr_cycles,data_cycles,sram_cycles,resp_cycles,bursts,beats,"
+               "unaligned_bursts,crossing_4k_bursts,short_write_bursts\n";
+    }
+
+    std::cout << "=== DMA Bandwidth (peak " << PEAK_BYTES_PER_CYCLE << " B/cycle) ===" << std::endl;
+    std::cout << "  sweep    dir     bytes  off  lat  out     cycles   B/cyc    eff%"
+                 "   addr%   data%   sram%   resp%  bursts" << std::endl;
+
+    for (const Config& cfg : build_configs()) {
+        Result r = run(cfg);
+        double bpc = r.busy_cycles ? double(cfg.bytes) / r.busy_cycles : 0.0;
+        double eff = 100.0 * bpc / PEAK_BYTES_PER_CYCLE;
+        uint64_t bursts = cfg.store ? r.ddr.write_bursts : r.ddr.read_bursts;
+        uint64_t beats = cfg.store ? r.ddr.write_beats : r.ddr.read_beats;
+        const char* dir = cfg.store ? "store" : "load";
+
+        std::cout << "  " << std::left << std::setw(8) << cfg.sweep << " " << std::setw(5) << dir << std::right
+                  << std::setw(8) << cfg.bytes << std::setw(5) << cfg.ddr_offset << std::setw(5) << cfg.latency
+                  << std::setw(5) << cfg.outstanding << std::setw(11) << r.busy_cycles << std::fixed
+                  << std::setprecision(3) << std::setw(8) << bpc << std::setprecision(1) << std::setw(8) << eff;
+        for (uint64_t c : r.phase_cycles) {
+            std::cout << std::setw(8) << (r.busy_cycles ? 100.0 * c / r.busy_cycles : 0.0);
+        }
+        std::cout << std::setw(8) << bursts << std::endl;
+
+        if (csv) {
+            csv << cfg.sweep << "," << dir << "," << cfg.bytes << "," << cfg.ddr_offset << "," << cfg.latency
+                << "," << cfg.outstanding << "," << r.busy_cycles << "," << std::setprecision(4) << bpc << ","
+                << std::setprecision(2) << eff;
+            for (uint64_t c : r.phase_cycles) csv << "," << c;
+            csv << "," << bursts << "," << beats << "," << r.ddr.unaligned_bursts << ","
+                << r.ddr.crossing_4k_bursts << "," << r.ddr.short_write_bursts << "\n";
+        }
+    }
+
+    if (csv_path) std::cout << "Wrote " << csv_path << std::endl;
+    return 0;
+}
@@ -1,10 +1,14 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 #include <verilated.h>
 
 #include "Vgelu_engine.h"
+#include "common/activation_lut.h"
 
 static void tick(Vgelu_engine* dut) {
     dut->clk = 0;
@@ -13,29 +17,25 @@ static void tick(Vgelu_engine* dut) {
     dut->eval();
 }
 
-int main(int argc, char** argv) {
-    Verilated::commandArgs(argc, argv);
-    auto* dut = new Vgelu_engine;
-
-    dut->clk = 0;
+// The engine can stall in PROCESSING after a partial drain, so each run
+// starts from reset. The LUT has no reset and keeps reloaded contents.
+static void reset(Vgelu_engine* dut) {
     dut->rst_n = 0;
-    dut->start = 0;
-    dut->num_elements = 4;
-    dut->data_valid = 0;
-    dut->data_in = 0;
-
     tick(dut);
     tick(dut);
     dut->rst_n = 1;
     tick(dut);
+}
 
+// Stream four samples through the engine and collect whatever it emits
+static std::vector<int8_t> run(Vgelu_engine* dut, const int8_t (&in_vals)[4]) {
+    reset(dut);
+    dut->num_elements = 4;
     dut->start = 1;
     tick(dut);
     dut->start = 0;
 
-    const int8_t in_vals[4] = {-2, -1, 0, 2};
     std::vector<int8_t> outs;
-
     for (int i = 0; i < 4; ++i) {
         dut->data_valid = 1;
         dut->data_in = static_cast<uint8_t>(in_vals[i]);
@@ -48,12 +48,71 @@ int main(int argc, char** argv) {
         tick(dut);
         if (dut->out_valid) outs.push_back(static_cast<int8_t>(dut->data_out));
     }
+    return outs;
+}
 
+// Check captured outputs against a table, in input order
+static void check(const char* name, const std::vector<int8_t>& outs, const int8_t (&in_vals)[4],
+                  const std::vector<uint8_t>& lut) {
     // Current RTL transitions to DONE before draining all queued samples.
     // Keep expectation broad but deterministic for today's scaffold implementation.
     assert(!outs.empty() && outs.size() < 4 && "expected partial output drain in current implementation");
+    for (size_t i = 0; i < outs.size(); ++i) {
+        int8_t expect = static_cast<int8_t>(lut[static_cast<uint8_t>(in_vals[i])]);
+        if (outs[i] != expect) {
+            std::cerr << "gelu_engine_tb: " << name << " mismatch at " << i << ": got " << int(outs[i])
+                      << " expected " << int(expect) << std::endl;
+            std::exit(1);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    auto* dut = new Vgelu_engine;
+
+    dut->clk = 0;
+    dut->start = 0;
+    dut->num_elements = 4;
+    dut->data_valid = 0;
+    dut->data_in = 0;
+    dut->lut_wr_en = 0;
+
+    const int8_t in_vals[4] = {5, -3, 0, 2};
+
+    // Reset table: tanh-GELU truncated toward zero ($rtoi)
+    std::vector<uint8_t> gelu_lut(256);
+    for (int i = 0; i < 256; ++i) {
+        int x = i < 128 ? i : i - 256;
+        double y = std::clamp(activation_fn(Activation::GELU, x), -128.0, 127.0);
+        gelu_lut[i] = static_cast<uint8_t>(static_cast<int8_t>(std::trunc(y)));
+    }
+    std::vector<int8_t> outs = run(dut, in_vals);
+    check("default GELU", outs, in_vals, gelu_lut);
+    size_t captured = outs.size();
+
+    // Reprogram the table at runtime and re-run the same stream
+    struct Reload {
+        const char* name;
+        std::vector<uint8_t> lut;
+    };
+    const Reload reloads[] = {
+        {"ReLU", activation_lut(Activation::RELU)},
+        {"tanh", activation_lut(Activation::TANH, 1.0 / 16, 1.0 / 64)},
+    };
+    for (const Reload& r : reloads) {
+        for (int i = 0; i < 256; ++i) {
+            dut->lut_wr_en = 1;
+            dut->lut_wr_addr = i;
+            dut->lut_wr_data = r.lut[i];
+            tick(dut);
+        }
+        dut->lut_wr_en = 0;
+        check(r.name, run(dut, in_vals), in_vals, r.lut);
+    }
 
-    std::cout << "gelu_engine_tb: PASS (" << outs.size() << " outputs captured in current RTL)" << std::endl;
+    std::cout << "gelu_engine_tb: PASS (" << captured << " outputs captured in current RTL, "
+              << "reset GELU + reloaded ReLU/tanh tables)" << std::endl;
 
     dut->final();
     delete dut;
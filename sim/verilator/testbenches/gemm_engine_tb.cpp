@@ -0,0 +1,404 @@
+// GEMM engine address-generation testbench
+// The engine's SRAM datapath is not wired yet, but its tile FSM already
+// walks the operand and output tiles. This checks the addresses it presents
+// in each phase against a model of the tile loop (mnk: k innermost, then n,
+// then m; or the nmk / kmn orders) and of the activation and weight tile
+// buffers, which skip the fetch of a tile that is still resident:
+//   LOAD_WEIGHT_TILE - B tile base on sram_rd_addr
+//   LOAD_ACT_TILE    - A tile base on sram_rd_addr
+//   STORE_RESULT     - C tile base on sram_wr_addr
+// for row-major output, transpose_b, and the scatter epilogue used by the
+// fused QKV projection (gemm_scatter_golden in python/golden/reference.py).
+//
+// Strided batches (the per-head QK^T and PV of block_program.h) must walk
+// every batch at its own A/B/C offsets, fetch the next batch's first weight
+// tile while the previous batch's last tile is stored, and take exactly
+// batch x (single GEMM) - 2 x (batch - 1) cycles. A batch with B stride 0
+// (PV of grouped-query attention, query heads sharing one V head) keeps
+// its weight tiles buffered, so later batches only refetch the first.
+//
+// INT4 weights (GEMM_W4) are packed two columns per byte, [K, ceil(N/2)],
+// and the N tile is 2 x ARRAY_SIZE wide, so a tile's B base is
+// depth x ceil(N/2) + col / 2 and there are half as many N tiles.
+//
+// Streamed weights (GEMM_STREAM) come from the DMA weight FIFO: the engine
+// walks n, k, m whatever the loop order, loads every B tile once, and
+// spends one LOAD_WEIGHT_TILE cycle per 8-byte beat of the tile (each row
+// padded to whole beats), plus one per cycle the FIFO is empty. The FIFO
+// model here drops valid every fifo_gap-th cycle; the number of beats
+// popped must match the padded stream (weight_stream_bytes in
+// block_program.h), and every tile row must reach the array's weight
+// registers (array_load_weights) with its streamed bytes, zero-padded.
+//
+// A residual epilogue (GEMM_RESIDUAL) adds one LOAD_RESID_TILE cycle per
+// output tile, after its last K step, with the R tile base (laid out like
+// C) on sram_rd_addr.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <verilated.h>
+
+#include "Vgemm_engine.h"
+#include "Vgemm_engine___024root.h"
+
+namespace {
+
+constexpr int ARRAY_SIZE = 16;
+constexpr uint32_t ACT_BUF_TILES = 16;  // gemm_engine defaults
+constexpr uint32_t WGT_BUF_TILES = 16;
+constexpr uint32_t ACC_BUF_TILES = 16;
+enum LoopOrder { LOOP_MNK, LOOP_NMK, LOOP_KMN, LOOP_NKM /* weight stream */ };
+enum State {
+    IDLE,
+    LOAD_WEIGHT_TILE,
+    LOAD_ACT_TILE,
+    COMPUTE_TILE,
+    STORE_RESULT,
+    NEXT_TILE,
+    REQUANTIZE,
+    DONE_STATE,
+    LOAD_RESID_TILE
+};
+
+struct Case {
+    const char* name;
+    uint32_t m, k, n;
+    bool transpose_b;
+    int block_log2;
+    uint32_t batch = 1;
+    uint32_t stride_a = 0, stride_b = 0, stride_c = 0;
+    uint32_t ldc = 0;
+    bool int4 = false;
+    int order = LOOP_MNK;
+    bool stream = false;
+    uint32_t fifo_gap = 0;  // FIFO empty every fifo_gap-th cycle, 0 = never
+    bool residual = false;
+};
+
+struct Access {
+    int state;
+    uint32_t addr;
+};
+
+constexpr uint16_t SRC_A = 0x1000, SRC_B = 0x4000, DST = 0x8000, RESID = 0xC000;
+
+uint32_t tiles(uint32_t d) { return (d + ARRAY_SIZE - 1) / ARRAY_SIZE; }
+uint32_t tile_width_n(const Case& c) { return c.int4 ? 2 * ARRAY_SIZE : ARRAY_SIZE; }
+uint32_t tiles_n(const Case& c) { return (c.n + tile_width_n(c) - 1) / tile_width_n(c); }
+
+// Address of C[row][col] in batch i (mirrors gemm_engine's out_addr)
+uint32_t out_addr(const Case& c, uint32_t i, uint32_t row, uint32_t col) {
+    uint32_t base = DST + i * c.stride_c;
+    if (c.block_log2 == 0) return base + row * (c.ldc ? c.ldc : c.n) + col;
+    uint32_t b = c.block_log2;
+    return base + (((col >> b) * c.m) << b) + (row << b) + (col & ((1u << b) - 1));
+}
+
+struct Tile {
+    uint32_t m, n, k;
+};
+
+// Loop order the engine runs: KMN needs an accumulator tile per output
+// tile and runs as MNK when they do not fit
+int effective_order(const Case& c) {
+    if (c.stream) return LOOP_NKM;
+    return (c.order == LOOP_KMN && tiles(c.m) * tiles_n(c) > ACC_BUF_TILES) ? LOOP_MNK : c.order;
+}
+
+// Tiles of one GEMM in loop order
+std::vector<Tile> tile_walk(const Case& c) {
+    uint32_t tm = tiles(c.m), tn = tiles_n(c), tk = tiles(c.k);
+    int order = effective_order(c);
+    std::vector<Tile> walk;
+    if (order == LOOP_NKM) {
+        for (uint32_t n = 0; n < tn; n++) {
+            for (uint32_t k = 0; k < tk; k++) {
+                for (uint32_t m = 0; m < tm; m++) walk.push_back({m, n, k});
+            }
+        }
+        return walk;
+    }
+    for (uint32_t a = 0; a < (order == LOOP_MNK ? tm : order == LOOP_NMK ? tn : tk); a++) {
+        for (uint32_t b = 0; b < (order == LOOP_MNK ? tn : tm); b++) {
+            for (uint32_t d = 0; d < (order == LOOP_KMN ? tn : tk); d++) {
+                if (order == LOOP_MNK) walk.push_back({a, b, d});
+                else if (order == LOOP_NMK) walk.push_back({b, a, d});
+                else walk.push_back({b, d, a});
+            }
+        }
+    }
+    return walk;
+}
+
+// Tile accesses and cycles from the first LOAD_WEIGHT_TILE to DONE. A tile
+// costs NEXT_TILE + COMPUTE (tile_m + tile_k + tile_n + 5), plus one cycle
+// per operand it has to load and one STORE after its last K step. A batch
+// boundary skips NEXT_TILE and LOAD_WEIGHT. A streamed weight tile takes
+// one cycle per beat instead (FIFO stalls are added by the caller).
+struct WeightRow {
+    uint32_t row;      // array_weight_row
+    uint64_t offset;   // first stream byte
+    uint32_t bytes;    // bytes before the row's padding
+};
+
+struct Expected {
+    std::vector<Access> accesses;
+    std::vector<WeightRow> rows;
+    uint64_t cycles = 0;
+    uint64_t beats = 0;
+};
+
+// Byte p of the weight stream the FIFO model serves
+uint8_t stream_byte(uint64_t p) { return uint8_t(p * 7 + 1); }
+
+Expected expected(const Case& c) {
+    Expected e;
+    uint32_t tk = tiles(c.k), w = tile_width_n(c);
+    auto size = [](uint32_t t, uint32_t d, uint32_t width) { return std::min(width, d - t * width); };
+    std::vector<Tile> walk = tile_walk(c);
+    std::vector<int64_t> weight_tag;
+    for (uint32_t i = 0; i < c.batch; i++) {
+        uint32_t a_base = SRC_A + i * c.stride_a, b_base = SRC_B + i * c.stride_b;
+        // The next batch's first weight tile is fetched during the store
+        std::vector<int64_t> act_tag(ACT_BUF_TILES, -1);
+        if (i == 0 || c.stride_b != 0) weight_tag.assign(WGT_BUF_TILES, -1);
+        weight_tag[0] = -1;
+        for (const Tile& t : walk) {
+            uint32_t row = t.m * ARRAY_SIZE, col = t.n * w, depth = t.k * ARRAY_SIZE;
+            int64_t act_id = t.m * tk + t.k;
+            int64_t weight_id = effective_order(c) == LOOP_KMN ? t.k * tiles_n(c) + t.n : t.n * tk + t.k;
+            if (weight_tag[weight_id % WGT_BUF_TILES] != weight_id) {
+                uint32_t b = c.int4          ? b_base + depth * ((c.n + 1) / 2) + col / 2
+                             : c.transpose_b ? b_base + col * c.k + depth
+                                             : b_base + depth * c.n + col;
+                e.accesses.push_back({LOAD_WEIGHT_TILE, b & 0xFFFF});
+                weight_tag[weight_id % WGT_BUF_TILES] = weight_id;
+                if (c.stream) {
+                    uint32_t cols = size(t.n, c.n, w), rows = size(t.k, c.k, ARRAY_SIZE);
+                    uint32_t row_bytes = c.int4 ? (cols + 1) / 2 : cols, row_beats = (row_bytes + 7) / 8;
+                    for (uint32_t r = 0; r < rows; r++) e.rows.push_back({r, (e.beats + r * row_beats) * 8, row_bytes});
+                    e.beats += rows * row_beats;
+                    e.cycles += rows * row_beats;
+                } else {
+                    e.cycles++;
+                }
+            }
+            if (act_tag[act_id % ACT_BUF_TILES] != act_id) {
+                e.accesses.push_back({LOAD_ACT_TILE, (a_base + row * c.k + depth) & 0xFFFF});
+                act_tag[act_id % ACT_BUF_TILES] = act_id;
+                e.cycles++;
+            }
+            e.cycles += size(t.m, c.m, ARRAY_SIZE) + size(t.k, c.k, ARRAY_SIZE) + size(t.n, c.n, w) + 6;
+            if (t.k == tk - 1) {
+                if (c.residual) {
+                    e.accesses.push_back({LOAD_RESID_TILE, (out_addr(c, i, row, col) - DST + RESID) & 0xFFFF});
+                    e.cycles++;
+                }
+                e.accesses.push_back({STORE_RESULT, out_addr(c, i, row, col) & 0xFFFF});
+                e.cycles++;
+            }
+        }
+    }
+    e.cycles -= 2 * (c.batch - 1);
+    return e;
+}
+
+void tick(Vgemm_engine* dut) {
+    dut->clk = 0;
+    dut->eval();
+    dut->clk = 1;
+    dut->eval();
+}
+
+bool run(const Case& c) {
+    auto* dut = new Vgemm_engine;
+    dut->clk = 0;
+    dut->rst_n = 0;
+    dut->start = 0;
+    dut->src_a_addr = SRC_A;
+    dut->src_b_addr = SRC_B;
+    dut->dst_addr = DST;
+    dut->dim_m = c.m;
+    dut->dim_k = c.k;
+    dut->dim_n = c.n;
+    dut->transpose_b = c.transpose_b;
+    dut->int4_weights = c.int4;
+    dut->accumulate = 0;
+    dut->scale = 1;
+    dut->shift = 7;
+    dut->requant_en = 0;
+    dut->out_block_log2 = c.block_log2;
+    dut->batch_count = c.batch;
+    dut->batch_stride_a = c.stride_a;
+    dut->batch_stride_b = c.stride_b;
+    dut->batch_stride_c = c.stride_c;
+    dut->ldc = c.ldc;
+    dut->loop_order = c.order;
+    dut->residual_en = c.residual;
+    dut->residual_addr = RESID;
+    dut->wgt_stream = c.stream;
+    dut->wgt_fifo_valid = 0;
+    dut->wgt_fifo_data = 0;
+    dut->sram_rd_data = 0;
+    tick(dut);
+    tick(dut);
+    dut->rst_n = 1;
+    tick(dut);
+
+    dut->start = 1;
+    tick(dut);
+    dut->start = 0;
+
+    // A STORE_RESULT followed directly by LOAD_ACT_TILE fetched the next
+    // batch's first weight tile on sram_rd_addr during the store. A
+    // streamed weight tile spans several LOAD_WEIGHT_TILE cycles.
+    std::vector<Access> got;
+    std::vector<std::pair<uint32_t, std::vector<uint8_t>>> rows;
+    uint64_t cycles = 0, beats = 0, stalls = 0;
+    int prev = IDLE;
+    uint32_t store_rd_addr = 0;
+    for (; cycles < 200000 && !dut->done; cycles++) {
+        dut->wgt_fifo_valid = c.stream && (c.fifo_gap == 0 || cycles % c.fifo_gap != 0);
+        dut->wgt_fifo_data = 0;
+        for (int i = 0; i < 8; i++) dut->wgt_fifo_data |= uint64_t(stream_byte(beats * 8 + i)) << (8 * i);
+        dut->clk = 0;
+        dut->eval();
+        int state = dut->rootp->gemm_engine__DOT__state;
+        if (dut->array_load_weights) {
+            std::vector<uint8_t> row(ARRAY_SIZE);
+            for (uint32_t j = 0; j < ARRAY_SIZE; j++) row[j] = dut->array_weight_in[j];
+            rows.push_back({dut->array_weight_row, row});
+        }
+        if (dut->wgt_fifo_pop) beats++;
+        if (state == LOAD_WEIGHT_TILE && c.stream && !dut->wgt_fifo_valid) stalls++;
+        if (state == LOAD_ACT_TILE && prev == STORE_RESULT) got.push_back({LOAD_WEIGHT_TILE, store_rd_addr});
+        if ((state == LOAD_WEIGHT_TILE && prev != LOAD_WEIGHT_TILE) || state == LOAD_ACT_TILE ||
+            state == LOAD_RESID_TILE)
+            got.push_back({state, dut->sram_rd_addr});
+        if (state == STORE_RESULT) {
+            got.push_back({state, dut->sram_wr_addr});
+            store_rd_addr = dut->sram_rd_addr;
+        }
+        prev = state;
+        dut->clk = 1;
+        dut->eval();
+    }
+    bool done = dut->done;
+    dut->final();
+    delete dut;
+
+    Expected e = expected(c);
+    const std::vector<Access>& want = e.accesses;
+    if (!done || got.size() != want.size()) {
+        std::cerr << "gemm_engine_tb: " << c.name << ": " << got.size() << " tile accesses, expected "
+                  << want.size() << (done ? "" : " (timeout)") << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < want.size(); i++) {
+        if (got[i].state != want[i].state || got[i].addr != want[i].addr) {
+            std::cerr << "gemm_engine_tb: " << c.name << ": access " << i << " state " << got[i].state << " addr 0x"
+                      << std::hex << got[i].addr << ", expected state " << std::dec << want[i].state << " addr 0x"
+                      << std::hex << want[i].addr << std::dec << std::endl;
+            return false;
+        }
+    }
+    if (beats != e.beats) {
+        std::cerr << "gemm_engine_tb: " << c.name << ": popped " << beats << " weight beats, expected " << e.beats
+                  << std::endl;
+        return false;
+    }
+    if (rows.size() != e.rows.size()) {
+        std::cerr << "gemm_engine_tb: " << c.name << ": loaded " << rows.size() << " weight rows, expected "
+                  << e.rows.size() << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < rows.size(); i++) {
+        const WeightRow& w = e.rows[i];
+        bool match = rows[i].first == w.row;
+        for (uint32_t j = 0; j < ARRAY_SIZE; j++)
+            match = match && rows[i].second[j] == (j < w.bytes ? stream_byte(w.offset + j) : 0);
+        if (!match) {
+            std::cerr << "gemm_engine_tb: " << c.name << ": weight row " << i << " loaded into array row "
+                      << rows[i].first << " with the wrong bytes, expected row " << w.row << " from stream byte "
+                      << w.offset << std::endl;
+            return false;
+        }
+    }
+    if (cycles != e.cycles + stalls) {
+        std::cerr << "gemm_engine_tb: " << c.name << ": " << cycles << " cycles, expected " << e.cycles + stalls
+                  << std::endl;
+        return false;
+    }
+    std::cout << "  " << c.name << ": " << want.size() << " tile accesses match, " << cycles << " cycles";
+    if (c.stream) std::cout << " (" << beats << " beats, " << stalls << " FIFO stalls)";
+    std::cout << std::endl;
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    const Case cases[] = {
+        {"row-major 20x40x40", 20, 40, 40, false, 0},
+        {"transpose_b 16x16x16", 16, 16, 16, true, 0},
+        {"fused QKV 16x64x192, head_dim 16", 16, 64, 192, false, 4},
+        {"fused QKV 8x128x384, head_dim 32", 8, 128, 384, false, 5},
+        // 4 heads, seq 16, head_dim 16: QK^T over head-major Q/K, then PV
+        // into column slices of a [16, 64] context (ldc = hidden)
+        {"batched QK^T 4 x 16x16x16", 16, 16, 16, true, 0, 4, 256, 256, 256},
+        {"batched PV 4 x 16x16x16, ldc 64", 16, 16, 16, false, 0, 4, 256, 256, 16, 64},
+        {"batched QK^T 3 x 40x32x40", 40, 32, 40, true, 0, 3, 1280, 1280, 1600},
+        // INT4 weights: FFN up 16x64x256, and an N that ends mid-tile and
+        // mid-byte
+        {"int4 16x64x256", 16, 64, 256, false, 0, 1, 0, 0, 0, 0, true},
+        {"int4 20x40x45", 20, 40, 45, false, 0, 1, 0, 0, 0, 0, true},
+        // Loop orders. 40x72x40 has 5 K tiles, so A's row panels and B's
+        // column panels fit the tile buffers; 40x300x40 has 19, more than
+        // they hold; 70x16x80 has 25 output tiles, too many for KMN's
+        // accumulators.
+        {"nmk 40x72x40", 40, 72, 40, false, 0, 1, 0, 0, 0, 0, false, LOOP_NMK},
+        {"kmn 40x72x40", 40, 72, 40, false, 0, 1, 0, 0, 0, 0, false, LOOP_KMN},
+        {"mnk 40x300x40", 40, 300, 40, false, 0, 1, 0, 0, 0, 0, false, LOOP_MNK},
+        {"nmk 40x300x40", 40, 300, 40, false, 0, 1, 0, 0, 0, 0, false, LOOP_NMK},
+        {"nmk 20x16x40", 20, 16, 40, false, 0, 1, 0, 0, 0, 0, false, LOOP_NMK},
+        // 40x256x64 under KMN: each row panel of B (4 tiles) stays buffered
+        // across the M loop, though K spans 16 tiles
+        {"kmn 40x256x64", 40, 256, 64, false, 0, 1, 0, 0, 0, 0, false, LOOP_KMN},
+        {"kmn 70x16x80 (runs as mnk)", 70, 16, 80, false, 0, 1, 0, 0, 0, 0, false, LOOP_KMN},
+        {"kmn int4 40x64x96", 40, 64, 96, false, 0, 1, 0, 0, 0, 0, true, LOOP_KMN},
+        {"batched nmk 3 x 40x32x40", 40, 32, 40, true, 0, 3, 1280, 1280, 1600, 0, false, LOOP_NMK},
+        // Shared B: GQA PV (2 query heads per V head, column slices of the
+        // context), and 6 weight tiles reused by 3 batches
+        {"shared-B PV 2 x 16x16x16, ldc 64", 16, 16, 16, false, 0, 2, 256, 0, 16, 64},
+        {"shared-B 3 x 40x32x40", 40, 32, 40, false, 0, 3, 1280, 0, 1600},
+        {"shared-B nmk 3 x 40x32x40", 40, 32, 40, true, 0, 3, 1280, 0, 1600, 0, false, LOOP_NMK},
+        // Streamed weights: FFN up at S=16, partial tiles with a FIFO that
+        // runs dry every third cycle, and tiles padded to whole beats
+        // (20 = 5 rows x 4 columns). transpose_b, batching and the loop
+        // order are ignored.
+        {"stream 16x64x256", 16, 64, 256, false, 0, 1, 0, 0, 0, 0, false, LOOP_MNK, true},
+        {"stream 40x80x56, FIFO gaps", 40, 80, 56, true, 0, 1, 0, 0, 0, 0, false, LOOP_KMN, true, 3},
+        {"stream 20x21x20", 20, 21, 20, false, 0, 1, 0, 0, 0, 0, false, LOOP_NMK, true, 2},
+        {"stream QKV 16x64x192, head_dim 16", 16, 64, 192, false, 4, 1, 0, 0, 0, 0, false, LOOP_MNK, true},
+        // Residual epilogue: the block's output and FFN down projections,
+        // a KMN walk (R read once per output tile, at its last K step), a
+        // streamed projection and a batch writing column slices
+        {"residual 16x64x64", 16, 64, 64, false, 0, 1, 0, 0, 0, 0, false, LOOP_MNK, false, 0, true},
+        {"residual 16x256x64", 16, 256, 64, false, 0, 1, 0, 0, 0, 0, false, LOOP_NMK, false, 0, true},
+        {"residual kmn 40x72x40", 40, 72, 40, false, 0, 1, 0, 0, 0, 0, false, LOOP_KMN, false, 0, true},
+        {"residual stream 20x21x20", 20, 21, 20, false, 0, 1, 0, 0, 0, 0, false, LOOP_MNK, true, 2, true},
+        {"residual batched 4 x 16x16x16, ldc 64", 16, 16, 16, false, 0, 4, 256, 256, 16, 64, false, LOOP_MNK,
+         false, 0, true},
+    };
+    std::cout << "gemm_engine_tb:" << std::endl;
+    for (const Case& c : cases) {
+        if (!run(c)) return 1;
+    }
+    std::cout << "gemm_engine_tb: PASS" << std::endl;
+    return 0;
+}
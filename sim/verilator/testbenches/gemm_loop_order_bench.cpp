@@ -0,0 +1,182 @@
+// GEMM tile loop order benchmark
+// Runs the transformer block's projection shapes (fused QKV, FFN up, FFN
+// down) on gemm_engine under each GEMM_ORDER loop order and counts the
+// operand tiles the FSM actually fetches: every LOAD_WEIGHT_TILE reads a
+// tile_k x tile_n weight tile, every LOAD_ACT_TILE a tile_m x tile_k
+// activation tile. Tiles still resident (the activation tile buffer, or the
+// weight tile already in the array) are not fetched again.
+//
+// Reports SRAM read bytes per MAC next to the compulsory minimum (every
+// operand byte read once) and the engine's busy cycles, and checks the
+// counts against gemm_operand_reads(), the model block_program.h uses to
+// pick each GEMM's order.
+//
+// Usage: bench_gemm_loop_order [--csv FILE]
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "Vgemm_engine.h"
+#include "Vgemm_engine___024root.h"
+#include "common/block_program.h"
+
+namespace {
+
+constexpr uint64_t MAX_CYCLES = 20000000;
+enum State { IDLE, LOAD_WEIGHT_TILE, LOAD_ACT_TILE };
+
+struct Shape {
+    std::string name;
+    uint32_t seq_len, hidden;
+    uint32_t m, k, n;
+};
+
+struct Result {
+    uint64_t weight_bytes = 0, act_bytes = 0;
+    uint64_t weight_loads = 0, act_loads = 0;
+    uint64_t cycles = 0;
+};
+
+// Projections of one block at (seq_len, hidden): [S, H] x [H, 3H],
+// [S, H] x [H, 4H] and [S, 4H] x [4H, H]
+std::vector<Shape> block_shapes(uint32_t seq_len, uint32_t hidden) {
+    return {
+        {"QKV", seq_len, hidden, seq_len, hidden, 3 * hidden},
+        {"FFN_UP", seq_len, hidden, seq_len, hidden, 4 * hidden},
+        {"FFN_DOWN", seq_len, hidden, seq_len, 4 * hidden, hidden},
+    };
+}
+
+void tick(Vgemm_engine* dut) {
+    dut->clk = 0;
+    dut->eval();
+    dut->clk = 1;
+    dut->eval();
+}
+
+Result run(const Shape& s, int order) {
+    auto* dut = new Vgemm_engine;
+    dut->clk = 0;
+    dut->rst_n = 0;
+    dut->start = 0;
+    dut->src_a_addr = 0;
+    dut->src_b_addr = 0;
+    dut->dst_addr = 0;
+    dut->dim_m = s.m;
+    dut->dim_k = s.k;
+    dut->dim_n = s.n;
+    dut->transpose_b = 0;
+    dut->int4_weights = 0;
+    dut->accumulate = 0;
+    dut->scale = 1;
+    dut->shift = 7;
+    dut->requant_en = 1;
+    dut->out_block_log2 = 0;
+    dut->batch_count = 1;
+    dut->batch_stride_a = 0;
+    dut->batch_stride_b = 0;
+    dut->batch_stride_c = 0;
+    dut->ldc = 0;
+    dut->loop_order = order;
+    dut->sram_rd_data = 0;
+    tick(dut);
+    dut->rst_n = 1;
+    tick(dut);
+
+    dut->start = 1;
+    tick(dut);
+    dut->start = 0;
+
+    Result r;
+    auto* root = dut->rootp;
+    while (!dut->done && r.cycles < MAX_CYCLES) {
+        dut->clk = 0;
+        dut->eval();
+        int state = root->gemm_engine__DOT__state;
+        uint64_t tm = root->gemm_engine__DOT__tile_size_m, tk = root->gemm_engine__DOT__tile_size_k;
+        uint64_t tn = root->gemm_engine__DOT__tile_size_n;
+        if (state == LOAD_WEIGHT_TILE) {
+            r.weight_loads++;
+            r.weight_bytes += tk * tn;
+        } else if (state == LOAD_ACT_TILE) {
+            r.act_loads++;
+            r.act_bytes += tm * tk;
+        }
+        dut->clk = 1;
+        dut->eval();
+        r.cycles++;
+    }
+    bool done = dut->done;
+    dut->final();
+    delete dut;
+    if (!done) {
+        std::cerr << "Timeout: " << s.name << " " << s.m << "x" << s.k << "x" << s.n << std::endl;
+        std::exit(1);
+    }
+    return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    const char* csv_path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csv_path = argv[++i];
+    }
+
+    std::ofstream csv;
+    if (csv_path) {
+        csv.open(csv_path);
+        if (!csv) {
+            std::cerr << "Failed to write " << csv_path << std::endl;
+            return 1;
+        }
+        csv << "gemm,seq_len,hidden,m,k,n,order,weight_loads,act_loads,weight_bytes,act_bytes,"
+               "read_bytes_per_mac,min_bytes_per_mac,cycles\n";
+    }
+
+    const char* order_names[] = {"mnk", "nmk", "kmn"};
+    std::cout << "=== GEMM loop order: SRAM read bytes per MAC ===" << std::endl;
+    std::cout << "  gemm        S     H        MxKxN      order  W loads  A loads    read KB   B/MAC    min"
+                 "     cycles" << std::endl;
+
+    for (auto [seq_len, hidden] : {std::pair{16u, 64u}, {64u, 64u}, {16u, 256u}, {64u, 256u}}) {
+        for (const Shape& s : block_shapes(seq_len, hidden)) {
+            double macs = double(s.m) * s.k * s.n;
+            double min_bpm = (double(s.m) * s.k + double(s.k) * s.n) / macs;
+            for (int order : {LOOP_MNK, LOOP_NMK, LOOP_KMN}) {
+                Result r = run(s, order);
+                if (r.weight_bytes + r.act_bytes != gemm_operand_reads(s.m, s.k, s.n, order)) {
+                    std::cerr << s.name << " " << order_names[order] << ": engine read "
+                              << r.weight_bytes + r.act_bytes << " bytes, gemm_operand_reads() predicts "
+                              << gemm_operand_reads(s.m, s.k, s.n, order) << std::endl;
+                    return 1;
+                }
+                double bpm = (r.weight_bytes + r.act_bytes) / macs;
+                std::string dims = std::to_string(s.m) + "x" + std::to_string(s.k) + "x" + std::to_string(s.n);
+                std::cout << "  " << std::left << std::setw(9) << s.name << std::right << std::setw(4) << s.seq_len
+                          << std::setw(6) << s.hidden << std::setw(13) << dims << std::setw(9)
+                          << order_names[order] << std::setw(9) << r.weight_loads << std::setw(9) << r.act_loads
+                          << std::fixed << std::setprecision(1) << std::setw(11)
+                          << (r.weight_bytes + r.act_bytes) / 1024.0 << std::setprecision(4) << std::setw(8) << bpm
+                          << std::setw(7) << min_bpm << std::setw(11) << r.cycles << std::endl;
+                if (csv) {
+                    csv << s.name << "," << s.seq_len << "," << s.hidden << "," << s.m << "," << s.k << "," << s.n
+                        << "," << order_names[order] << "," << r.weight_loads << "," << r.act_loads << ","
+                        << r.weight_bytes << "," << r.act_bytes << "," << std::setprecision(6) << bpm << ","
+                        << min_bpm << "," << r.cycles << "\n";
+                }
+            }
+        }
+    }
+
+    if (csv_path) std::cout << "Wrote " << csv_path << std::endl;
+    return 0;
+}
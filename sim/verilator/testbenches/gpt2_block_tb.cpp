@@ -1,13 +1,31 @@
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <vector>
 #include <iomanip>
 #include <verilated.h>
-#include "Vnpu_block.h"
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/npu_driver.h"
 #include "common/npu_utils.h"
+#include "common/pc_profiler.h"
 
 int main(int argc, char** argv) {
     Verilated::commandArgs(argc, argv);
     
+    // Optional sampling PC profiler:
+    //   --profile N          sample the controller every N cycles
+    //   --profile-out FILE   write folded stacks for flame graphs
+    uint32_t profile_interval = 0;
+    const char* profile_out = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_interval = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--profile-out") == 0 && i + 1 < argc) {
+            profile_out = argv[++i];
+        }
+    }
+    
     // Create microcode
     std::vector<Instruction> ucode;
     
@@ -24,71 +42,53 @@ int main(int argc, char** argv) {
     for (uint32_t i=0; i<base_addr; i++) hex_file << "00\n";
     
     // Write instructions
-    for (const auto& instr : ucode) {
-        uint8_t buffer[16];
-        instr.pack(buffer);
-        for (int b=0; b<16; b++) {
-            hex_file << std::hex << std::setw(2) << std::setfill('0') << (int)buffer[b] << "\n";
-        }
+    Microcode mc = encode_microcode(ucode, false);
+    for (uint8_t byte : mc.bytes) {
+        hex_file << std::hex << std::setw(2) << std::setfill('0') << (int)byte << "\n";
     }
     hex_file.close();
     
     std::cout << "Generated sram0_init.hex with " << ucode.size() << " instructions." << std::endl;
 
-    Vnpu_block* top = new Vnpu_block;
+    NpuDriver<Vnpu_top> npu;
 
     std::cout << "=== GPT-2 Block Test ===" << std::endl;
 
-    // Initialize
-    top->clk = 0;
-    top->rst_n = 0;
-    top->eval();
-
     // Reset
-    for (int i = 0; i < 10; i++) {
-        top->clk = !top->clk;
-        top->eval();
-    }
-    top->rst_n = 1;
-    top->clk = !top->clk;
-    top->eval();
+    npu.reset(10);
+    npu.toggle();
     
     // Start NPU
-    // Write registers via AXI
-    top->s_axi_awvalid = 1;
-    top->s_axi_awaddr = 0x08; // UCODE_BASE
-    top->s_axi_wvalid = 1;
-    top->s_axi_wdata = 0xF600;
-    top->s_axi_wstrb = 0xF;
-    top->s_axi_bready = 1;
-    top->clk = !top->clk; top->eval(); top->clk = !top->clk; top->eval();
-    
-    top->s_axi_awaddr = 0x0C; // UCODE_LEN
-    top->s_axi_wdata = ucode.size();
-    top->clk = !top->clk; top->eval(); top->clk = !top->clk; top->eval();
-    
-    top->s_axi_awaddr = 0x00; // CTRL (Start)
-    top->s_axi_wdata = 0x01;
-    top->clk = !top->clk; top->eval(); top->clk = !top->clk; top->eval();
-    
-    top->s_axi_awvalid = 0;
-    top->s_axi_wvalid = 0;
+    // Write UCODE_BASE, UCODE_LEN and CTRL registers via AXI
+    npu.start(0xF600, mc.slots());
     
     // Run until done
+    PcProfiler profiler(ucode, mc, profile_interval);
     int cycles = 0;
-    while (!top->done && cycles < 1000) {
-        top->clk = !top->clk; top->eval();
-        top->clk = !top->clk; top->eval();
-        cycles++;
+    if (profile_interval) {
+        cycles = npu.run_until_done(1000, [&](Vnpu_top* top) { profile_npu(profiler, top); });
+    } else {
+        cycles = npu.run_until_done(1000);
     }
     
-    if (top->done) {
+    if (npu->done) {
         std::cout << "PASS: NPU finished execution in " << cycles << " cycles." << std::endl;
     } else {
         std::cout << "FAIL: Timeout waiting for NPU done." << std::endl;
     }
+    npu.report_perf();
+    
+    if (profile_interval) {
+        profiler.print_flat(std::cout);
+        if (profile_out) {
+            if (profiler.write_folded(profile_out)) {
+                std::cout << "Wrote folded stacks to " << profile_out << std::endl;
+            } else {
+                std::cerr << "Failed to write " << profile_out << std::endl;
+                return 1;
+            }
+        }
+    }
     
-    top->final();
-    delete top;
     return 0;
 }
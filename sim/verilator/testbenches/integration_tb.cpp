@@ -3,55 +3,30 @@
 
 #include <iostream>
 #include <verilated.h>
-#include "Vnpu_integration.h"
+#include "Vnpu_top.h"
+#include "common/npu_driver.h"
 
 int main(int argc, char** argv) {
     Verilated::commandArgs(argc, argv);
-    Vnpu_integration* top = new Vnpu_integration;
+    NpuDriver<Vnpu_top> npu;
 
     // Clock and Reset
-    top->clk = 0;
-    top->rst_n = 0;
-
-    // Run reset
-    for (int i = 0; i < 10; i++) {
-        top->clk = !top->clk;
-        top->eval();
-    }
-    top->rst_n = 1;
+    npu.reset(10);
 
     std::cout << "=== NPU Integration Test ===" << std::endl;
     
-    // Test AXI Lite write to CTRL register
-    top->s_axi_awvalid = 1;
-    top->s_axi_awaddr = 0x00; // CTRL
-    top->s_axi_wvalid = 1;
-    top->s_axi_wdata = 0x01; // Start
-    top->s_axi_wstrb = 0xF;
-    top->s_axi_bready = 1;
-    
-    // Cycle clock
-    top->clk = !top->clk; top->eval();
-    top->clk = !top->clk; top->eval();
-    
-    top->s_axi_awvalid = 0;
-    top->s_axi_wvalid = 0;
+    // Test AXI Lite write to CTRL register (Start)
+    npu.write_reg(REG_CTRL, 0x01);
 
     // Wait for done or timeout
-    int cycles = 0;
-    while (!top->done && cycles < 1000) {
-        top->clk = !top->clk; top->eval();
-        top->clk = !top->clk; top->eval();
-        cycles++;
-    }
+    npu.run_until_done(1000);
 
-    if (top->done) {
+    if (npu->done) {
         std::cout << "PASS: NPU finished execution." << std::endl;
     } else {
         std::cout << "FAIL: Timeout waiting for NPU done." << std::endl;
     }
+    npu.report_perf();
 
-    top->final();
-    delete top;
     return 0;
 }
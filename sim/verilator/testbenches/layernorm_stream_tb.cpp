@@ -0,0 +1,282 @@
+// Streaming LayerNorm testbench
+// Runs layernorm_engine with STREAM=1 and LANES = 1, 4 and 16 against an
+// SRAM model that behaves like SRAM0 (registered reads of LANES consecutive
+// bytes, masked writes, port A granted per request, port B uncontended).
+// Normalizes rows of 64, 256 and 768 elements, plus a 90-element row that
+// ends mid-word, checks them bit-exactly against a model of the fixed-point
+// datapath (layernorm_fixed_golden in python/golden/reference.py) and
+// reports cycles per row, with and without port A contention.
+//
+// A LANES=4 build with an 8-slot gamma/beta cache runs the same rows, then
+// a decode loop (LN1 + LN2 on one row per token) that reports the
+// parameter-load cycles the cache saves per token and checks param_reload.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <verilated.h>
+
+#include "Vlayernorm_cached.h"
+#include "Vlayernorm_stream.h"
+#include "Vlayernorm_stream16.h"
+#include "Vlayernorm_stream4.h"
+#include "common/lane_port.h"
+
+namespace {
+
+constexpr uint16_t X_ADDR = 0x0000;
+constexpr uint16_t Y_ADDR = 0x4000;
+constexpr uint16_t PARAM_ADDR = 0x8000;
+
+// Bit-exact model of the streaming datapath
+std::vector<int8_t> golden(const std::vector<int8_t>& x, const std::vector<int8_t>& gamma,
+                           const std::vector<int8_t>& beta, int rows, int n) {
+    std::vector<int8_t> y(x.size());
+    for (int r = 0; r < rows; r++) {
+        const int8_t* row = &x[r * n];
+        int32_t sum = 0, sum_sq = 0;
+        for (int i = 0; i < n; i++) {
+            sum += row[i];
+            sum_sq += row[i] * row[i];
+        }
+        int32_t mean = sum / n;
+        int32_t var = sum_sq / n - mean * mean;
+        int idx = std::clamp(var, 0, 1023);
+        int32_t inv = int32_t(std::lround(65536.0 / std::sqrt(idx + 1.0)));
+        for (int i = 0; i < n; i++) {
+            int32_t x_norm = ((row[i] - mean) * inv) >> 16;
+            int32_t v = ((x_norm * gamma[i]) >> 7) + beta[i];
+            y[r * n + i] = int8_t(std::clamp(v, -128, 127));
+        }
+    }
+    return y;
+}
+
+// One engine instance wired to a 64KB SRAM model. Each access covers bytes
+// addr .. addr + lanes - 1. stall_pct is the chance that a higher-priority
+// requester owns port A in a given cycle.
+template <typename Model>
+struct Harness {
+    Model* dut = new Model;
+    std::vector<uint8_t> mem = std::vector<uint8_t>(65536, 0);
+    std::mt19937 rng;
+    std::uniform_int_distribution<int> pct{0, 99};
+    int lanes;
+    int stall_pct;
+    uint64_t param_reads = 0;
+    decltype(Model::sram_rd_data) rd_data{};
+    decltype(Model::param_rd_data) param_data{};
+
+    Harness(int lanes_, int stall_pct_, uint32_t seed) : rng(seed), lanes(lanes_), stall_pct(stall_pct_) {
+        dut->clk = 0;
+        dut->rst_n = 0;
+        dut->start = 0;
+        dut->param_reload = 0;
+        dut->sram_rd_gnt = 0;
+        dut->sram_wr_gnt = 0;
+        for (int l = 0; l < lanes; l++) {
+            set_lane(rd_data, l, 0);
+            set_lane(param_data, l, 0);
+        }
+        dut->sram_rd_data = rd_data;
+        dut->param_rd_data = param_data;
+        tick();
+        tick();
+        dut->rst_n = 1;
+        tick();
+    }
+    ~Harness() {
+        dut->final();
+        delete dut;
+    }
+
+    void tick() {
+        dut->clk = 0;
+        dut->eval();
+        bool stolen = pct(rng) < stall_pct;
+        dut->sram_rd_gnt = dut->sram_rd_en && !stolen;
+        dut->sram_wr_gnt = dut->sram_wr_en && !stolen;
+        dut->eval();
+        if (dut->param_rd_en) param_reads++;
+        for (int l = 0; l < lanes; l++) {
+            if (dut->sram_rd_gnt) set_lane(rd_data, l, mem[uint16_t(dut->sram_rd_addr + l)]);
+            if (dut->param_rd_en) set_lane(param_data, l, mem[uint16_t(dut->param_rd_addr + l)]);
+            if (dut->sram_wr_gnt && (uint32_t(dut->sram_wr_mask) >> l & 1))
+                mem[uint16_t(dut->sram_wr_addr + l)] = get_lane(dut->sram_wr_data, l);
+        }
+        dut->clk = 1;
+        dut->eval();
+        dut->sram_rd_data = rd_data;
+        dut->param_rd_data = param_data;
+    }
+
+    // Normalizes rows x n at X_ADDR into Y_ADDR; returns cycles from start
+    // to done, or 0 on timeout
+    uint64_t invoke(int rows, int n, uint16_t param_addr, bool reload = false) {
+        dut->hidden_dim = n;
+        dut->num_rows = rows;
+        dut->x_addr = X_ADDR;
+        dut->y_addr = Y_ADDR;
+        dut->param_addr = param_addr;
+        dut->param_reload = reload;
+        dut->start = 1;
+        tick();
+        dut->start = 0;
+        uint64_t cycles = 1;
+        while (!dut->done && cycles < 100000) {
+            tick();
+            cycles++;
+        }
+        return dut->done ? cycles : 0;
+    }
+
+    void store(uint16_t addr, const std::vector<int8_t>& v) {
+        for (size_t i = 0; i < v.size(); i++) mem[addr + i] = uint8_t(v[i]);
+    }
+
+    // Compares Y_ADDR against the model; returns the number of mismatches
+    int check(const std::vector<int8_t>& x, const std::vector<int8_t>& gamma, const std::vector<int8_t>& beta,
+              int rows, int n) {
+        std::vector<int8_t> want = golden(x, gamma, beta, rows, n);
+        int errors = 0;
+        for (int i = 0; i < rows * n; i++) {
+            int8_t got = int8_t(mem[Y_ADDR + i]);
+            if (got != want[i]) {
+                if (errors++ < 5) {
+                    std::cerr << "layernorm_stream_tb: LANES=" << lanes << " N=" << n << " [" << i / n << "]["
+                              << i % n << "] got " << int(got) << " expected " << int(want[i]) << std::endl;
+                }
+            }
+        }
+        return errors;
+    }
+};
+
+std::vector<int8_t> random_bytes(std::mt19937& rng, int count, int scale, int div) {
+    std::uniform_int_distribution<int> dist(-40, 40);
+    std::vector<int8_t> v(count);
+    for (auto& e : v) e = int8_t(dist(rng) * scale / div);
+    return v;
+}
+
+struct Result {
+    bool ok;
+    uint64_t cycles;
+};
+
+template <typename Model>
+Result run_case(int lanes, int rows, int n, int stall_pct, uint32_t seed) {
+    Harness<Model> h(lanes, stall_pct, seed);
+    std::vector<int8_t> x = random_bytes(h.rng, rows * n, 1, 1);
+    std::vector<int8_t> gamma = random_bytes(h.rng, n, 3, 1);
+    std::vector<int8_t> beta = random_bytes(h.rng, n, 1, 4);
+    h.store(X_ADDR, x);
+    h.store(PARAM_ADDR, gamma);
+    h.store(PARAM_ADDR + n, beta);
+
+    uint64_t cycles = h.invoke(rows, n, PARAM_ADDR);
+    int errors = cycles ? h.check(x, gamma, beta, rows, n) : 1;
+    // Masked lanes of a row's last word must not spill past the output
+    if (h.mem[Y_ADDR + rows * n] != 0) {
+        std::cerr << "layernorm_stream_tb: LANES=" << lanes << " N=" << n << " wrote past the last row"
+                  << std::endl;
+        errors++;
+    }
+    return {errors == 0, cycles};
+}
+
+template <typename Model>
+bool run_lanes(int lanes, const char* label = "") {
+    const int rows = 3;
+    for (int stall_pct : {0, 25}) {
+        for (int n : {64, 256, 768, 90}) {
+            Result r = run_case<Model>(lanes, rows, n, stall_pct, 0x1a7e + n + stall_pct + lanes);
+            if (!r.ok) {
+                std::cerr << "layernorm_stream_tb: FAIL LANES=" << lanes << label << " N=" << n << " port A stalls "
+                          << stall_pct << "%" << std::endl;
+                return false;
+            }
+            double per_row = double(r.cycles) / rows;
+            std::cout << "  LANES=" << std::setw(2) << lanes << label << " N=" << std::setw(4) << n
+                      << " port A stalls " << std::setw(2) << stall_pct << "%: " << std::fixed << std::setprecision(1)
+                      << per_row << " cycles/row, " << std::setprecision(2) << per_row / n << " cycles/element"
+                      << std::endl;
+        }
+    }
+    return true;
+}
+
+// Decode: every token runs LN1 and LN2 on a single row with their own
+// gamma/beta. The first token fills two cache slots; later ones hit.
+template <typename Model>
+bool run_decode(int lanes, int n, int tokens) {
+    Harness<Model> h(lanes, 0, 0xdec0 + n);
+    const uint16_t ln1 = PARAM_ADDR, ln2 = uint16_t(PARAM_ADDR + 2 * n);
+    std::vector<int8_t> gamma1 = random_bytes(h.rng, n, 3, 1), beta1 = random_bytes(h.rng, n, 1, 4);
+    std::vector<int8_t> gamma2 = random_bytes(h.rng, n, 3, 1), beta2 = random_bytes(h.rng, n, 1, 4);
+    h.store(ln1, gamma1);
+    h.store(ln1 + n, beta1);
+    h.store(ln2, gamma2);
+    h.store(ln2 + n, beta2);
+
+    auto step = [&](uint16_t params, const std::vector<int8_t>& gamma, const std::vector<int8_t>& beta,
+                    bool reload, uint64_t& cycles, uint64_t& reads) {
+        std::vector<int8_t> x = random_bytes(h.rng, n, 1, 1);
+        h.store(X_ADDR, x);
+        uint64_t before = h.param_reads;
+        uint64_t c = h.invoke(1, n, params, reload);
+        cycles += c;
+        reads += h.param_reads - before;
+        return c && h.check(x, gamma, beta, 1, n) == 0;
+    };
+
+    uint64_t first_cycles = 0, first_reads = 0, warm_cycles = 0, warm_reads = 0;
+    for (int t = 0; t < tokens; t++) {
+        uint64_t& cycles = t ? warm_cycles : first_cycles;
+        uint64_t& reads = t ? warm_reads : first_reads;
+        if (!step(ln1, gamma1, beta1, false, cycles, reads) || !step(ln2, gamma2, beta2, false, cycles, reads)) {
+            std::cerr << "layernorm_stream_tb: FAIL decode N=" << n << " token " << t << std::endl;
+            return false;
+        }
+    }
+
+    // New LN1 parameters: param_reload refills the slot, and later hits see them
+    gamma1 = random_bytes(h.rng, n, 3, 1);
+    h.store(ln1, gamma1);
+    uint64_t c = 0, r = 0;
+    if (!step(ln1, gamma1, beta1, true, c, r) || !step(ln1, gamma1, beta1, false, c, r)) {
+        std::cerr << "layernorm_stream_tb: FAIL decode N=" << n << " after param_reload" << std::endl;
+        return false;
+    }
+
+    double warm = double(warm_cycles) / (tokens - 1);
+    std::cout << "  decode LANES=" << lanes << " N=" << std::setw(3) << n << ": first token " << first_cycles
+              << " cycles (" << first_reads << " param reads), later tokens " << std::fixed << std::setprecision(1)
+              << warm << " cycles (" << double(warm_reads) / (tokens - 1) << " param reads), "
+              << double(first_cycles) - warm << " cycles saved per token" << std::endl;
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    std::cout << "layernorm_stream_tb:" << std::endl;
+    if (!run_lanes<Vlayernorm_stream>(1) || !run_lanes<Vlayernorm_stream4>(4) ||
+        !run_lanes<Vlayernorm_stream16>(16))
+        return 1;
+    if (!run_lanes<Vlayernorm_cached>(4, " cached"))
+        return 1;
+    for (int n : {64, 256}) {
+        if (!run_decode<Vlayernorm_cached>(4, n, 8)) return 1;
+    }
+
+    std::cout << "layernorm_stream_tb: PASS (bit-exact vs fixed-point model)" << std::endl;
+    return 0;
+}
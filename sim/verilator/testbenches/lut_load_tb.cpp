@@ -0,0 +1,81 @@
+// LUT_LOAD Testbench
+// Stages activation tables in SRAM0, reprograms the GELU and softmax exp
+// LUTs with LUT_LOAD while a DMA transfer competes for SRAM0 port A (DMA has
+// priority, so the loader must only consume granted reads), and checks the
+// engines' tables against the tables that were staged.
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <verilated.h>
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/activation_lut.h"
+#include "common/axi_ddr_model.h"
+#include "common/npu_driver.h"
+#include "common/npu_utils.h"
+
+namespace {
+
+constexpr uint32_t UCODE_BASE = 0xF600;
+constexpr uint32_t GELU_TABLE = 0x1000;
+constexpr uint32_t EXP_TABLE = 0x2000;
+constexpr uint32_t DMA_DST = 0x4000;
+
+int run_case(const char* name, const std::vector<uint8_t>& act_lut, const std::vector<uint8_t>& exp_lut) {
+    AxiDdrModel<Vnpu_top> ddr;
+    NpuDriver<Vnpu_top> npu;
+
+    npu.reset(10);
+    npu.toggle();
+    npu.write_sram0(GELU_TABLE, act_lut.data(), act_lut.size());
+    npu.write_sram0(EXP_TABLE, exp_lut.data(), exp_lut.size());
+
+    std::vector<Instruction> program = {
+        {OP_DMA_LOAD, 0, uint16_t(DMA_DST), 0, 0, 2048, 0, 0, 0},
+        {OP_LUT_LOAD, 0, 0, uint16_t(GELU_TABLE), 0, 0, 0, 0, LUT_GELU},
+        {OP_LUT_LOAD, 0, 0, uint16_t(EXP_TABLE), 0, 0, 0, 0, LUT_SOFTMAX_EXP},
+        {OP_GELU, 0, 0, 0, 0, 1, 256, 0, 0},  // waits for the GELU table
+        {OP_BARRIER, 0, 0, 0, 0, 0, 0, 0, 0},
+        {OP_END, 0, 0, 0, 0, 0, 0, 0, 0},
+    };
+    npu.load_program(UCODE_BASE, program);
+    npu.start(UCODE_BASE, program.size());
+    int cycles = npu.run_until_done(100000, [&](Vnpu_top* top) { ddr.step(top); });
+
+    if (!npu->done) {
+        std::cout << "FAIL [" << name << "]: timeout" << std::endl;
+        return 1;
+    }
+
+    int errors = 0;
+    auto* root = npu->rootp;
+    for (int i = 0; i < 256; i++) {
+        uint8_t got = root->npu_top__DOT__gelu__DOT__gelu_lut[i];
+        if (got != act_lut[i] && errors++ < 5) {
+            std::cout << "  gelu_lut[" << i << "] = " << int(got) << ", expected " << int(act_lut[i]) << std::endl;
+        }
+        uint16_t want = exp_lut[2 * i] | (exp_lut[2 * i + 1] << 8);
+        uint16_t got_exp = root->npu_top__DOT__softmax__DOT__exp_lut[i];
+        if (got_exp != want && errors++ < 5) {
+            std::cout << "  exp_lut[" << i << "] = " << got_exp << ", expected " << want << std::endl;
+        }
+    }
+
+    std::cout << (errors ? "FAIL" : "PASS") << " [" << name << "]: " << cycles << " cycles, " << errors
+              << " mismatches" << std::endl;
+    return errors ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    std::cout << "=== LUT_LOAD Test ===" << std::endl;
+
+    int failures = 0;
+    failures += run_case("relu + exp2", activation_lut(Activation::RELU), softmax_exp_lut(2.0));
+    failures += run_case("silu + exp", activation_lut(Activation::SILU), softmax_exp_lut());
+    failures += run_case("tanh + exp", activation_lut(Activation::TANH, 1.0 / 32, 1.0 / 127), softmax_exp_lut());
+    return failures ? 1 : 0;
+}
@@ -12,6 +12,12 @@ int32_t golden_mac(int8_t a, int8_t w, int32_t partial) {
     return partial + (int32_t)a * (int32_t)w;
 }
 
+// Signed INT4 weight in the low (hi = false) or high nibble of a byte
+int32_t int4_weight(uint8_t w, bool hi) {
+    int32_t v = hi ? (w >> 4) : (w & 0xF);
+    return v >= 8 ? v - 16 : v;
+}
+
 // Advance one clock cycle
 void tick(Vmac_unit* mac) {
     mac->clk = !mac->clk;
@@ -215,6 +221,75 @@ void test_mac_pipeline() {
     delete mac;
 }
 
+// Every activation x every weight byte, INT8 mode (one 8x8 product, the
+// high-nibble column passes through) or INT4 mode (two 8x4 products).
+// Inputs stream one per cycle; partial_sum_out lags them by one cycle.
+void test_mac_exhaustive(bool int4) {
+    std::cout << "Test: MAC exhaustive " << (int4 ? "INT8 x INT4 (two MACs/cycle)" : "INT8 x INT8") << "..."
+              << std::endl;
+
+    Vmac_unit* mac = new Vmac_unit;
+    mac->clk = 0;
+    mac->rst_n = 0;
+    mac->en = 0;
+    mac->clr = 0;
+    mac->load_weight = 0;
+    mac->int4_mode = int4;
+    mac->activation_in = 0;
+    mac->weight_in = 0;
+    mac->partial_sum_in = 0;
+    mac->partial_sum_in_hi = 0;
+    for (int i = 0; i < 5; i++) tick(mac);
+    mac->rst_n = 1;
+    tick(mac);
+
+    // Partial sums that exercise carries and sign changes in both columns
+    auto partial = [](int a, int w) { return int32_t(a * 65599 - w * 40503); };
+    auto partial_hi = [](int a, int w) { return int32_t(w * 70001 - a * 257 - 1000000); };
+
+    long errors = 0;
+    for (int w = 0; w < 256; w++) {
+        mac->en = 0;
+        mac->load_weight = 1;
+        mac->weight_in = w;
+        tick(mac);
+        mac->load_weight = 0;
+        mac->en = 1;
+
+        for (int a = 0; a <= 256; a++) {
+            if (a < 256) {
+                mac->activation_in = a;
+                mac->partial_sum_in = partial(a, w);
+                mac->partial_sum_in_hi = partial_hi(a, w);
+            }
+            tick(mac);
+            if (a == 0) continue;  // output still holds the load cycle
+
+            int8_t act = int8_t(a - 1);
+            int32_t want_lo, want_hi = partial_hi(a - 1, w);
+            if (int4) {
+                want_lo = partial(a - 1, w) + act * int4_weight(w, false);
+                want_hi += act * int4_weight(w, true);
+            } else {
+                want_lo = golden_mac(act, int8_t(w), partial(a - 1, w));
+            }
+            int32_t got_lo = int32_t(mac->partial_sum_out), got_hi = int32_t(mac->partial_sum_out_hi);
+            if (got_lo != want_lo || got_hi != want_hi) {
+                if (errors++ < 5) {
+                    std::cout << "  Mismatch a=" << int(act) << " w=0x" << std::hex << w << std::dec << ": got ("
+                              << got_lo << ", " << got_hi << ") expected (" << want_lo << ", " << want_hi << ")"
+                              << std::endl;
+                }
+            }
+        }
+    }
+
+    std::cout << "  " << (errors ? "FAILED" : "PASSED") << " (" << 256 * 256 - errors << "/65536 pairs)" << std::endl;
+    mac->final();
+    delete mac;
+    assert(errors == 0);
+}
+
 int main(int argc, char** argv) {
     std::cout << "========================================" << std::endl;
     std::cout << "      MAC Unit Testbench" << std::endl;
@@ -227,6 +302,8 @@ int main(int argc, char** argv) {
         test_mac_clear();
         test_mac_negative();
         test_mac_pipeline();
+        test_mac_exhaustive(false);
+        test_mac_exhaustive(true);
         
         std::cout << "\n========================================" << std::endl;
         std::cout << "    ALL TESTS PASSED!" << std::endl;
@@ -3,40 +3,26 @@
 
 #include <iostream>
 #include <verilated.h>
-#include "Vnpu_smoke.h"
+#include "Vnpu_top.h"
+#include "common/npu_driver.h"
 
 int main(int argc, char** argv) {
     Verilated::commandArgs(argc, argv);
     
     // Create instance
-    Vnpu_smoke* top = new Vnpu_smoke;
+    NpuDriver<Vnpu_top> npu;
     
     std::cout << "=== Tiny NPU Smoke Test ===" << std::endl;
     
-    // Initialize
-    top->clk = 0;
-    top->rst_n = 0;
-    
     // Reset
-    for (int i = 0; i < 10; i++) {
-        top->clk = !top->clk;
-        top->eval();
-    }
-    
-    // Release reset
-    top->rst_n = 1;
+    npu.reset(10);
     
     // Run a few cycles
     for (int i = 0; i < 20; i++) {
-        top->clk = !top->clk;
-        top->eval();
+        npu.toggle();
     }
     
     std::cout << "Smoke test PASSED - NPU compiles and resets correctly" << std::endl;
     
-    // Cleanup
-    top->final();
-    delete top;
-    
     return 0;
 }
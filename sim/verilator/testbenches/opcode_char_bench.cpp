@@ -0,0 +1,291 @@
+// Per-opcode latency/throughput characterization
+// Sweeps the dimensions of every engine opcode on npu_top and measures:
+//   latency  - issue-to-done cycles (controller scoreboard bit set -> clear)
+//   interval - back-to-back cycles per instruction for R identical copies
+// then fits affine cost models (cycles = c0 + sum(ci * feature_i)) by least
+// squares. Prints a table and writes the models as JSON for compilers and
+// runtime estimators.
+//
+// Usage: bench_opcode_characterization [--out FILE] [--repeats R]
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/axi_ddr_model.h"
+#include "common/npu_driver.h"
+#include "common/npu_utils.h"
+
+namespace {
+
+constexpr uint32_t UCODE_BASE = 0xF600;
+constexpr int MAX_CYCLES = 2000000;
+
+struct Point {
+    Instruction instr;
+    std::vector<double> features;
+    uint64_t latency = 0;
+    double interval = 0.0;
+};
+
+struct Fit {
+    std::vector<double> coeffs;  // intercept first
+    double max_abs_error = 0.0;
+};
+
+struct Sweep {
+    uint8_t opcode;
+    std::vector<std::string> feature_names;
+    std::vector<Point> points;
+    Fit latency_fit;
+    Fit interval_fit;
+};
+
+class Characterizer {
+public:
+    explicit Characterizer(int repeats) : repeats_(repeats) {
+        npu_.reset(10);
+        npu_.toggle();
+    }
+
+    void measure(Point& p) {
+        uint64_t single = run({p.instr, barrier(), end()}, opcode_engine(p.instr.opcode), &p.latency);
+
+        std::vector<Instruction> program(repeats_, p.instr);
+        program.push_back(barrier());
+        program.push_back(end());
+        uint64_t batch = run(program, ENGINE_NONE, nullptr);
+        p.interval = double(batch - single) / double(repeats_ - 1);
+    }
+
+private:
+    static Instruction barrier() { return {OP_BARRIER, 0, 0, 0, 0, 0, 0, 0, 0}; }
+    static Instruction end() { return {OP_END, 0, 0, 0, 0, 0, 0, 0, 0}; }
+
+    // Returns total cycles from start to done. When latency is requested,
+    // times the first scoreboard set -> clear window of the given engine.
+    uint64_t run(const std::vector<Instruction>& program, int engine, uint64_t* latency) {
+        npu_.load_program(UCODE_BASE, program);
+        npu_.start(UCODE_BASE, program.size());
+
+        uint64_t cycle = 0, issue = 0, done = 0;
+        int cycles = npu_.run_until_done(MAX_CYCLES, [&](Vnpu_top* top) {
+            ddr_.step(top);
+            cycle++;
+            if (!latency || done) return;
+            bool busy = (top->rootp->npu_top__DOT__controller__DOT__scoreboard >> engine) & 1;
+            if (busy && !issue) issue = cycle;
+            if (!busy && issue) done = cycle;
+        });
+
+        if (!npu_->done) {
+            std::cerr << "Timeout running " << opcode_name(program[0].opcode) << std::endl;
+            std::exit(1);
+        }
+        if (latency) *latency = done - issue;
+        return cycles;
+    }
+
+    NpuDriver<Vnpu_top> npu_;
+    AxiDdrModel<Vnpu_top> ddr_;
+    int repeats_;
+};
+
+// Ordinary least squares on [1, features...] via the normal equations
+Fit fit_affine(const std::vector<Point>& points, bool use_interval) {
+    size_t n = points[0].features.size() + 1;
+    std::vector<double> a(n * n, 0.0), b(n, 0.0);
+    for (const auto& p : points) {
+        std::vector<double> x(1, 1.0);
+        x.insert(x.end(), p.features.begin(), p.features.end());
+        double y = use_interval ? p.interval : double(p.latency);
+        for (size_t i = 0; i < n; i++) {
+            b[i] += x[i] * y;
+            for (size_t j = 0; j < n; j++) a[i * n + j] += x[i] * x[j];
+        }
+    }
+
+    // Gaussian elimination with partial pivoting; degenerate columns get 0
+    std::vector<double> c(n, 0.0);
+    std::vector<size_t> pivot_col;
+    for (size_t col = 0, row = 0; col < n && row < n; col++) {
+        size_t best = row;
+        for (size_t r = row + 1; r < n; r++) {
+            if (std::fabs(a[r * n + col]) > std::fabs(a[best * n + col])) best = r;
+        }
+        if (std::fabs(a[best * n + col]) < 1e-9) continue;
+        for (size_t j = 0; j < n; j++) std::swap(a[row * n + j], a[best * n + j]);
+        std::swap(b[row], b[best]);
+        for (size_t r = 0; r < n; r++) {
+            if (r == row) continue;
+            double f = a[r * n + col] / a[row * n + col];
+            for (size_t j = 0; j < n; j++) a[r * n + j] -= f * a[row * n + j];
+            b[r] -= f * b[row];
+        }
+        pivot_col.push_back(col);
+        row++;
+    }
+    for (size_t row = 0; row < pivot_col.size(); row++) {
+        size_t col = pivot_col[row];
+        c[col] = b[row] / a[row * n + col];
+    }
+
+    Fit fit;
+    fit.coeffs = c;
+    for (const auto& p : points) {
+        double pred = c[0];
+        for (size_t i = 0; i < p.features.size(); i++) pred += c[i + 1] * p.features[i];
+        double y = use_interval ? p.interval : double(p.latency);
+        fit.max_abs_error = std::max(fit.max_abs_error, std::fabs(pred - y));
+    }
+    return fit;
+}
+
+uint16_t tiles(uint16_t dim) { return (dim + 15) / 16; }
+
+std::vector<Sweep> build_sweeps() {
+    std::vector<Sweep> sweeps;
+
+    // GEMM: cost is per 16x16x16 tile plus per output tile (store/next)
+    Sweep gemm{OP_GEMM, {"tiles_mnk", "tiles_mn"}, {}, {}, {}};
+    for (uint16_t m : {16, 32, 64})
+        for (uint16_t n : {16, 32, 64})
+            for (uint16_t k : {16, 32, 64}) {
+                double mn = tiles(m) * tiles(n);
+                gemm.points.push_back({{OP_GEMM, 0, 0, 0, 0, m, n, k, 0}, {mn * tiles(k), mn}});
+            }
+    sweeps.push_back(gemm);
+
+    // Row-wise engines: elements = M * N
+    for (uint8_t op : {OP_SOFTMAX, OP_LAYERNORM}) {
+        Sweep s{op, {"elements"}, {}, {}, {}};
+        for (uint16_t m : {1, 4, 16})
+            for (uint16_t n : {16, 64, 256})
+                s.points.push_back({{op, 0, 0, 0, 0, m, n, 0, 0}, {double(m) * n}});
+        sweeps.push_back(s);
+    }
+
+    // Element-wise engines: elements = N
+    for (uint8_t op : {OP_GELU, OP_VEC_ADD, OP_VEC_MUL, OP_VEC_COPY}) {
+        Sweep s{op, {"elements"}, {}, {}, {}};
+        for (uint16_t n : {64, 256, 1024, 4096})
+            s.points.push_back({{op, 0, 0, 0, 0, 1, n, 0, 0}, {double(n)}});
+        sweeps.push_back(s);
+    }
+
+    // DMA: bytes = M
+    for (uint8_t op : {OP_DMA_LOAD, OP_DMA_STORE}) {
+        Sweep s{op, {"bytes"}, {}, {}, {}};
+        for (uint16_t bytes : {64, 256, 1024, 4096, 16384})
+            s.points.push_back({{op, 0, 0, 0, 0, bytes, 0, 0, 0}, {double(bytes)}});
+        sweeps.push_back(s);
+    }
+
+    return sweeps;
+}
+
+void print_table(const std::vector<Sweep>& sweeps) {
+    std::cout << "  opcode         m      n      k    latency   interval" << std::endl;
+    for (const auto& s : sweeps) {
+        for (const auto& p : s.points) {
+            std::cout << "  " << std::left << std::setw(10) << opcode_name(s.opcode) << std::right
+                      << std::setw(6) << p.instr.m << " " << std::setw(6) << p.instr.n << " "
+                      << std::setw(6) << p.instr.k << " " << std::setw(10) << p.latency << " "
+                      << std::setw(10) << std::fixed << std::setprecision(1) << p.interval << std::endl;
+        }
+    }
+
+    std::cout << "=== Fitted cost models (cycles) ===" << std::endl;
+    for (const auto& s : sweeps) {
+        for (bool interval : {false, true}) {
+            const Fit& f = interval ? s.interval_fit : s.latency_fit;
+            std::cout << "  " << std::left << std::setw(10) << opcode_name(s.opcode) << std::setw(9)
+                      << (interval ? "interval" : "latency") << std::right << std::setprecision(3)
+                      << f.coeffs[0];
+            for (size_t i = 0; i < s.feature_names.size(); i++) {
+                std::cout << " + " << f.coeffs[i + 1] << "*" << s.feature_names[i];
+            }
+            std::cout << "  (max err " << f.max_abs_error << ")" << std::endl;
+        }
+    }
+}
+
+void write_fit_json(std::ostream& os, const Sweep& s, const Fit& f) {
+    os << "{\"intercept\": " << f.coeffs[0] << ", \"coefficients\": {";
+    for (size_t i = 0; i < s.feature_names.size(); i++) {
+        os << (i ? ", " : "") << "\"" << s.feature_names[i] << "\": " << f.coeffs[i + 1];
+    }
+    os << "}, \"max_abs_error\": " << f.max_abs_error << "}";
+}
+
+bool write_json(const std::string& path, const std::vector<Sweep>& sweeps, int repeats) {
+    std::ofstream os(path);
+    if (!os) return false;
+    os << std::setprecision(9);
+    os << "{\n  \"schema\": \"tiny-npu-opcode-costs/1\",\n";
+    os << "  \"top\": \"npu_top\",\n  \"repeats\": " << repeats << ",\n  \"opcodes\": {\n";
+    for (size_t si = 0; si < sweeps.size(); si++) {
+        const Sweep& s = sweeps[si];
+        os << "    \"" << opcode_name(s.opcode) << "\": {\n      \"opcode\": " << int(s.opcode)
+           << ",\n      \"engine\": \"" << engine_name(opcode_engine(s.opcode)) << "\",\n      \"features\": [";
+        for (size_t i = 0; i < s.feature_names.size(); i++) {
+            os << (i ? ", " : "") << "\"" << s.feature_names[i] << "\"";
+        }
+        os << "],\n      \"latency\": ";
+        write_fit_json(os, s, s.latency_fit);
+        os << ",\n      \"interval\": ";
+        write_fit_json(os, s, s.interval_fit);
+        os << ",\n      \"points\": [\n";
+        for (size_t pi = 0; pi < s.points.size(); pi++) {
+            const Point& p = s.points[pi];
+            os << "        {\"m\": " << p.instr.m << ", \"n\": " << p.instr.n << ", \"k\": " << p.instr.k
+               << ", \"latency\": " << p.latency << ", \"interval\": " << p.interval << "}"
+               << (pi + 1 < s.points.size() ? "," : "") << "\n";
+        }
+        os << "      ]\n    }" << (si + 1 < sweeps.size() ? "," : "") << "\n";
+    }
+    os << "  }\n}\n";
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    std::string out = "opcode_costs.json";
+    int repeats = 4;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        } else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) {
+            repeats = std::max(2, atoi(argv[++i]));
+        }
+    }
+
+    std::cout << "=== Opcode Characterization (repeats=" << repeats << ") ===" << std::endl;
+
+    Characterizer bench(repeats);
+    std::vector<Sweep> sweeps = build_sweeps();
+    for (auto& s : sweeps) {
+        for (auto& p : s.points) bench.measure(p);
+        s.latency_fit = fit_affine(s.points, false);
+        s.interval_fit = fit_affine(s.points, true);
+    }
+
+    print_table(sweeps);
+
+    if (!write_json(out, sweeps, repeats)) {
+        std::cerr << "Failed to write " << out << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote cost models to " << out << std::endl;
+    return 0;
+}
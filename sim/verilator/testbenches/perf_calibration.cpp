@@ -0,0 +1,226 @@
+// Calibration runs for the analytical performance model
+// Runs a fixed set of microcode workloads on npu_top and records, for each:
+//   - the program itself (<name>.bin, the same packing as write_microcode)
+//   - total cycles from start to done (calibration.csv)
+//   - every engine instruction's issue/complete cycle, taken from the
+//     controller scoreboard (ops.csv)
+// python/tools/perf_model.py fits its per-opcode costs and controller
+// overheads from this directory and reports prediction error per workload.
+//
+// Workloads tagged "fit" cover isolated opcodes, same-engine back-to-back
+// stalls, cross-engine overlap with DMA (SRAM port A contention),
+// residual-epilogue GEMMs and DMA_STREAM / GEMM_STREAM pairs. The
+// "holdout" workloads (generated transformer blocks) are not used for
+// fitting and measure how well the model generalizes.
+//
+// Usage: bench_perf_calibration [--out DIR]
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+#include <verilated.h>
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/axi_ddr_model.h"
+#include "common/block_program.h"
+#include "common/npu_driver.h"
+#include "common/npu_utils.h"
+
+namespace {
+
+constexpr uint32_t UCODE_BASE = 0xF600;
+constexpr uint32_t DDR_BASE = 0x100000;
+constexpr int MAX_CYCLES = 50000000;
+
+struct Workload {
+    std::string name;
+    std::string role;  // "fit" or "holdout"
+    uint32_t ucode_base;
+    std::vector<Instruction> program;
+};
+
+struct OpTiming {
+    size_t index;
+    uint64_t issue = 0;
+    uint64_t complete = 0;
+};
+
+struct Measurement {
+    uint64_t cycles = 0;
+    std::vector<OpTiming> ops;
+};
+
+Instruction op(uint8_t opcode, uint16_t m, uint16_t n, uint16_t k, uint8_t flags = 0) {
+    return {opcode, flags, 0, 0, 0, m, n, k, 0};
+}
+
+Instruction barrier() { return op(OP_BARRIER, 0, 0, 0); }
+Instruction end() { return op(OP_END, 0, 0, 0); }
+
+Measurement run(const Workload& w) {
+    AxiDdrModel<Vnpu_top> ddr;
+    NpuDriver<Vnpu_top> npu;
+
+    npu.reset(10);
+    npu.toggle();
+    npu.write_reg(REG_DDR_BASE, DDR_BASE);
+    npu.load_program(w.ucode_base, w.program);
+    npu.start(w.ucode_base, w.program.size());
+
+    // Each engine runs its instructions in program order, so the n-th
+    // scoreboard set of an engine belongs to its n-th instruction
+    std::vector<size_t> queue[NUM_ENGINES];
+    for (size_t i = 0; i < w.program.size(); i++) {
+        int e = instr_engine(w.program[i]);
+        if (e != ENGINE_NONE) queue[e].push_back(i);
+    }
+
+    Measurement m;
+    size_t next[NUM_ENGINES] = {};
+    int open[NUM_ENGINES];
+    std::fill(open, open + NUM_ENGINES, -1);
+    uint8_t prev = 0;
+    uint64_t cycle = 0;
+    m.cycles = npu.run_until_done(MAX_CYCLES, [&](Vnpu_top* top) {
+        ddr.step(top);
+        cycle++;
+        uint8_t sb = top->rootp->npu_top__DOT__controller__DOT__scoreboard;
+        for (int e = 0; e < NUM_ENGINES; e++) {
+            bool now = (sb >> e) & 1, was = (prev >> e) & 1;
+            if (now && !was && next[e] < queue[e].size()) {
+                open[e] = static_cast<int>(m.ops.size());
+                m.ops.push_back({queue[e][next[e]++], cycle, 0});
+            } else if (!now && was && open[e] >= 0) {
+                m.ops[open[e]].complete = cycle;
+                open[e] = -1;
+            }
+        }
+        prev = sb;
+    });
+
+    if (!npu->done) {
+        std::cerr << "Timeout: " << w.name << std::endl;
+        std::exit(1);
+    }
+    return m;
+}
+
+std::vector<Workload> build_workloads() {
+    std::vector<Workload> out;
+    auto add = [&](const std::string& name, std::vector<Instruction> body, const char* role = "fit") {
+        body.push_back(barrier());
+        body.push_back(end());
+        out.push_back({name, role, UCODE_BASE, body});
+    };
+
+    // Isolated opcodes over a spread of sizes. GEMM dims include partial
+    // tiles; with only multiples of ARRAY_SIZE the tile and tile-edge
+    // features are collinear and the fit cannot separate them.
+    for (uint16_t m : {16, 40})
+        for (uint16_t n : {16, 56})
+            for (uint16_t k : {16, 24, 80})
+                add("iso_gemm_" + std::to_string(m) + "x" + std::to_string(n) + "x" + std::to_string(k),
+                    {op(OP_GEMM, m, n, k)});
+    // Residual epilogue: one R tile read per output tile
+    for (uint16_t m : {16, 40})
+        for (auto [n, k] : {std::pair<uint16_t, uint16_t>{16, 16}, {56, 24}, {56, 80}})
+            add("iso_gemm_residual_" + std::to_string(m) + "x" + std::to_string(n) + "x" + std::to_string(k),
+                {op(OP_GEMM_RESIDUAL, 0, 0, 0), op(OP_GEMM, m, n, k)});
+    for (uint8_t code : {OP_SOFTMAX, OP_LAYERNORM})
+        for (uint16_t m : {1, 8})
+            for (uint16_t n : {32, 256})
+                add(std::string("iso_") + opcode_name(code) + "_" + std::to_string(m) + "x" + std::to_string(n),
+                    {op(code, m, n, 0)});
+    for (uint8_t code : {OP_GELU, OP_VEC_ADD, OP_VEC_MUL, OP_VEC_COPY})
+        for (uint16_t n : {64, 1024, 8192})
+            add(std::string("iso_") + opcode_name(code) + "_" + std::to_string(n), {op(code, 1, n, 0)});
+    for (uint8_t code : {OP_DMA_LOAD, OP_DMA_STORE})
+        for (uint16_t bytes : {64, 1000, 4096, 16384})
+            add(std::string("iso_") + opcode_name(code) + "_" + std::to_string(bytes), {op(code, bytes, 0, 0)});
+
+    // Streamed weights: DMA_STREAM feeding GEMM_STREAM, each paced by the
+    // other through the weight FIFO
+    for (uint16_t m : {16, 40}) {
+        for (auto [k, n] : {std::pair<uint16_t, uint16_t>{24, 16}, {16, 56}, {80, 56}, {64, 256}}) {
+            uint32_t bytes = uint32_t(weight_stream_bytes(k, n));
+            add("pair_stream_" + std::to_string(m) + "x" + std::to_string(n) + "x" + std::to_string(k),
+                {op(OP_DMA_STREAM, uint16_t(bytes), uint16_t(bytes >> 16), 0), op(OP_GEMM_STREAM, m, n, k)});
+        }
+    }
+
+    for (uint16_t table : {LUT_GELU, LUT_SOFTMAX_EXP}) {
+        Instruction load = op(OP_LUT_LOAD, 0, 0, 0);
+        load.imm = table;
+        add("iso_LUT_LOAD_" + std::to_string(table), {load});
+    }
+
+    // Same-engine back-to-back: dispatch stalls on the scoreboard
+    add("b2b_gemm", std::vector<Instruction>(4, op(OP_GEMM, 32, 32, 32)));
+    add("b2b_vec", std::vector<Instruction>(4, op(OP_VEC_ADD, 1, 512, 0)));
+    add("b2b_dma", std::vector<Instruction>(3, op(OP_DMA_LOAD, 2048, 0, 0)));
+
+    // Cross-engine overlap without barriers, including DMA sharing SRAM0 port A
+    add("mix_dma_gemm", {op(OP_DMA_LOAD, 8192, 0, 0), op(OP_GEMM, 64, 64, 64)});
+    add("mix_dma_vec", {op(OP_DMA_LOAD, 4096, 0, 0), op(OP_VEC_ADD, 1, 4096, 0)});
+    add("mix_chain", {op(OP_DMA_LOAD, 1024, 0, 0), op(OP_GEMM, 32, 32, 32), op(OP_SOFTMAX, 8, 64, 0),
+                      op(OP_LAYERNORM, 8, 64, 0), op(OP_GELU, 1, 2048, 0), op(OP_DMA_STORE, 1024, 0, 0)});
+    add("mix_barriers", {op(OP_GEMM, 16, 16, 16), barrier(), op(OP_VEC_ADD, 1, 256, 0), barrier(),
+                         op(OP_DMA_STORE, 512, 0, 0), barrier(), op(OP_SOFTMAX, 4, 64, 0)});
+
+    // Generated transformer blocks, held out from the fit
+    for (uint16_t hidden : {64, 128}) {
+        for (uint16_t seq : {4, 16}) {
+            BlockConfig cfg;
+            cfg.hidden = hidden;
+            cfg.seq_len = seq;
+            cfg.compact_ucode = false;  // loaded instruction by instruction
+            BlockProgram prog = build_block_program(cfg);
+            out.push_back({"block_h" + std::to_string(hidden) + "_s" + std::to_string(seq), "holdout",
+                           prog.ucode_base, prog.instrs});
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    std::string dir = "perf_calibration";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) dir = argv[++i];
+    }
+    mkdir(dir.c_str(), 0755);
+
+    std::ofstream summary(dir + "/calibration.csv");
+    std::ofstream ops(dir + "/ops.csv");
+    if (!summary || !ops) {
+        std::cerr << "Failed to write into " << dir << std::endl;
+        return 1;
+    }
+    summary << "workload,role,program,instructions,cycles\n";
+    ops << "workload,index,opcode,issue,complete\n";
+
+    std::vector<Workload> workloads = build_workloads();
+    std::cout << "=== Performance model calibration (" << workloads.size() << " workloads) ===" << std::endl;
+    for (const Workload& w : workloads) {
+        Measurement m = run(w);
+        write_microcode(dir + "/" + w.name + ".bin", w.program);
+        summary << w.name << "," << w.role << "," << w.name << ".bin," << w.program.size() << "," << m.cycles
+                << "\n";
+        for (const OpTiming& t : m.ops) {
+            ops << w.name << "," << t.index << "," << int(w.program[t.index].opcode) << "," << t.issue << ","
+                << t.complete << "\n";
+        }
+        std::cout << "  " << w.name << ": " << m.cycles << " cycles" << std::endl;
+    }
+    std::cout << "Wrote " << dir << "/calibration.csv" << std::endl;
+    return 0;
+}
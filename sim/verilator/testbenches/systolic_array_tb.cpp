@@ -37,6 +37,7 @@ void test_systolic_16x16x16() {
     array->load_weights = 0;
     array->start_compute = 0;
     array->clear_acc = 0;
+    array->int4_mode = 0;
     array->activation_valid = 0;
     array->weight_row = 0;
     
@@ -243,6 +244,114 @@ void test_systolic_small() {
     delete array;
 }
 
+// INT8 x INT4: each weight byte packs B[k][2j] (low nibble) and B[k][2j+1]
+// (high nibble), so one 16x16 weight load yields a 16x32 result streamed
+// over 32 result_valid cycles.
+void test_systolic_int4() {
+    std::cout << "Test: Systolic array 16x16x32 INT8 x INT4..." << std::endl;
+
+    Vsystolic_array* array = new Vsystolic_array;
+
+    array->clk = 0;
+    array->rst_n = 0;
+    array->load_weights = 0;
+    array->start_compute = 0;
+    array->clear_acc = 0;
+    array->int4_mode = 1;
+    array->activation_valid = 0;
+    array->weight_row = 0;
+    for (int i = 0; i < 16; i++) {
+        array->activation_in[i] = 0;
+        array->weight_in[i] = 0;
+        array->partial_sum_in[i] = 0;
+    }
+    for (int i = 0; i < 10; i++) {
+        array->clk = !array->clk;
+        array->eval();
+    }
+    array->rst_n = 1;
+    array->clk = !array->clk;
+    array->eval();
+
+    // Full INT8 activation range, full INT4 weight range (-8..7)
+    int8_t A[16][16];
+    int8_t B[16][32];
+    int32_t expected[16][32];
+    for (int i = 0; i < 16; i++) {
+        for (int k = 0; k < 16; k++) A[i][k] = int8_t((i * 37 + k * 11) * 7 - 128);
+    }
+    for (int k = 0; k < 16; k++) {
+        for (int j = 0; j < 32; j++) B[k][j] = int8_t((k * 5 + j * 3) % 16 - 8);
+    }
+    for (int i = 0; i < 16; i++) {
+        for (int j = 0; j < 32; j++) {
+            int32_t sum = 0;
+            for (int k = 0; k < 16; k++) sum += (int32_t)A[i][k] * (int32_t)B[k][j];
+            expected[i][j] = sum;
+        }
+    }
+
+    array->load_weights = 1;
+    for (int row = 0; row < 16; row++) {
+        array->weight_row = row;
+        for (int col = 0; col < 16; col++) {
+            array->weight_in[col] = uint8_t((B[row][2 * col] & 0xF) | (B[row][2 * col + 1] << 4));
+        }
+        array->clk = !array->clk; array->eval();
+        array->clk = !array->clk; array->eval();
+    }
+    array->load_weights = 0;
+    array->clk = !array->clk; array->eval();
+
+    array->clear_acc = 1;
+    array->clk = !array->clk; array->eval();
+    array->clk = !array->clk; array->eval();
+    array->clear_acc = 0;
+
+    array->start_compute = 1;
+    array->clk = !array->clk; array->eval();
+    array->start_compute = 0;
+    array->activation_valid = 1;
+
+    int32_t results[16][32];
+    int output_col = 0;
+    for (int cycle = 0; cycle < 100 && output_col < 32; cycle++) {
+        for (int row = 0; row < 16; row++) {
+            int col = cycle - row;
+            array->activation_in[row] = (col >= 0 && col < 16) ? A[row][col] : 0;
+        }
+        if (array->result_valid) {
+            for (int row = 0; row < 16; row++) results[row][output_col] = array->result_out[row];
+            output_col++;
+        }
+        array->clk = !array->clk; array->eval();
+    }
+
+    int errors = output_col == 32 ? 0 : 16 * (32 - output_col);
+    for (int i = 0; i < 16; i++) {
+        for (int j = 0; j < output_col; j++) {
+            if (results[i][j] != expected[i][j]) {
+                if (errors < 5) {
+                    std::cout << "  Mismatch at [" << i << "][" << j << "]: "
+                              << "expected=" << expected[i][j] << " got=" << results[i][j] << std::endl;
+                }
+                errors++;
+            }
+        }
+    }
+
+    if (errors == 0) {
+        std::cout << "  PASSED (512/512 values correct)" << std::endl;
+    } else {
+        std::cout << "  FAILED (" << errors << " errors, " << output_col << "/32 columns)" << std::endl;
+    }
+
+    array->final();
+    delete array;
+
+    assert(errors == 0);
+}
+
 int main(int argc, char** argv) {
     std::cout << "========================================" << std::endl;
     std::cout << "    Systolic Array Testbench" << std::endl;
@@ -253,6 +362,7 @@ int main(int argc, char** argv) {
     try {
         test_systolic_small();
         test_systolic_16x16x16();
+        test_systolic_int4();
         
         std::cout << "\n========================================" << std::endl;
         std::cout << "    ALL TESTS PASSED!" << std::endl;
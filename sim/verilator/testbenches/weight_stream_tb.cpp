@@ -0,0 +1,157 @@
+// Weight Streaming Testbench
+// Runs DMA_STREAM + GEMM_STREAM pairs on npu_top: the DMA pushes pre-tiled
+// weights from DDR into the weight FIFO while the GEMM pops them. Checks
+// that every beat the GEMM pops matches DDR in order (no drops or repeats
+// under RREADY backpressure), that the DMA reads exactly the streamed bytes,
+// and that SRAM0 outside the GEMM output is untouched: the weights never
+// land in a staging buffer. A stream of fewer than 8 bytes still moves one
+// whole beat, and an empty one moves none.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <verilated.h>
+#include "Vnpu_top.h"
+#include "Vnpu_top___024root.h"
+#include "common/axi_ddr_model.h"
+#include "common/block_program.h"
+#include "common/npu_driver.h"
+#include "common/npu_utils.h"
+
+namespace {
+
+constexpr uint32_t UCODE_BASE = 0xF600;
+constexpr uint32_t DDR_BASE = 0x0;
+constexpr uint16_t A_ADDR = 0x8000;
+constexpr uint16_t C_ADDR = 0xC000;
+constexpr uint8_t SRAM_FILL = 0xA5;
+
+struct Shape {
+    uint16_t m, n, k;     // m = 0: DMA_STREAM only, no GEMM_STREAM
+    uint32_t ddr_offset;  // above 64KB exercises the {src1,src0} offset
+    int32_t bytes = -1;   // DMA_STREAM count, -1: weight_stream_bytes(k, n)
+};
+
+uint32_t stream_count(const Shape& s) {
+    return s.bytes < 0 ? uint32_t(weight_stream_bytes(s.k, s.n)) : uint32_t(s.bytes);
+}
+
+struct Case {
+    const char* name;
+    std::vector<Shape> gemms;  // issued back to back, one barrier at the end
+    uint32_t read_latency;
+    uint32_t outstanding;
+};
+
+std::vector<Instruction> build_program(const std::vector<Shape>& gemms) {
+    std::vector<Instruction> program;
+    for (const Shape& s : gemms) {
+        uint32_t bytes = stream_count(s);
+        program.push_back({OP_DMA_STREAM, 0, 0, uint16_t(s.ddr_offset & 0xFFFF), uint16_t(s.ddr_offset >> 16),
+                           uint16_t(bytes & 0xFFFF), uint16_t(bytes >> 16), 0, 0});
+        if (s.m) program.push_back({OP_GEMM_STREAM, 0, C_ADDR, A_ADDR, 0, s.m, s.n, s.k, 0});
+    }
+    program.push_back({OP_BARRIER, 0, 0, 0, 0, 0, 0, 0, 0});
+    program.push_back({OP_END, 0, 0, 0, 0, 0, 0, 0, 0});
+    return program;
+}
+
+int run_case(const Case& c) {
+    DdrConfig ddr_cfg;
+    ddr_cfg.read_latency = c.read_latency;
+    ddr_cfg.max_outstanding = c.outstanding;
+    AxiDdrModel<Vnpu_top> ddr(ddr_cfg);
+    NpuDriver<Vnpu_top> npu;
+
+    // Random weights; the expected beat stream is the concatenation of
+    // every DMA_STREAM's DDR range, rounded up to whole beats, in program
+    // order
+    std::mt19937 rng(0x5eed + c.gemms.size() * 31 + c.read_latency);
+    std::vector<uint64_t> expected;
+    uint64_t stream_bytes = 0;
+    for (const Shape& s : c.gemms) {
+        uint32_t bytes = (stream_count(s) + 7) & ~7u;
+        for (uint32_t i = 0; i < bytes; i++) ddr.byte(DDR_BASE + s.ddr_offset + i) = uint8_t(rng());
+        for (uint32_t beat = 0; beat < bytes / 8; beat++) {
+            uint64_t data = 0;
+            for (int b = 0; b < 8; b++) data |= uint64_t(ddr.byte(DDR_BASE + s.ddr_offset + 8 * beat + b)) << (8 * b);
+            expected.push_back(data);
+        }
+        stream_bytes += bytes;
+    }
+
+    std::vector<Instruction> program = build_program(c.gemms);
+    npu.reset(10);
+    npu.toggle();
+    npu.write_reg(REG_DDR_BASE, DDR_BASE);
+    std::vector<uint8_t> fill(C_ADDR, SRAM_FILL);
+    npu.write_sram0(0, fill.data(), fill.size());
+    npu.load_program(UCODE_BASE, program);
+    npu.start(UCODE_BASE, program.size());
+
+    std::vector<uint64_t> popped;
+    uint64_t backpressure = 0;
+    int cycles = npu.run_until_done(400000, [&](Vnpu_top* top) {
+        ddr.step(top);
+        auto* root = top->rootp;
+        if (root->npu_top__DOT__wgt_fifo_pop) popped.push_back(root->npu_top__DOT__wgt_fifo_rd_data);
+        if (top->m_axi_rvalid && !top->m_axi_rready) backpressure++;
+    });
+
+    if (!npu->done) {
+        std::cout << "FAIL [" << c.name << "]: timeout after " << popped.size() << " of " << expected.size()
+                  << " beats" << std::endl;
+        return 1;
+    }
+
+    int errors = 0;
+    if (popped.size() != expected.size()) {
+        std::cout << "  popped " << popped.size() << " beats, expected " << expected.size() << std::endl;
+        errors++;
+    }
+    for (size_t i = 0; i < std::min(popped.size(), expected.size()); i++) {
+        if (popped[i] != expected[i] && errors++ < 5) {
+            std::cout << "  beat " << i << " = 0x" << std::hex << popped[i] << ", expected 0x" << expected[i]
+                      << std::dec << std::endl;
+        }
+    }
+    if (ddr.stats().read_beats != stream_bytes / 8) {
+        std::cout << "  DDR read " << ddr.stats().read_beats << " beats, expected " << stream_bytes / 8 << std::endl;
+        errors++;
+    }
+    auto& mem = npu->rootp->npu_top__DOT__sram__DOT__sram0__DOT__mem;
+    for (uint32_t addr = 0; addr < A_ADDR; addr++) {
+        if (mem[addr] != SRAM_FILL && errors++ < 5) {
+            std::cout << "  SRAM0[0x" << std::hex << addr << "] overwritten" << std::dec << std::endl;
+        }
+    }
+
+    std::cout << (errors ? "FAIL" : "PASS") << " [" << c.name << "]: " << cycles << " cycles, " << popped.size()
+              << " beats, " << backpressure << " backpressure cycles" << std::endl;
+    return errors ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    std::cout << "=== Weight Streaming Test ===" << std::endl;
+
+    // FFN-sized shapes keep the FIFO full and RREADY low most of the time;
+    // the small 16-row tiles with slow DDR drain it instead
+    const std::vector<Case> cases = {
+        {"16x64x256", {{16, 64, 256, 0x0000}}, 8, 1},
+        {"40x80x56, offset 192KB", {{40, 80, 56, 0x30000}}, 8, 1},
+        {"20x21x20, slow DDR", {{20, 21, 20, 0x1000}}, 40, 1},
+        {"back to back", {{16, 64, 64, 0x0000}, {32, 48, 64, 0x12000}, {16, 16, 16, 0x20000}}, 8, 4},
+        // A 5-byte tile (K=1, N=5) streamed as a 5-byte count; an empty
+        // stream before a full one must leave the FIFO alone
+        {"5-byte stream", {{16, 5, 1, 0x2000, 5}}, 8, 1},
+        {"empty stream", {{0, 0, 0, 0x3000, 0}, {16, 16, 16, 0x4000}}, 8, 1},
+    };
+    int failures = 0;
+    for (const Case& c : cases) failures += run_case(c);
+    return failures ? 1 : 0;
+}